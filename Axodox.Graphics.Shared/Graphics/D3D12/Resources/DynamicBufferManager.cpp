@@ -65,7 +65,7 @@ void DynamicBufferManager::UploadResources(CommandAllocator &allocator) {
 
     void *mappedBuffer = nullptr;
     check_hresult(block.UploadBuffer->Map(0, &EmptyRange, &mappedBuffer));
-    memcpy(mappedBuffer, block.WriteBuffer.data(), uint32_t(block.Size));
+    memcpy(mappedBuffer, block.WriteBuffer.data(), block.Position);
     block.UploadBuffer->Unmap(0, &writtenRange);
 
     // Copy to default buffer
@@ -75,8 +75,8 @@ void DynamicBufferManager::UploadResources(CommandAllocator &allocator) {
          {block.DefaultBuffer, ResourceStates::AllShaderResource,
           ResourceStates::CopyDest}});
 
-    allocator->CopyResource(block.DefaultBuffer.get(),
-                            block.UploadBuffer.get());
+    allocator->CopyBufferRegion(block.DefaultBuffer.get(), 0,
+                                block.UploadBuffer.get(), 0, block.Position);
 
     allocator.TransitionResources(
         {{block.UploadBuffer, ResourceStates::CopySource,
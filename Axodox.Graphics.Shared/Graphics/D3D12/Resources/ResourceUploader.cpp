@@ -163,6 +163,9 @@ ResourceUploader::ResourceUploader(const GraphicsDevice &device,
     {
       _allocator.deallocate(task.AllocatedSegment);
     }
+
+    //Wake the producers waiting for space
+    _uploadEvent.set();
   }
 
   buffer_segment ResourceUploader::AllocateBuffer(uint64_t size, uint64_t alignment)
@@ -18,12 +18,13 @@ namespace Axodox::Graphics::D3D12
 
   public:
     ResourceUploader(const GraphicsDevice& device, uint64_t bufferSize = 0);
+    virtual ~ResourceUploader() = default;
 
-    CommandFenceMarker EnqueueUploadTask(Resource* resource, const ResourceData* data);
+    virtual CommandFenceMarker EnqueueUploadTask(Resource* resource, const ResourceData* data);
 
     bool AwaitUploadTask(CommandFenceMarker marker, CommandFenceTimeout timeout = CommandFenceTimeout(INFINITE));
 
-    Threading::async_action UploadResourcesAsync(CommandAllocator& allocator, uint64_t maxSize = 0);
+    virtual Threading::async_action UploadResourcesAsync(CommandAllocator& allocator, uint64_t maxSize = 0);
 
   private:
     GraphicsDevice _device;
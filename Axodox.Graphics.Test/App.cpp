@@ -8,6 +8,7 @@
 #include "pix3.h"
 #include "ComputePipeline.h"
 #include "GraphicsPipeline.h"
+#include "SpectrumRegeneration.h"
 #include "SkyboxPipeline.hpp"
 #include "ShadowVolume.h"
 #include "Parallax.h"
@@ -223,7 +224,22 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
   }
 
   struct RuntimeCPUBuffers {
-    std::vector<WaterGraphicRootDescription::OceanData> oceanData;
+    // The slot drawn this frame, the other one is built ahead for the next.
+    std::array<WaterGraphicRootDescription::OceanInstances, 2> oceanData;
+    u32 current = 0;
+    // Kept between frames for the incremental update.
+    QuadTree quadTree;
+    Ocean::CameraPredictor predictor;
+    // The build of the other slot for the predicted camera, running while
+    // this frame is recorded. The instances of the next frame when the
+    // prediction covers its camera.
+    std::shared_future<WaterGraphicRootDescription::OceanInstances &>
+        predictedLod;
+    std::optional<Ocean::CameraPredictor::Prediction> prediction;
+    // Of the last predicted build into each slot.
+    std::array<RuntimeResults, 2> predictedResults;
+    u32 predictionHits = 0;
+    u32 predictionMisses = 0;
   };
 
   void Run() const {
@@ -373,7 +389,7 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
 
     // Group together allocations
     GroupedResourceAllocator groupedResourceAllocator{device};
-    ResourceUploader resourceUploader{device};
+    BatchedResourceUploader resourceUploader{device};
     CommonDescriptorHeap commonDescriptorHeap{device, 2};
     DepthStencilDescriptorHeap depthStencilDescriptorHeap{device};
     RenderTargetDescriptorHeap renderTargetDescriptorHeap{device};
@@ -408,7 +424,11 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
                                 .NegY = app_folder() / "Assets/skybox/ny.png",
                                 .PosZ = app_folder() / "Assets/skybox/pz.png",
                                 .NegZ = app_folder() / "Assets/skybox/nz.png"};
-    CubeMapTexture skyboxTexture{immutableAllocationContext, paths};
+    // The skybox is uploaded behind everything else.
+    auto skyboxAllocationContext = immutableAllocationContext;
+    skyboxAllocationContext.ResourceUploader =
+        resourceUploader.WithPriority(Ocean::UploadPriority::Low);
+    CubeMapTexture skyboxTexture{skyboxAllocationContext, paths};
     // CubeMapTexture skyboxTexture{immutableAllocationContext,
     //                              app_folder() / "Assets/skybox/skybox3.hdr",
     //                              2024};
@@ -422,6 +442,9 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
     CommittedResourceAllocator committedResourceAllocator{device};
     mutableAllocationContext.ResourceAllocator = &committedResourceAllocator;
 
+    // The changed patches are swapped in once generated and uploaded.
+    SpectrumRegeneration spectra(resourceUploader, mutableAllocationContext);
+
     SimulationStage::ConstantGpuSources simulationConstantSources(
         mutableAllocationContext, simData);
     SimulationStage::MutableGpuSources simulationMutableSources(
@@ -433,15 +456,25 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
     array<FrameResources, 2> frameResources{
         FrameResources(mutableAllocationContext),
         FrameResources(mutableAllocationContext)};
+    // The per frame constants of both frames in flight, fenced by the frame
+    // counter.
+    UploadRingBuffer uploadRing(device);
+    // The same for the compute queue, fenced by the frame counter too.
+    UploadRingBuffer computeUploads(device);
 
     array<SimulationStage::SimulationResources, 2> simulationResources{
         SimulationStage::SimulationResources(mutableAllocationContext,
-                                             simData.N, simData.M),
+                                             simData),
         SimulationStage::SimulationResources(mutableAllocationContext,
-                                             simData.N, simData.M)};
+                                             simData)};
+
+    // Of the simulation, a slot for each of the simulationResources.
+    GpuTimer simulationTimer(device, computeQueue);
+    Ocean::CascadeScheduler cascadeScheduler;
+    // The plan each of the simulationResources was last calculated by.
+    std::array<Ocean::CascadeScheduler::Plan, 2> simulationPlans;
 
     committedResourceAllocator.Build();
-    const u32 &N = simData.N;
 
     swapChain.Resizing(
         no_revoke,
@@ -502,12 +535,6 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
 
       struct NewData {
         std::optional<std::future<PipelineState>> pipelineState;
-        std::optional<SimulationStage::ConstantGpuSources<>::LODDataSource>
-            highestData;
-        std::optional<SimulationStage::ConstantGpuSources<>::LODDataSource>
-            mediumData;
-        std::optional<SimulationStage::ConstantGpuSources<>::LODDataSource>
-            lowestData;
       };
 
       NewData newData;
@@ -520,27 +547,34 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
                   waterPipelineStateDefinition);
         }
         if (beforeNextFrame.patchHighestChanged) {
-          newData.highestData =
-              SimulationStage::ConstantGpuSources<>::LODDataSource(
-                  mutableAllocationContext, simData.Highest);
+          spectra.Request(0, simData.Highest);
+          beforeNextFrame.patchHighestChanged = false;
         }
         if (beforeNextFrame.patchMediumChanged) {
-          newData.mediumData =
-              SimulationStage::ConstantGpuSources<>::LODDataSource(
-                  mutableAllocationContext, simData.Medium);
+          spectra.Request(1, simData.Medium);
+          beforeNextFrame.patchMediumChanged = false;
         }
         if (beforeNextFrame.patchLowestChanged) {
-          newData.lowestData =
-              SimulationStage::ConstantGpuSources<>::LODDataSource(
-                  mutableAllocationContext, simData.Lowest);
+          spectra.Request(2, simData.Lowest);
+          beforeNextFrame.patchLowestChanged = false;
         }
+        spectra.Update();
       }
 
       // Wait until buffers can be used
-      if (frameResource.Marker)
+      if (frameResource.Marker) {
         frameResource.Fence.Await(frameResource.Marker);
-      if (drawingSimResource.FrameDoneMarker)
+        // The frame before the previous one is done
+        uploadRing.Retire(frameCounter - 1);
+      }
+      if (drawingSimResource.FrameDoneMarker) {
         drawingSimResource.Fence.Await(drawingSimResource.FrameDoneMarker);
+        // The compute of the previous frame is done
+        computeUploads.Retire(frameCounter);
+        spectra.Retire(frameCounter);
+        if (const auto ms = simulationTimer.Read(frameCounter & 0x1u))
+          cascadeScheduler.Measured(simulationPlans[frameCounter & 0x1u], *ms);
+      }
       // This is necessary for the compute queue
 
       if (beforeNextFrame.changeFlag && newData.pipelineState) {
@@ -565,7 +599,53 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
 
       frameResource.MakeCompatible(*renderTargetView, mutableAllocationContext);
 
+      // Swapped in by the compute of this frame, fenced as computeUploads
+      const auto newSpectra = spectra.TakeReady(frameCounter + 1);
+      // A spectrum of another size is copied to textures of its size, and
+      // the compute buffers follow. Allocated with the rest below.
+      {
+        std::array<u32, 3> lodSizes;
+        for (u32 i = 0; i < lodSizes.size(); ++i) {
+          auto &sources = *simulationConstantSources.LODs[i];
+          const auto *spectrum = newSpectra[i];
+          // Only the compute uses these, its previous frame is done
+          if (spectrum && spectrum->N != sources.N) {
+            sources.Resize(spectrum->N, spectrum->M);
+            simulationMutableSources.LODs[i]->Foam.Resize(spectrum->N,
+                                                          spectrum->M);
+          }
+          lodSizes[i] = sources.N;
+        }
+        // The other one follows when it is calculated next frame
+        if (!calculatingSimResource.IsCompatible(lodSizes)) {
+          // The previous frame draws from it
+          auto &previousFrame = frameResources[(frameCounter + 1) & 0x1u];
+          if (previousFrame.Marker)
+            previousFrame.Fence.Await(previousFrame.Marker);
+          calculatingSimResource.MakeCompatible(mutableAllocationContext,
+                                                lodSizes);
+        }
+      }
+      // The cascades the compute of this frame simulates, within the budget
+      {
+        const auto channels = debugValues.getChannels();
+        for (u32 i = 0; i < channels.size(); ++i) {
+          cascadeScheduler.SetCascade(
+              i, {.N = simulationConstantSources.LODs[i]->N,
+                  .maxInterval = settings.maxCascadeUpdateIntervals[i],
+                  .enabled = channels[i]});
+          // Its new spectrum is copied in by this compute
+          if (newSpectra[i])
+            cascadeScheduler.Invalidate(i);
+        }
+        simulationPlans[(frameCounter + 1) & 0x1u] =
+            cascadeScheduler.Schedule(gameTime, timeConstants.deltaTime,
+                                      settings.simulationBudgetMs);
+      }
+
       bool camChanged = cam.Update(deltaTime) || first_loop;
+      const Ocean::CameraPose camPose = cam.GetPose();
+      cpuBuffers.predictor.Observe(camPose, deltaTime);
 
       // Frame Begin
       {
@@ -579,28 +659,105 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
 
       auto oceanModelMatrix =
           XMMatrixTranslationFromVector(XMVECTOR{0, -5, 0, 0});
-      std::future<std::vector<WaterGraphicRootDescription::OceanData> &>
-          oceanDataFuture;
-      if (debugValues.drawMethod == DebugValues::DrawMethod::Tesselation ||
+      // The vertices are displaced by every cascade drawn.
+      Ocean::DisplacementRange oceanDisplacement;
+      {
+        const auto channels = debugValues.getChannels();
+        const std::array<const SimulationData::PatchData *, 3> patches = {
+            &simData.Highest, &simData.Medium, &simData.Lowest};
+        for (u32 i = 0; i < 3; ++i)
+          if (channels[i])
+            oceanDisplacement =
+                oceanDisplacement +
+                simulationConstantSources.LODs[i]->Bounds.GetRange(
+                    ToOcean(patches[i]->displacementLambda));
+      }
+      const bool buildsQuadTree =
+          debugValues.drawMethod == DebugValues::DrawMethod::Tesselation ||
           debugValues.drawMethod == DebugValues::DrawMethod::PrismParallax ||
-          first_loop) {
-        oceanDataFuture = threadpool_execute<
-            std::vector<WaterGraphicRootDescription::OceanData> &>(
-            [&cpuBuffers, cam, simData, &runtimeResults, camChanged,
-             oceanModelMatrix, &debugValues]()
-                -> std::vector<WaterGraphicRootDescription::OceanData> & {
-              if (camChanged && !debugValues.lockQuadTree) {
-                cpuBuffers.oceanData.clear();
-                return WaterGraphicRootDescription::
-                    CollectOceanQuadInfoWithQuadTree(
-                        cpuBuffers.oceanData, cam, oceanModelMatrix,
-                        simData.quadTreeDistanceThreshold, simData.maxDepth,
-                        debugValues, &runtimeResults);
-              }
-              return cpuBuffers.oceanData;
-            });
+          first_loop;
+      std::shared_future<WaterGraphicRootDescription::OceanInstances &>
+          oceanDataFuture;
+      // Most frames the quadtree was built while the previous one was
+      // recorded, for where the camera was expected to be. The frame only
+      // waits for it where the instances are drawn.
+      const auto predictedLod = std::exchange(cpuBuffers.predictedLod, {});
+      const auto prediction = std::exchange(cpuBuffers.prediction, {});
+      bool predictionHit = false;
+      if (buildsQuadTree) {
+        const bool rebuild = camChanged && !debugValues.lockQuadTree;
+        if (rebuild && prediction &&
+            Ocean::CameraPredictor::Covers(*prediction, camPose)) {
+          ++cpuBuffers.predictionHits;
+          cpuBuffers.current ^= 1;
+          predictionHit = true;
+          oceanDataFuture = predictedLod;
+        } else {
+          cpuBuffers.predictionMisses += rebuild && prediction;
+          // After the build for the prediction, they share the tree.
+          oceanDataFuture =
+              threadpool_execute<
+                  WaterGraphicRootDescription::OceanInstances &>(
+                  [&cpuBuffers, slot = cpuBuffers.current, predictedLod,
+                   camPose, simData, &runtimeResults, rebuild,
+                   oceanModelMatrix, oceanDisplacement, &debugValues]()
+                      -> WaterGraphicRootDescription::OceanInstances & {
+                    if (predictedLod.valid())
+                      predictedLod.wait();
+                    auto &oceanData = cpuBuffers.oceanData[slot];
+                    if (rebuild)
+                      return WaterGraphicRootDescription::
+                          CollectOceanQuadInfoWithQuadTree(
+                              oceanData, cpuBuffers.quadTree, camPose,
+                              camPose.GetFrustum(), oceanModelMatrix,
+                              simData.quadTreeDistanceThreshold,
+                              simData.maxDepth, oceanDisplacement,
+                              debugValues, &runtimeResults);
+                    return oceanData;
+                  })
+                  .share();
+        }
+        runtimeResults.lodPredictionHits = cpuBuffers.predictionHits;
+        runtimeResults.lodPredictionMisses = cpuBuffers.predictionMisses;
       }
 
+      // Build the quadtree of the next frame into the other slot while this
+      // one is recorded, once the build of this frame is done. The next
+      // frame falls back to building it for the actual camera when that is
+      // not inside the margins. A camera standing still keeps its tree.
+      if (buildsQuadTree && !debugValues.lockQuadTree &&
+          !cpuBuffers.predictor.IsStationary()) {
+        cpuBuffers.prediction = cpuBuffers.predictor.Predict(deltaTime);
+        cpuBuffers.predictedLod =
+            threadpool_execute<WaterGraphicRootDescription::OceanInstances &>(
+                [&cpuBuffers, slot = cpuBuffers.current ^ 1,
+                 built = oceanDataFuture, predicted = *cpuBuffers.prediction,
+                 simData, oceanModelMatrix, oceanDisplacement, &debugValues]()
+                    -> WaterGraphicRootDescription::OceanInstances & {
+                  built.wait();
+                  RuntimeResults &results = cpuBuffers.predictedResults[slot];
+                  results = {};
+                  return WaterGraphicRootDescription::
+                      CollectOceanQuadInfoWithQuadTree(
+                          cpuBuffers.oceanData[slot], cpuBuffers.quadTree,
+                          predicted.pose, predicted.frustum, oceanModelMatrix,
+                          simData.quadTreeDistanceThreshold, simData.maxDepth,
+                          oceanDisplacement, debugValues, &results);
+                })
+                .share();
+      }
+
+      // The instances where they are drawn, the wait is the part of the
+      // build not hidden behind the recording.
+      const auto waitOceanData =
+          [&]() -> WaterGraphicRootDescription::OceanInstances & {
+        const auto waitStart = std::chrono::high_resolution_clock::now();
+        auto &instances = oceanDataFuture.get();
+        runtimeResults.QuadTreeWaitTime +=
+            std::chrono::high_resolution_clock::now() - waitStart;
+        return instances;
+      };
+
       // Compute shader stage
       // It has to return some value or threadpool execute fails?????
       std::future computeStage = threadpool_execute<bool>([&]() {
@@ -612,7 +769,8 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
 
         // If a change has been issued change constant buffers
 
-        if (newData.highestData || newData.mediumData || newData.lowestData) {
+        if (std::ranges::any_of(newSpectra,
+                                [](auto *data) { return data != nullptr; })) {
           auto copyRes = [&computeAllocator](const MutableTexture &src,
                                              const MutableTexture &dst) {
             computeAllocator.TransitionResources(
@@ -628,40 +786,47 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
               [&copyRes](
                   const SimulationStage::ConstantGpuSources<>::LODDataSource
                       &src,
-                  const SimulationStage::ConstantGpuSources<>::LODDataSource
-                      &dst) {
+                  SimulationStage::ConstantGpuSources<>::LODDataSource &dst) {
                 copyRes(src.Tildeh0, dst.Tildeh0);
                 copyRes(src.Frequencies, dst.Frequencies);
+                dst.Bounds = src.Bounds;
               };
-          if (newData.highestData) {
-            copyLOD(*newData.highestData, simulationConstantSources.Highest);
-            beforeNextFrame.patchHighestChanged = false;
-          }
-          if (newData.mediumData) {
-            copyLOD(*newData.mediumData, simulationConstantSources.Medium);
-            beforeNextFrame.patchMediumChanged = false;
-          }
-          if (newData.lowestData) {
-            copyLOD(*newData.lowestData, simulationConstantSources.Lowest);
-            beforeNextFrame.patchLowestChanged = false;
-          }
+          if (newSpectra[0])
+            copyLOD(*newSpectra[0], simulationConstantSources.Highest);
+          if (newSpectra[1])
+            copyLOD(*newSpectra[1], simulationConstantSources.Medium);
+          if (newSpectra[2])
+            copyLOD(*newSpectra[2], simulationConstantSources.Lowest);
         }
 
-        // Since we are using this on different queues, it is uploaded twice.
-        GpuVirtualAddress timeDataBuffer =
-            simResource.DynamicBuffer.AddBuffer(timeConstants);
+        // Each cascade is simulated for the time of its plan, the foam
+        // decays over the time since it was simulated last.
+        const u32 slot = (frameCounter + 1) & 0x1u;
+        std::array<GpuVirtualAddress, 3> timeDataBuffers{};
+        std::array<bool, 3> useLod{};
+        for (u32 i = 0; i < useLod.size(); ++i) {
+          const auto &decision = simulationPlans[slot].cascades[i];
+          useLod[i] = decision.simulate;
+          if (decision.simulate)
+            timeDataBuffers[i] = computeUploads.AddBuffer(
+                TimeData{.deltaTime = decision.deltaTime,
+                         .timeSinceLaunch = decision.time});
+        }
 
+        simulationTimer.Begin(computeAllocator, slot);
         WaterSimulationComputeShader(
             simResource, simulationConstantSources, simulationMutableSources,
-            simData, fullSimPipeline, computeAllocator, timeDataBuffer, N,
-            debugValues, debugValues.getChannels());
+            simData, fullSimPipeline, computeAllocator, computeUploads,
+            timeDataBuffers, debugValues, useLod);
+        simulationTimer.End(computeAllocator, slot);
 
         // Upload queue
         {
           auto commandList = computeAllocator.EndList();
           computeAllocator.BeginList();
           simResource.DynamicBuffer.UploadResources(computeAllocator);
-          resourceUploader.UploadResourcesAsync(computeAllocator);
+          resourceUploader.UploadResourcesAsync(
+              computeAllocator, DefaultsValues::App::uploadBudgetPerFrame);
           auto initCommandList = computeAllocator.EndList();
 
           computeQueue.Execute(initCommandList);
@@ -669,6 +834,7 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
 
           simResource.FrameDoneMarker =
               simResource.Fence.EnqueueSignal(computeQueue);
+          computeUploads.EndFrame(frameCounter + 1);
         }
         return true;
       });
@@ -711,12 +877,10 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
                           XMMatrixTranspose(cam.GetINVProj()));
           XMStoreFloat4x4(&cameraConstants.INVvpMatrix,
                           XMMatrixTranspose(cam.GetINVViewProj()));
-          cameraConstantBuffer =
-              frameResource.DynamicBuffer.AddBuffer(cameraConstants);
-          debugConstantBuffer =
-              frameResource.DynamicBuffer.AddBuffer(debugBufferContent);
-          lightsConstantBuffer = frameResource.DynamicBuffer.AddBuffer(sunData);
-          timeDataBuffer = frameResource.DynamicBuffer.AddBuffer(timeConstants);
+          cameraConstantBuffer = uploadRing.AddConstants(cameraConstants);
+          debugConstantBuffer = uploadRing.AddConstants(debugBufferContent);
+          lightsConstantBuffer = uploadRing.AddConstants(sunData);
+          timeDataBuffer = uploadRing.AddBuffer(timeConstants);
         }
 
         // Draw Ocean
@@ -733,22 +897,22 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
           {
             switch (debugValues.mode) {
             case DebugValues::Mode::DisplacementHighest:
-              usedTexture = &drawingSimResource.HighestBuffer.displacementMap;
+              usedTexture = &drawingSimResource.LODs[0]->displacementMap;
               break;
             case DebugValues::Mode::GradientsHighest:
-              usedTexture = &drawingSimResource.HighestBuffer.gradients;
+              usedTexture = &drawingSimResource.LODs[0]->gradients;
               break;
             case DebugValues::Mode::DisplacementMedium:
-              usedTexture = &drawingSimResource.MediumBuffer.displacementMap;
+              usedTexture = &drawingSimResource.LODs[1]->displacementMap;
               break;
             case DebugValues::Mode::GradientsMedium:
-              usedTexture = &drawingSimResource.MediumBuffer.gradients;
+              usedTexture = &drawingSimResource.LODs[1]->gradients;
               break;
             case DebugValues::Mode::DisplacementLowest:
-              usedTexture = &drawingSimResource.LowestBuffer.displacementMap;
+              usedTexture = &drawingSimResource.LODs[2]->displacementMap;
               break;
             case DebugValues::Mode::GradientsLowest:
-              usedTexture = &drawingSimResource.LowestBuffer.gradients;
+              usedTexture = &drawingSimResource.LODs[2]->gradients;
               break;
             default:
               break;
@@ -760,27 +924,24 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
           }
 
           GpuVirtualAddress waterDataBuffer =
-              frameResource.DynamicBuffer.AddBuffer(waterData);
+              uploadRing.AddConstants(waterData);
 
           // Pre translate resources
           GpuVirtualAddress displacementMapAddressHighest =
-              *drawingSimResource.HighestBuffer.displacementMap.ShaderResource(
+              *drawingSimResource.LODs[0]->displacementMap.ShaderResource(
                   allocator);
           GpuVirtualAddress gradientsAddressHighest =
-              *drawingSimResource.HighestBuffer.gradients.ShaderResource(
-                  allocator);
+              *drawingSimResource.LODs[0]->gradients.ShaderResource(allocator);
           GpuVirtualAddress displacementMapAddressMedium =
-              *drawingSimResource.MediumBuffer.displacementMap.ShaderResource(
+              *drawingSimResource.LODs[1]->displacementMap.ShaderResource(
                   allocator);
           GpuVirtualAddress gradientsAddressMedium =
-              *drawingSimResource.MediumBuffer.gradients.ShaderResource(
-                  allocator);
+              *drawingSimResource.LODs[1]->gradients.ShaderResource(allocator);
           GpuVirtualAddress displacementMapAddressLowest =
-              *drawingSimResource.LowestBuffer.displacementMap.ShaderResource(
+              *drawingSimResource.LODs[2]->displacementMap.ShaderResource(
                   allocator);
           GpuVirtualAddress gradientsAddressLowest =
-              *drawingSimResource.LowestBuffer.gradients.ShaderResource(
-                  allocator);
+              *drawingSimResource.LODs[2]->gradients.ShaderResource(allocator);
 
           // Shadow Map pass
           //{
@@ -791,7 +952,7 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
           //      SilhouetteClear::Inp inp{
           //          .buffers = silhouetteDetectorBuffers,
           //      };
-          //      silhouetteClear.Run(allocator, frameResource.DynamicBuffer,
+          //      silhouetteClear.Run(allocator, uploadRing,
           //                          inp);
           //    }
           //    {
@@ -802,7 +963,7 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
           //          .mesh = Box,
           //          .meshBuffers = silhouetteDetectorMeshBuffers,
           //      };
-          //      silhouetteDetector.Run(allocator, frameResource.DynamicBuffer,
+          //      silhouetteDetector.Run(allocator, uploadRing,
           //                             inp);
           //    }
           //  }
@@ -833,13 +994,13 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
             //  SilhouetteDetectorTester::Inp inp{
             //      .camera = cameraConstantBuffer,
             //      .modelTransform =
-            //          frameResource.DynamicBuffer.AddBuffer(boxModelConstants),
+            //          uploadRing.AddConstants(boxModelConstants),
             //      .texture = std::nullopt,
             //      .mesh = Box,
             //      .buffers = silhouetteDetectorBuffers,
             //      .meshBuffers = silhouetteDetectorMeshBuffers,
             //  };
-            //  silhouetteTester.Run(allocator, frameResource.DynamicBuffer,
+            //  silhouetteTester.Run(allocator, uploadRing,
             //  inp); allocator.TransitionResource(
             //      silhouetteDetectorBuffers.EdgeCountBuffer.get()->get(),
             //      ResourceStates::IndirectArgument,
@@ -855,12 +1016,11 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
               XMStoreFloat4x4(&boxModelConstants.mMatrix, boxModel);
               BasicShader::Inp inp{
                   .camera = cameraConstantBuffer,
-                  .modelTransform =
-                      frameResource.DynamicBuffer.AddBuffer(boxModelConstants),
+                  .modelTransform = uploadRing.AddConstants(boxModelConstants),
                   .texture = std::nullopt,
                   .mesh = Box,
               };
-              basicShader.Run(allocator, frameResource.DynamicBuffer, inp);
+              basicShader.Run(allocator, inp);
             }*/
 
             // Water
@@ -873,16 +1033,16 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
 
                 XMStoreFloat4x4(&modelConstants.mMatrix,
                                 XMMatrixTranspose(modelMatrix));
+                modelConstants.oceanBounds =
+                    WaterGraphicRootDescription::GetOceanBounds();
 
                 GpuVirtualAddress modelBuffer =
-                    frameResource.DynamicBuffer.AddBuffer(modelConstants);
+                    uploadRing.AddConstants(modelConstants);
 
                 waterPipelineState.Apply(allocator);
 
-                const auto &oceanQuadData = oceanDataFuture.get();
-                for (auto &curr : oceanQuadData) {
-                  if (curr.N == 0)
-                    continue;
+                const auto &oceanInstances = waitOceanData();
+                if (!oceanInstances.empty()) {
                   auto mask = waterRootSignature.Set(
                       allocator, RootSignatureUsage::Graphics);
 
@@ -898,15 +1058,14 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
 
                   mask.waterPBRBuffer = waterDataBuffer;
 
-                  mask.hullBuffer =
-                      frameResource.DynamicBuffer.AddBuffer(curr.hullConstants);
-                  mask.vertexBuffer = frameResource.DynamicBuffer.AddBuffer(
-                      curr.vertexConstants);
+                  mask.instanceBuffer =
+                      WaterGraphicRootDescription::UploadInstances(
+                          uploadRing, oceanInstances);
                   mask.debugBuffer = debugConstantBuffer;
                   mask.cameraBuffer = cameraConstantBuffer;
                   mask.modelBuffer = modelBuffer;
 
-                  planeMesh.Draw(allocator, curr.N);
+                  planeMesh.Draw(allocator, (u32)oceanInstances.size());
                 }
               } else if (debugValues.drawMethod ==
                          DebugValues::DrawMethod::Parallax) {
@@ -921,7 +1080,7 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
                 modelConstants.PrismHeight = debugValues.prismHeight;
 
                 GpuVirtualAddress modelBuffer =
-                    frameResource.DynamicBuffer.AddBuffer(modelConstants);
+                    uploadRing.AddConstants(modelConstants);
 
                 parallaxDraw.Pre(allocator);
 
@@ -968,9 +1127,11 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
 
                 modelConstants.center = XMFLOAT3{0, -5, 0};
                 modelConstants.PrismHeight = debugValues.prismHeight;
+                modelConstants.oceanBounds =
+                    WaterGraphicRootDescription::GetOceanBounds();
 
                 GpuVirtualAddress modelBuffer =
-                    frameResource.DynamicBuffer.AddBuffer(modelConstants);
+                    uploadRing.AddConstants(modelConstants);
 
                 prismParallaxDraw.Pre(allocator);
                 PrismParallaxDraw::Inp inp{
@@ -996,17 +1157,14 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
                     .modelBuffers = modelBuffer,
                     //.mesh = BoxOnlyWithIndexBuffer,
                     .mesh = BoxWithoutBottom,
-                    .vertexData = GpuVirtualAddress(0),
+                    .instances = GpuVirtualAddress(0),
                 };
 
-                const auto &oceanQuadData = oceanDataFuture.get();
-                for (auto &curr : oceanQuadData) {
-                  if (curr.N == 0)
-                    continue;
-
-                  inp.vertexData = frameResource.DynamicBuffer.AddBuffer(
-                      curr.vertexConstants);
-                  inp.N = curr.N;
+                const auto &oceanInstances = waitOceanData();
+                if (!oceanInstances.empty()) {
+                  inp.instances = WaterGraphicRootDescription::UploadInstances(
+                      uploadRing, oceanInstances);
+                  inp.N = (u32)oceanInstances.size();
                   prismParallaxDraw.Run(allocator, inp);
                 }
               }
@@ -1045,13 +1203,13 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
             // Textures
             mask.skybox = skyboxTexture;
             mask.gradientsHighest =
-                *drawingSimResource.HighestBuffer.gradients.ShaderResource(
+                *drawingSimResource.LODs[0]->gradients.ShaderResource(
                     allocator);
             mask.gradientsMedium =
-                *drawingSimResource.MediumBuffer.gradients.ShaderResource(
+                *drawingSimResource.LODs[1]->gradients.ShaderResource(
                     allocator);
             mask.gradientsLowest =
-                *drawingSimResource.LowestBuffer.gradients.ShaderResource(
+                *drawingSimResource.LODs[2]->gradients.ShaderResource(
                     allocator);
 
             // Buffers
@@ -1059,8 +1217,7 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
             mask.cameraBuffer = cameraConstantBuffer;
             mask.debugBuffer = debugConstantBuffer;
 
-            mask.deferredShaderBuffer =
-                frameResource.DynamicBuffer.AddBuffer(defData);
+            mask.deferredShaderBuffer = uploadRing.AddConstants(defData);
 
             mask.geometryDepth = *frameResource.DepthBuffer.ShaderResource();
 
@@ -1110,21 +1267,38 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
 
           // Retransition simulation resources for compute shaders
 
-          drawingSimResource.HighestBuffer.gradients.UnorderedAccess(allocator);
-          drawingSimResource.HighestBuffer.displacementMap.UnorderedAccess(
-              allocator);
-          drawingSimResource.MediumBuffer.gradients.UnorderedAccess(allocator);
-          drawingSimResource.MediumBuffer.displacementMap.UnorderedAccess(
-              allocator);
-          drawingSimResource.LowestBuffer.gradients.UnorderedAccess(allocator);
-          drawingSimResource.LowestBuffer.displacementMap.UnorderedAccess(
-              allocator);
+          for (auto &lod : drawingSimResource.LODs) {
+            lod->gradients.UnorderedAccess(allocator);
+            lod->displacementMap.UnorderedAccess(allocator);
+          }
           if (usedTexture)
             (*usedTexture)->UnorderedAccess(allocator);
         }
 
         auto CPURenderEnd = std::chrono::high_resolution_clock::now();
         runtimeResults.CPUTime = CPURenderEnd - frameStart;
+        // The build drawn ran ahead, measured into its slot.
+        if (predictionHit) {
+          oceanDataFuture.wait();
+          const RuntimeResults &ahead =
+              cpuBuffers.predictedResults[cpuBuffers.current];
+          runtimeResults.qtNodes = ahead.qtNodes;
+          runtimeResults.drawnNodes = ahead.drawnNodes;
+          runtimeResults.touchedNodes = ahead.touchedNodes;
+          runtimeResults.QuadTreeBuildTime = ahead.QuadTreeBuildTime;
+          runtimeResults.NavigatingTheQuadTree = ahead.NavigatingTheQuadTree;
+        }
+        for (UploadRingBuffer *uploads : {&uploadRing, &computeUploads}) {
+          const auto cacheStats = uploads->GetCacheStatistics();
+          runtimeResults.constantCacheHits += cacheStats.hits;
+          runtimeResults.constantCacheMisses += cacheStats.misses;
+        }
+        const auto uploadStats = resourceUploader.GetStatistics();
+        runtimeResults.queuedUploads = uploadStats.ready + uploadStats.waiting;
+        runtimeResults.uploadStagingBytes = uploadStats.reservedBytes;
+        runtimeResults.cascadePlan = cascadeScheduler.GetPlan();
+        runtimeResults.simulationMeasuredMs =
+            cascadeScheduler.GetStatistics().measuredMs;
         // ImGUI
         if (settings.showImgui) {
           ImGui_ImplDX12_NewFrame();
@@ -1162,6 +1336,7 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
           ImGui::End();
           debugValues.DrawImGui(beforeNextFrame);
           simData.DrawImGui(beforeNextFrame);
+          spectra.DrawImGui();
           DrawImGuiForPSResources(waterData, sunData, defData, true);
 
           ShowImguiLoaderConfig(debugValues, simData, waterData, sunData,
@@ -1181,22 +1356,39 @@ struct App : implements<App, IFrameworkViewSource, IFrameworkView> {
           auto drawCommandList = allocator.EndList();
 
           allocator.BeginList();
-          frameResource.DynamicBuffer.UploadResources(allocator);
-          resourceUploader.UploadResourcesAsync(allocator);
+          resourceUploader.UploadResourcesAsync(
+              allocator, DefaultsValues::App::uploadBudgetPerFrame);
           auto initCommandList = allocator.EndList();
 
           directQueue.Execute(initCommandList);
           directQueue.Execute(drawCommandList);
           frameResource.Marker = frameResource.Fence.EnqueueSignal(directQueue);
+          uploadRing.EndFrame(frameCounter + 1);
         }
       }
 
+      // The build of this frame writes its results, the one for the
+      // prediction of the last frame is not waited for by any other when
+      // this frame draws no quadtree.
+      if (oceanDataFuture.valid())
+        oceanDataFuture.wait();
+      if (predictedLod.valid())
+        predictedLod.wait();
+
       // Present frame
       computeStage.wait();
+      // A cascade left out keeps its last result in the resources drawn
+      // next frame, the outdated one is calculated in next.
+      for (u32 i = 0; i < drawingSimResource.LODs.size(); ++i)
+        if (!simulationPlans[(frameCounter + 1) & 0x1u].cascades[i].simulate)
+          std::swap(drawingSimResource.LODs[i],
+                    calculatingSimResource.LODs[i]);
       swapChain.Present();
       first_loop = false;
     }
     // Wait until everything is done before deleting context
+    if (cpuBuffers.predictedLod.valid())
+      cpuBuffers.predictedLod.wait();
 
     for (auto &frameResource : frameResources) {
       if (frameResource.Marker) {
@@ -1,6 +1,6 @@
 #include "pch.h"
 #include "Camera.h"
-#include "Frustum.hpp"
+#include "Helpers.h"
 #include <DirectXMath.h>
 
 Camera::Camera() {
@@ -60,26 +60,17 @@ void Camera::SetZFar(const float _zf) noexcept {
   m_projectionDirty = true;
 }
 
-Frustum Camera::GetFrustum() const {
-  Frustum frustum{};
-  const float halfVSide = m_zFar * tanf(m_angle * .5f);
-  const float halfHSide = halfVSide * m_aspect;
-  const XMVECTOR frontMultFar =
-      m_zFar *
-      m_forward; // m_forward should point in the +Z direction for DirectX
-
-  frustum.nearFace = {m_eye + m_zNear * m_forward, m_forward};
-  frustum.farFace = {m_eye + frontMultFar, -m_forward};
-  frustum.rightFace = {
-      m_eye, XMVector3Cross(frontMultFar - m_right * halfHSide, m_up)};
-  frustum.leftFace = {m_eye,
-                      XMVector3Cross(m_up, frontMultFar + m_right * halfHSide)};
-  frustum.topFace = {m_eye,
-                     XMVector3Cross(m_right, frontMultFar - m_up * halfVSide)};
-  frustum.bottomFace = {
-      m_eye, XMVector3Cross(frontMultFar + m_up * halfVSide, m_right)};
-
-  return frustum;
+Ocean::Frustum Camera::GetFrustum() const { return GetPose().GetFrustum(); }
+
+Ocean::CameraPose Camera::GetPose() const {
+  return {.eye = ToOcean(m_eye),
+          .forward = ToOcean(m_forward),
+          .right = ToOcean(m_right),
+          .up = ToOcean(m_up),
+          .fovY = m_angle,
+          .aspect = m_aspect,
+          .zNear = m_zNear,
+          .zFar = m_zFar};
 }
 
 bool Camera::Update(float _deltaTime) {
@@ -4,8 +4,6 @@
 using namespace winrt::Windows::UI::Core;
 using namespace DirectX;
 
-struct Frustum;
-
 struct ViewFrustumCoordinates {
   constexpr static std::pair<f32, f32> xRange = {-1.f, 1.f};
   constexpr static std::pair<f32, f32> yRange = {-1.f, 1.f};
@@ -34,7 +32,8 @@ public:
 
   std::array<XMVECTOR, 8> GetFrustumCorners() const;
 
-  Frustum GetFrustum() const;
+  Ocean::Frustum GetFrustum() const;
+  Ocean::CameraPose GetPose() const;
   // Returns true if the view has changed.
   bool Update(float _deltaTime);
 
@@ -80,6 +80,33 @@ FullPipeline SimulationStage::FullPipeline::Create(
                       .mixMaxCompute = mixMaxCompute};
 }
 
+SimulationResources::SimulationResources(
+    const ResourceAllocationContext &context, const SimulationData &simData)
+    : Allocator(*context.Device), Fence(*context.Device),
+      DynamicBuffer(*context.Device) {
+  const std::array<const SimulationData::PatchData *, 3> patches = {
+      &simData.Highest, &simData.Medium, &simData.Lowest};
+  for (u32 i = 0; i < LODs.size(); ++i)
+    LODs[i] = std::make_unique<LODDataBuffers>(context, patches[i]->N,
+                                               patches[i]->M);
+}
+
+bool SimulationResources::IsCompatible(const std::array<u32, 3> &sizes) const {
+  for (u32 i = 0; i < LODs.size(); ++i)
+    if (LODs[i]->N != sizes[i])
+      return false;
+  return true;
+}
+
+void SimulationResources::MakeCompatible(
+    const ResourceAllocationContext &context, const std::array<u32, 3> &sizes) {
+  for (u32 i = 0; i < LODs.size(); ++i)
+    if (LODs[i]->N != sizes[i]) {
+      LODs[i].reset();
+      LODs[i] = std::make_unique<LODDataBuffers>(context, sizes[i], sizes[i]);
+    }
+}
+
 void SimulationStage::WaterSimulationComputeShader(
     SimulationStage::SimulationResources &simResource,
     SimulationStage::ConstantGpuSources<Axodox::Graphics::D3D12::MutableTexture>
@@ -88,7 +115,9 @@ void SimulationStage::WaterSimulationComputeShader(
     const SimulationData &simData,
     SimulationStage::FullPipeline &fullSimPipeline,
     Axodox::Graphics::D3D12::CommandAllocator &computeAllocator,
-    Axodox::Graphics::D3D12::GpuVirtualAddress timeDataBuffer, const u32 &N,
+    UploadRingBuffer &constants,
+    const std::array<Axodox::Graphics::D3D12::GpuVirtualAddress, 3>
+        &timeDataBuffers,
     const DebugValues &debugValues, const std::array<bool, 3> useLod) {
   struct LODData {
   public:
@@ -96,28 +125,23 @@ void SimulationStage::WaterSimulationComputeShader(
     SimulationStage::ConstantGpuSources<>::LODDataSource &sources;
     MutableTexture &Foam;
     GpuVirtualAddress constantBuffer;
+    // Each cascade is simulated for a time of its own.
+    GpuVirtualAddress timeDataBuffer;
   };
 
+  // Every dispatch is of the size of its cascade, the one of the buffers.
+  // The one in simData may be newer, of a spectrum not generated yet.
+  const std::array<const SimulationData::PatchData *, 3> patches = {
+      &simData.Highest, &simData.Medium, &simData.Lowest};
   std::vector<LODData> lodData;
-  if (useLod[0])
-    lodData.emplace_back(
-        simResource.HighestBuffer, simulationConstantSources.Highest,
-        simulationMutableSources.Highest.Foam,
-        simResource.DynamicBuffer.AddBuffer(
-            SimulationStage::LODComputeBuffer(simData.Highest)));
-  if (useLod[1])
-    lodData.emplace_back(
-        simResource.MediumBuffer, simulationConstantSources.Medium,
-        simulationMutableSources.Medium.Foam,
-        simResource.DynamicBuffer.AddBuffer(
-            SimulationStage::LODComputeBuffer(simData.Medium)));
-
-  if (useLod[2])
-    lodData.emplace_back(
-        simResource.LowestBuffer, simulationConstantSources.Lowest,
-        simulationMutableSources.Lowest.Foam,
-        simResource.DynamicBuffer.AddBuffer(
-            SimulationStage::LODComputeBuffer(simData.Lowest)));
+  for (u32 i = 0; i < patches.size(); ++i)
+    if (useLod[i])
+      lodData.emplace_back(*simResource.LODs[i],
+                           *simulationConstantSources.LODs[i],
+                           simulationMutableSources.LODs[i]->Foam,
+                           constants.AddConstants(
+                               SimulationStage::LODComputeBuffer(*patches[i])),
+                           timeDataBuffers[i]);
 
   // Spektrums
   fullSimPipeline.spektrumPipeline.Apply(computeAllocator);
@@ -125,7 +149,7 @@ void SimulationStage::WaterSimulationComputeShader(
     auto mask = fullSimPipeline.spektrumRootDescription.Set(
         computeAllocator, RootSignatureUsage::Compute);
     // Inputs
-    mask.timeDataBuffer = timeDataBuffer;
+    mask.timeDataBuffer = dat.timeDataBuffer;
 
     mask.Tildeh0 = *dat.sources.Tildeh0.ShaderResource();
     mask.Frequencies = *dat.sources.Frequencies.ShaderResource();
@@ -136,23 +160,26 @@ void SimulationStage::WaterSimulationComputeShader(
 
     const auto xGroupSize = 16;
     const auto yGroupSize = 16;
-    const auto sizeX = N;
-    const auto sizeY = N;
+    const auto sizeX = dat.buffers.N;
+    const auto sizeY = dat.buffers.N;
     computeAllocator.Dispatch((sizeX + xGroupSize - 1) / xGroupSize,
                               (sizeY + yGroupSize - 1) / yGroupSize, 1);
   }
   //  FFT
   {
-    const auto doFFT = [&computeAllocator, &N,
+    const auto doFFT = [&computeAllocator,
                         &fullSimPipeline](MutableTextureWithState &inp,
-                                          MutableTextureWithState &out) {
+                                          MutableTextureWithState &out,
+                                          const u32 N) {
       auto mask = fullSimPipeline.FFTRootDescription.Set(
           computeAllocator, RootSignatureUsage::Compute);
 
       mask.Input = *inp.ShaderResource(computeAllocator);
       mask.Output = *out.UnorderedAccess(computeAllocator);
 
-      const auto xGroupSize = 1;
+      // A group transforms heightMapDimensions / N rows of N.
+      const auto xGroupSize =
+          DefaultsValues::ComputeShader::heightMapDimensions / N;
       const auto yGroupSize = 1;
       const auto sizeX = N;
       const auto sizeY = 1;
@@ -179,8 +206,8 @@ void SimulationStage::WaterSimulationComputeShader(
     }
     // Stage1
     for (const LODData &dat : lodData) {
-      doFFT(dat.buffers.tildeh, dat.buffers.tildehBuffer);
-      doFFT(dat.buffers.tildeD, dat.buffers.tildeDBuffer);
+      doFFT(dat.buffers.tildeh, dat.buffers.tildehBuffer, dat.buffers.N);
+      doFFT(dat.buffers.tildeD, dat.buffers.tildeDBuffer, dat.buffers.N);
     }
     // UAV
     for (const LODData &dat : lodData) {
@@ -200,8 +227,8 @@ void SimulationStage::WaterSimulationComputeShader(
     }
     // Stage2
     for (const LODData &dat : lodData) {
-      doFFT(dat.buffers.tildehBuffer, dat.buffers.FFTTildeh);
-      doFFT(dat.buffers.tildeDBuffer, dat.buffers.FFTTildeD);
+      doFFT(dat.buffers.tildehBuffer, dat.buffers.FFTTildeh, dat.buffers.N);
+      doFFT(dat.buffers.tildeDBuffer, dat.buffers.FFTTildeD, dat.buffers.N);
     }
   }
 
@@ -231,8 +258,8 @@ void SimulationStage::WaterSimulationComputeShader(
 
       const auto xGroupSize = 16;
       const auto yGroupSize = 16;
-      const auto sizeX = N;
-      const auto sizeY = N;
+      const auto sizeX = dat.buffers.N;
+      const auto sizeY = dat.buffers.N;
       computeAllocator.Dispatch((sizeX + xGroupSize - 1) / xGroupSize,
                                 (sizeY + yGroupSize - 1) / yGroupSize, 1);
     }
@@ -261,8 +288,8 @@ void SimulationStage::WaterSimulationComputeShader(
 
       const auto xGroupSize = 16;
       const auto yGroupSize = 16;
-      const auto sizeX = N;
-      const auto sizeY = N;
+      const auto sizeX = dat.buffers.N;
+      const auto sizeY = dat.buffers.N;
       computeAllocator.Dispatch((sizeX + xGroupSize - 1) / xGroupSize,
                                 (sizeY + yGroupSize - 1) / yGroupSize, 1);
     }
@@ -283,12 +310,12 @@ void SimulationStage::WaterSimulationComputeShader(
       mask.Gradients = *dat.buffers.gradients.UnorderedAccess(computeAllocator);
 
       mask.Foam = *dat.Foam.UnorderedAccess();
-      mask.timeBuffer = timeDataBuffer;
+      mask.timeBuffer = dat.timeDataBuffer;
 
       const auto xGroupSize = 16;
       const auto yGroupSize = 16;
-      const auto sizeX = N;
-      const auto sizeY = N;
+      const auto sizeX = dat.buffers.N;
+      const auto sizeY = dat.buffers.N;
       computeAllocator.Dispatch((sizeX + xGroupSize - 1) / xGroupSize,
                                 (sizeY + yGroupSize - 1) / yGroupSize, 1);
     }
@@ -309,7 +336,7 @@ void SimulationStage::WaterSimulationComputeShader(
       fullSimPipeline.mixMaxCompute.Run(
           computeAllocator, simResource.DynamicBuffer,
           {.mipLevels = 4,
-           .Extent = N,
+           .Extent = dat.buffers.N,
            .texture =
                dat.buffers.displacementMap.ShaderResource(computeAllocator),
            .mipMaps = uavs});
@@ -325,7 +352,7 @@ void SimulationStage::WaterSimulationComputeShader(
           computeAllocator, simResource.DynamicBuffer,
           {dat.buffers.coneMapBuffer.UnorderedAccess(computeAllocator),
            dat.buffers.displacementMap.ShaderResource(computeAllocator),
-           dat.constantBuffer, N});
+           dat.constantBuffer, dat.buffers.N});
     }
   }
 
@@ -336,7 +363,7 @@ void SimulationStage::WaterSimulationComputeShader(
           computeAllocator, simResource.DynamicBuffer,
           {dat.buffers.coneMapBuffer.UnorderedAccess(computeAllocator),
            dat.buffers.mixMaxDisplacementMap.ShaderResource(computeAllocator),
-           N});
+           dat.buffers.N});
     }
   }
 }
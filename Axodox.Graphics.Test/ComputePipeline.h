@@ -136,7 +136,10 @@ struct SimulationResources {
   DynamicBufferManager DynamicBuffer;
 
 #define useDifferentFFTOutputBuffers false
+  // Of a cascade, N x M.
   struct LODDataBuffers {
+    u32 N;
+    u32 M;
     MutableTextureWithState tildeh;
     MutableTextureWithState tildeD;
     MutableTextureWithState displacementMap;
@@ -165,7 +168,7 @@ struct SimulationResources {
 
     LODDataBuffers(const ResourceAllocationContext &context, const u32 N,
                    const u32 M)
-        : tildeh(context, TextureDefinition::TextureDefinition(
+        : N(N), M(M), tildeh(context, TextureDefinition::TextureDefinition(
                               Format::R32G32_Float, N, M, 0,
                               TextureFlags::UnorderedAccess)),
           tildeD(context, TextureDefinition::TextureDefinition(
@@ -222,19 +225,18 @@ struct SimulationResources {
     }
   };
 
-  LODDataBuffers HighestBuffer;
-  LODDataBuffers MediumBuffer;
-  LODDataBuffers LowestBuffer;
-  const std::array<LODDataBuffers *const, 3> LODs = {
-      &HighestBuffer, &MediumBuffer, &LowestBuffer};
+  // Highest, Medium and Lowest, each of its own size.
+  std::array<std::unique_ptr<LODDataBuffers>, 3> LODs;
 
   explicit SimulationResources(const ResourceAllocationContext &context,
-                               const u32 N, const u32 M)
-      : Allocator(*context.Device),
-
-        Fence(*context.Device), DynamicBuffer(*context.Device),
-        HighestBuffer(context, N, M), MediumBuffer(context, N, M),
-        LowestBuffer(context, N, M) {}
+                               const SimulationData &simData);
+
+  // Whether the buffers are of the sizes (N = M) of the cascades.
+  bool IsCompatible(const std::array<u32, 3> &sizes) const;
+  // Recreates the buffers of the cascades of another size, nothing may use
+  // them anymore.
+  void MakeCompatible(const ResourceAllocationContext &context,
+                      const std::array<u32, 3> &sizes);
 };
 
 template <typename TextureTy = MutableTexture>
@@ -243,21 +245,42 @@ struct ConstantGpuSources {
   struct LODDataSource {
     TextureTy Tildeh0;
     TextureTy Frequencies;
+    // How far the patch displaces the vertices, for culling the quadtree.
+    Ocean::DisplacementBounds Bounds;
+    // Size of the textures.
+    u32 N;
+    u32 M;
     LODDataSource(ResourceAllocationContext &context,
                   const SimulationData::PatchData &inp)
+        : LODDataSource(context, inp, GeneratePatchSpectrum(inp)) {}
+    // From a spectrum generated ahead, only the uploads are left.
+    LODDataSource(ResourceAllocationContext &context,
+                  const SimulationData::PatchData &inp,
+                  const PatchSpectrum &spectrum)
         : Tildeh0(TextureTy(context, CreateTextureData<std::complex<f32>>(
-                                         Format::R32G32_Float, inp.N, inp.M, 0u,
-                                         CalculateTildeh0<f32>(inp)))),
+                                         Format::R32G32B32A32_Float,
+                                         inp.M / 2 + 1, inp.N, 0u,
+                                         spectrum.tildeh0))),
           Frequencies(TextureTy(
               context,
-              CreateTextureData<f32>(Format::R32_Float, inp.N, inp.M, 0u,
-                                     CalculateFrequencies<f32>(inp)))) {}
+              CreateTextureData<f32>(Format::R32_Float, inp.M / 2 + 1, inp.N,
+                                     0u, spectrum.frequencies))),
+          Bounds(spectrum.bounds), N(inp.N), M(inp.M) {}
+
+    // Textures of another size to copy a spectrum of that size to, allocated
+    // with the rest of the resources.
+    void Resize(u32 newN, u32 newM) {
+      Tildeh0.Resize(newM / 2 + 1, newN);
+      Frequencies.Resize(newM / 2 + 1, newN);
+      N = newN;
+      M = newM;
+    }
   };
   LODDataSource Highest;
   LODDataSource Medium;
   LODDataSource Lowest;
-  const std::array<const LODDataSource *const, 3> LODs = {&Highest, &Medium,
-                                                          &Lowest};
+  const std::array<LODDataSource *const, 3> LODs = {&Highest, &Medium,
+                                                    &Lowest};
   ConstantGpuSources(ResourceAllocationContext &context,
                      const SimulationData &inp)
       : Highest(context, inp.Highest), Medium(context, inp.Medium),
@@ -268,19 +291,21 @@ struct MutableGpuSources {
   struct LODDataSource {
     MutableTexture Foam;
     LODDataSource(ResourceAllocationContext &context,
-                  const SimulationData &simData)
+                  const SimulationData::PatchData &patch)
         : Foam(MutableTexture(context,
                               TextureDefinition::TextureDefinition(
-                                  Format::R32G32_Float, simData.N, simData.M, 0,
+                                  Format::R32G32_Float, patch.N, patch.M, 0,
                                   TextureFlags::UnorderedAccess))) {}
   };
   LODDataSource Highest;
   LODDataSource Medium;
   LODDataSource Lowest;
+  const std::array<LODDataSource *const, 3> LODs = {&Highest, &Medium,
+                                                    &Lowest};
   MutableGpuSources(ResourceAllocationContext &context,
                     const SimulationData &simData)
-      : Highest(context, simData), Medium(context, simData),
-        Lowest(context, simData) {}
+      : Highest(context, simData.Highest), Medium(context, simData.Medium),
+        Lowest(context, simData.Lowest) {}
 };
 
 struct FullPipeline {
@@ -312,7 +337,9 @@ void WaterSimulationComputeShader(
     const SimulationData &simData,
     SimulationStage::FullPipeline &fullSimPipeline,
     Axodox::Graphics::D3D12::CommandAllocator &computeAllocator,
-    Axodox::Graphics::D3D12::GpuVirtualAddress timeDataBuffer, const u32 &N,
+    UploadRingBuffer &constants,
+    const std::array<Axodox::Graphics::D3D12::GpuVirtualAddress, 3>
+        &timeDataBuffers,
     const DebugValues &debugValues,
     const std::array<bool, 3> useLod = {true, true, true});
 
@@ -45,6 +45,9 @@ struct DebugValues {
 
   bool enableSSR = false;
   bool lockQuadTree = false;
+  bool incrementalQuadTree = true;
+  // Leaves of the quadtree, 0 to refine by the distance threshold.
+  int quadTreeLeafBudget = 0;
   int maxConeStep = 40;
   float prismHeight = 2;
   float coneStepRelax = 0.9;
@@ -105,6 +108,9 @@ struct DebugValues {
       ImGui::SliderFloat("Cone step relax", &coneStepRelax, 0, 3);
       ImGui::Checkbox("Enable SSR", &enableSSR);
       ImGui::Checkbox("Lock QuadTree", &lockQuadTree);
+      ImGui::Checkbox("Incremental QuadTree", &incrementalQuadTree);
+      ImGui::InputInt("QuadTree Leaf Budget", &quadTreeLeafBudget);
+      quadTreeLeafBudget = std::max(quadTreeLeafBudget, 0);
       ImGui::Checkbox("Cone Creater", &conecreater);
 
       static const std::array<std::string, 3> modeitems = {
@@ -317,6 +323,9 @@ struct RuntimeSettings {
   bool showImgui = true;
   XMFLOAT4 clearColor = DefaultsValues::App::clearColor;
   bool quit = false;
+  f32 simulationBudgetMs = DefaultsValues::App::simulationBudgetMs;
+  std::array<u32, 3> maxCascadeUpdateIntervals =
+      DefaultsValues::App::maxCascadeUpdateIntervals;
   void DrawImGui([[maybe_unused]] NeedToDo &out, bool exclusiveWindow = false) {
     bool cont = true;
     if (exclusiveWindow)
@@ -324,6 +333,15 @@ struct RuntimeSettings {
     if (cont) {
       ImGui::ColorEdit3("clear color", (float *)&clearColor);
       ImGui::Checkbox("Time running", &timeRunning);
+      ImGui::InputFloat("Simulation budget (ms)", &simulationBudgetMs);
+      static const char *cascades[] = {"Highest", "Medium", "Lowest"};
+      for (u32 i = 0; i < maxCascadeUpdateIntervals.size(); ++i) {
+        i32 interval = (i32)maxCascadeUpdateIntervals[i];
+        const std::string text =
+            std::string(cascades[i]) + " max update interval";
+        if (ImGui::SliderInt(text.c_str(), &interval, 1, 8))
+          maxCascadeUpdateIntervals[i] = (u32)interval;
+      }
     }
     if (exclusiveWindow)
       ImGui::End();
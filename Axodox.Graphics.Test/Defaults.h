@@ -41,10 +41,16 @@ public:
   };
 
   struct App {
-    CONST_QUALIFIER u16 maxInstances = ShaderConstantCompat::numInstances;
     CONST_QUALIFIER u32 maxShadowMapMatrices =
         ShaderConstantCompat::maxShadowMapMatrices;
     QUALIFIER f32 oceanSize = 1000.f;
+    // Of the resource uploads recorded into each command list.
+    QUALIFIER u64 uploadBudgetPerFrame = 32 << 20;
+    // Of the GPU time of the simulation per frame, 0 for every cascade every
+    // frame. The cascades are simulated at least every
+    // maxCascadeUpdateIntervals frames regardless.
+    QUALIFIER f32 simulationBudgetMs = 2.f;
+    QUALIFIER std::array<u32, 3> maxCascadeUpdateIntervals = {1, 2, 3};
 
     QUALIFIER XMFLOAT4 clearColor = {37.f / 255.f, 37.f / 255.f, 37.f / 255.f,
                                      0};
@@ -58,8 +64,11 @@ public:
   struct Simulation {
     /// Have to change in common.hlsli as well
     CONST_QUALIFIER u32 N = ComputeShader::heightMapDimensions;
+    /// The cascades may be smaller than N, down to a few thread groups
+    QUALIFIER u32 minN = 4 * ComputeShader::computeShaderGroupsDim1;
 
     static_assert(isPowerOfTwo(N));
+    static_assert(isPowerOfTwo(minN) && minN <= N);
   };
 };
 #undef QUALIFIER
@@ -51,8 +51,7 @@ void FrameResources::Clear(CommandAllocator &allocator) {
 
 FrameResources::FrameResources(const ResourceAllocationContext &context)
     : Allocator(*context.Device), Fence(*context.Device),
-      DynamicBuffer(*context.Device), DepthBuffer(context),
-      ShadowMapTextures(context), GBuffer(context),
+      DepthBuffer(context), ShadowMapTextures(context), GBuffer(context),
       PostProcessingBuffer(context) {}
 
 ShadowMapping::Textures::Textures(const ResourceAllocationContext &context,
@@ -280,93 +279,56 @@ ShadowMapping::Data::Data(const Camera &cam, f32 closestFrustumEnd,
   lods[2].farPlane = cam.GetZFar();
 }
 
-std::vector<WaterGraphicRootDescription::OceanData> &
+WaterGraphicRootDescription::OceanInstances &
 WaterGraphicRootDescription::CollectOceanQuadInfoWithQuadTree(
-    std::vector<WaterGraphicRootDescription::OceanData> &vec, const Camera &cam,
-    const XMMATRIX &mMatrix, const float &quadTreeDistanceThreshold,
-    const Depth &MaxDepth, const DebugValues &debugValues,
+    OceanInstances &instances, QuadTree &qt, const Ocean::CameraPose &pose,
+    const Ocean::Frustum &frustum, const XMMATRIX &mMatrix,
+    const float &quadTreeDistanceThreshold, const Depth &MaxDepth,
+    const Ocean::DisplacementRange &displacement,
+    const DebugValues &debugValues,
     const std::optional<RuntimeResults *> &runtimeResults) {
-  float2 fullSizeXZ = {DefaultsValues::App::oceanSize,
-                       DefaultsValues::App::oceanSize};
-
-  float3 center = {0, 0, 0};
-  QuadTree qt;
-  XMFLOAT3 camUsedPos;
-  XMVECTOR tmp = cam.GetEye();
-  XMStoreFloat3(&camUsedPos, tmp);
-  XMFLOAT3 camDir;
-  tmp = cam.GetForward();
-  XMStoreFloat3(&camDir, tmp);
-
-  decltype(std::chrono::high_resolution_clock::now()) start;
-  if (runtimeResults)
-    start = std::chrono::high_resolution_clock::now();
-
-  qt.Build(center, fullSizeXZ, float3(camUsedPos.x, camUsedPos.y, camUsedPos.z),
-           float3(camDir.x, camDir.y, camDir.z),
-
-           cam.GetFrustum(), mMatrix, quadTreeDistanceThreshold, MaxDepth);
+  const XMFLOAT4 bounds = GetOceanBounds();
+  Ocean::QuadCollectionDescription desc{
+      .center = {bounds.x + bounds.z / 2, 0, bounds.y + bounds.w / 2},
+      .fullSizeXZ = {bounds.z, bounds.w},
+      .camEye = pose.eye,
+      .camForward = pose.forward,
+      .frustum = frustum,
+      .modelMatrix = ToOcean(mMatrix),
+      .distanceThreshold = quadTreeDistanceThreshold,
+      .maxDepth = MaxDepth,
+      .calculateTessellation = !debugValues.calculateParallax(),
+      .incremental = debugValues.incrementalQuadTree,
+      .leafBudget = (u32)debugValues.quadTreeLeafBudget,
+      .displacementLow = displacement.low,
+      .displacementHigh = displacement.high};
+
+  // Only the used instances are written, 8 bytes each, in parallel.
+  Ocean::QuadCollectionStatistics stats;
+  Ocean::CollectOceanQuads(qt, desc, Ocean::ThreadPool::Global(), instances,
+                           &stats);
 
   if (runtimeResults) {
-    (*runtimeResults)->QuadTreeBuildTime += std::chrono::duration_cast<
-        decltype((*runtimeResults)->QuadTreeBuildTime)>(
-        std::chrono::high_resolution_clock::now() - start);
-
-    (*runtimeResults)->qtNodes += qt.GetSize();
+    (*runtimeResults)->qtNodes += stats.qtNodes;
+    (*runtimeResults)->drawnNodes += stats.drawnNodes;
+    (*runtimeResults)->touchedNodes += stats.touchedNodes;
+    (*runtimeResults)->QuadTreeBuildTime += stats.QuadTreeBuildTime;
+    (*runtimeResults)->NavigatingTheQuadTree += stats.NavigatingTheQuadTree;
   }
-  // The best choice is to upload planeBottomLeft and
-  // planeTopRight and kinda of UV coordinate that can go
-  // outside [0,1] and the fract is the actual UV value.
-
-  // Fill buffer with Quad Info
-  {
-    start = std::chrono::high_resolution_clock::now();
-    auto *curr = &vec.emplace_back();
-
-    for (auto it = qt.begin(); it != qt.end(); ++it) {
-      (*runtimeResults)->NavigatingTheQuadTree += std::chrono::duration_cast<
-          decltype((*runtimeResults)->NavigatingTheQuadTree)>(
-          (std::chrono::high_resolution_clock::now() - start));
-      (*runtimeResults)->drawnNodes++;
-
-      static float div = 1.f;
-      {
-        curr->vertexConstants.instanceData[curr->N].scaling = {
-            it->size.x / div, it->size.y / div};
-        curr->vertexConstants.instanceData[curr->N].offset = {it->center.x,
-                                                              it->center.y};
-      }
-      if (!debugValues.calculateParallax()) {
-        start = std::chrono::high_resolution_clock::now();
-
-        auto res = it.GetSmallerNeighbor();
-
-        (*runtimeResults)->NavigatingTheQuadTree += std::chrono::duration_cast<
-            decltype((*runtimeResults)->NavigatingTheQuadTree)>(
-            (std::chrono::high_resolution_clock::now() - start));
-        static const constexpr auto l = [](const float x) -> float {
-          if (x == 0)
-            return 1;
-          else
-            return x;
-        };
-        curr->hullConstants.instanceData[curr->N].TesselationFactor = {
-            l(res.zneg), l(res.xneg), l(res.zpos), l(res.xpos)};
-      }
-
-      curr->N = curr->N + 1;
-      if (curr->N == DefaultsValues::App::maxInstances) {
-        curr = &vec.emplace_back();
-      }
+  return instances;
+}
 
-      start = std::chrono::high_resolution_clock::now();
-    }
+XMFLOAT4 WaterGraphicRootDescription::GetOceanBounds() {
+  constexpr f32 size = DefaultsValues::App::oceanSize;
+  return {-size / 2, -size / 2, size, size};
+}
 
-    // If a quarter of the capacity is unused shrink the vector in a
-    // way that the unused capacity is halfed
-    // how though?
-  }
-  return vec;
+GpuVirtualAddress
+WaterGraphicRootDescription::UploadInstances(UploadRingBuffer &ring,
+                                             const OceanInstances &instances) {
+  return ring.AddBuffer(std::span<const u8>(
+      reinterpret_cast<const u8 *>(instances.data()),
+      instances.size() * sizeof(Ocean::PackedOceanQuad)));
 }
 
 BasicShader::BasicShader(PipelineStateProvider &pipelineProvider,
@@ -404,8 +366,7 @@ void BasicShader::Pre(CommandAllocator &allocator) const {
   pipeline.Apply(allocator);
 }
 
-void BasicShader::Run(CommandAllocator &allocator, DynamicBufferManager &_,
-                      const Inp &inp) const {
+void BasicShader::Run(CommandAllocator &allocator, const Inp &inp) const {
   auto mask = Signature.Set(allocator, RootSignatureUsage::Graphics);
   mask.camera = inp.camera;
   mask.model = inp.modelTransform;
@@ -15,35 +15,14 @@ class Camera;
 struct WaterGraphicRootDescription : public RootSignatureMask {
   struct ModelConstants {
     XMFLOAT4X4 mMatrix;
+    // The corner of the ocean plane in xy, its size in zw, the packed
+    // instances are relative to these.
+    XMFLOAT4 oceanBounds;
   };
 
-  struct VertexConstants {
-    struct InstanceData {
-      XMFLOAT2 scaling;
-      XMFLOAT2 offset;
-    };
-    std::array<InstanceData, DefaultsValues::App::maxInstances> instanceData;
-  };
-  struct HullConstants {
-    struct InstanceData {
-      // zneg,xneg, zpos, xpos
-      union {
-        struct {
-          f32 zneg;
-          f32 xneg;
-          f32 zpos;
-          f32 xpos;
-        };
-        XMFLOAT4 TesselationFactor;
-      };
-    };
-    std::array<InstanceData, DefaultsValues::App::maxInstances> instanceData;
-  };
-  struct OceanData {
-    VertexConstants vertexConstants;
-    HullConstants hullConstants;
-    u16 N = 0;
-  };
+  // The drawn patches, read by the vertex and hull shaders from one
+  // structured buffer.
+  using OceanInstances = std::vector<Ocean::PackedOceanQuad>;
 
   struct PixelShaderPBRData {
     float3 SurfaceColor;
@@ -87,8 +66,7 @@ struct WaterGraphicRootDescription : public RootSignatureMask {
     float _Fresnel = 0.15f;
   };
 
-  RootDescriptor<RootDescriptorType::ConstantBuffer> vertexBuffer;
-  RootDescriptor<RootDescriptorType::ConstantBuffer> hullBuffer;
+  RootDescriptor<RootDescriptorType::ShaderResource> instanceBuffer;
   RootDescriptor<RootDescriptorType::ConstantBuffer> cameraBuffer;
   RootDescriptor<RootDescriptorType::ConstantBuffer> modelBuffer;
   RootDescriptor<RootDescriptorType::ConstantBuffer> debugBuffer;
@@ -108,8 +86,7 @@ struct WaterGraphicRootDescription : public RootSignatureMask {
 
   explicit WaterGraphicRootDescription(const RootSignatureContext &context)
       : RootSignatureMask(context),
-        vertexBuffer(this, {2}, ShaderVisibility::Vertex),
-        hullBuffer(this, {1}, ShaderVisibility::Hull),
+        instanceBuffer(this, {10}, ShaderVisibility::All),
         cameraBuffer(this, {0}, ShaderVisibility::All),
         modelBuffer(this, {1}, ShaderVisibility::Vertex),
         debugBuffer(this, {9}, ShaderVisibility::All),
@@ -134,13 +111,19 @@ struct WaterGraphicRootDescription : public RootSignatureMask {
     Flags = RootSignatureFlags::AllowInputAssemblerInputLayout;
   }
 
-  static std::vector<WaterGraphicRootDescription::OceanData> &
-  CollectOceanQuadInfoWithQuadTree(
-      std::vector<WaterGraphicRootDescription::OceanData> &vec,
-      const Camera &cam, const XMMATRIX &mMatrix,
+  static OceanInstances &CollectOceanQuadInfoWithQuadTree(
+      OceanInstances &instances, QuadTree &qt,
+      const Ocean::CameraPose &pose, const Ocean::Frustum &frustum,
+      const XMMATRIX &mMatrix,
       const float &quadTreeDistanceThreshold, const u32 &MaxDepth,
+      const Ocean::DisplacementRange &displacement,
       const DebugValues &debugValues,
       const std::optional<RuntimeResults *> &runRes = std::nullopt);
+
+  // Bounds of the ocean plane for the shaders, see ModelConstants.
+  static XMFLOAT4 GetOceanBounds();
+  static GpuVirtualAddress UploadInstances(UploadRingBuffer &ring,
+                                           const OceanInstances &instances);
 };
 
 struct DeferredShading : public RootSignatureMask {
@@ -384,8 +367,7 @@ struct BasicShader : ShaderJob {
   static BasicShader WithDefaultShaders(PipelineStateProvider &pipelineProvider,
                                         GraphicsDevice &device);
   void Pre(CommandAllocator &allocator) const override;
-  void Run(CommandAllocator &allocator, DynamicBufferManager &buffermanager,
-           const Inp &inp) const;
+  void Run(CommandAllocator &allocator, const Inp &inp) const;
   ~BasicShader() override = default;
 };
 
@@ -393,7 +375,6 @@ struct FrameResources : ShaderBuffers {
   CommandAllocator Allocator;
   CommandFence Fence;
   CommandFenceMarker Marker;
-  DynamicBufferManager DynamicBuffer;
 
   MutableTextureWithViews DepthBuffer;
 
@@ -373,9 +373,25 @@ private:
 struct RuntimeResults {
   u32 qtNodes = 0;
   u32 drawnNodes = 0;
+  u32 touchedNodes = 0;
   std::chrono::nanoseconds QuadTreeBuildTime{0};
 
   std::chrono::nanoseconds NavigatingTheQuadTree{0};
+  // Spent by the frame waiting for the quadtree where it is drawn, the rest
+  // of the build ran while the frames were recorded.
+  std::chrono::nanoseconds QuadTreeWaitTime{0};
+  u32 lodPredictionHits = 0;
+  u32 lodPredictionMisses = 0;
+  // Since launch, of both queues.
+  u32 constantCacheHits = 0;
+  u32 constantCacheMisses = 0;
+  // Not yet copied, and the staging memory reserved for them.
+  u32 queuedUploads = 0;
+  u64 uploadStagingBytes = 0;
+  // Which cascades the compute of the frame simulates, and the GPU time of
+  // the simulation last measured.
+  Ocean::CascadeScheduler::Plan cascadePlan;
+  f64 simulationMeasuredMs = 0;
   std::chrono::nanoseconds CPUTime{0};
   void DrawImGui(bool exclusiveWindow = false) const {
     bool cont = true;
@@ -383,6 +399,7 @@ struct RuntimeResults {
       cont = ImGui::Begin("Results");
     if (cont) {
       ImGui::Text("QuadTree Nodes = %d", qtNodes);
+      ImGui::Text("QuadTree touched nodes = %d", touchedNodes);
 
       ImGui::Text("QuadTree buildtime %.3f ms/frame",
                   GetDurationInFloatWithPrecision<std::chrono::milliseconds,
@@ -392,6 +409,27 @@ struct RuntimeResults {
                   GetDurationInFloatWithPrecision<std::chrono::milliseconds,
                                                   std::chrono::nanoseconds>(
                       NavigatingTheQuadTree));
+      ImGui::Text("Waiting for QuadTree %.3f ms/frame",
+                  GetDurationInFloatWithPrecision<std::chrono::milliseconds,
+                                                  std::chrono::nanoseconds>(
+                      QuadTreeWaitTime));
+      ImGui::Text("LOD prediction hits %d misses %d", lodPredictionHits,
+                  lodPredictionMisses);
+      ImGui::Text("Constant cache hits %d misses %d", constantCacheHits,
+                  constantCacheMisses);
+      ImGui::Text("Queued uploads %d, staging %.1f MB", queuedUploads,
+                  uploadStagingBytes / (1024.f * 1024.f));
+      ImGui::Text("Simulation %.3f ms estimated, last %.3f ms",
+                  cascadePlan.estimatedMs, simulationMeasuredMs);
+      for (u32 i = 0; i < cascadePlan.cascades.size(); ++i) {
+        const auto &cascade = cascadePlan.cascades[i];
+        if (cascade.simulate)
+          ImGui::Text("Cascade %d simulated %.1f ms ahead, every %.2f frames",
+                      i, cascade.timeOffset * 1000.f, cascade.interval);
+        else
+          ImGui::Text("Cascade %d kept, %d frames old, every %.2f frames", i,
+                      cascade.age, cascade.interval);
+      }
       ImGui::Text("Drawn Nodes: %d", drawnNodes);
       ImGui::Text(
           "CPU time %.3f ms/frame",
@@ -415,6 +453,20 @@ inline float4x4 XMMatrixToFloat4x4(const XMMATRIX &x) {
   return result;
 }
 
+// Conversions to the platform neutral types used by Ocean.Core.
+inline Ocean::float2 ToOcean(const float2 &x) { return {x.x, x.y}; }
+inline Ocean::float3 ToOcean(const float3 &x) { return {x.x, x.y, x.z}; }
+inline Ocean::float3 ToOcean(const XMVECTOR &x) {
+  return ToOcean(XMVECTORToFloat3(x));
+}
+inline Ocean::float4x4 ToOcean(const XMMATRIX &x) {
+  XMFLOAT4X4 stored;
+  XMStoreFloat4x4(&stored, x);
+  Ocean::float4x4 result;
+  std::memcpy(result.m, stored.m, sizeof(result.m));
+  return result;
+}
+
 inline std::string GetLocalFolder() {
   auto localFolder =
       winrt::Windows::Storage::ApplicationData::Current().LocalFolder().Path();
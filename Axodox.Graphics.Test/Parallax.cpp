@@ -211,7 +211,7 @@ void PrismParallaxDraw::Run(CommandAllocator &allocator, const Inp &inp) const {
   mask.debugBuffer = inp.debugBuffers;
   mask.cameraBuffer = inp.cameraBuffer;
   mask.modelBuffer = inp.modelBuffers;
-  mask.vertexBuffer = inp.vertexData;
+  mask.instanceBuffer = inp.instances;
 
   inp.mesh.Draw(allocator, inp.N);
 }
@@ -204,7 +204,7 @@ struct PrismParallaxDraw : ShaderJob {
 
     RootDescriptor<RootDescriptorType::ConstantBuffer> cameraBuffer;
     RootDescriptor<RootDescriptorType::ConstantBuffer> modelBuffer;
-    RootDescriptor<RootDescriptorType::ConstantBuffer> vertexBuffer;
+    RootDescriptor<RootDescriptorType::ShaderResource> instanceBuffer;
     RootDescriptor<RootDescriptorType::ConstantBuffer> debugBuffer;
     RootDescriptor<RootDescriptorType::ConstantBuffer> waterPBRBuffer;
 
@@ -225,7 +225,7 @@ struct PrismParallaxDraw : ShaderJob {
         : RootSignatureMask(context),
           cameraBuffer(this, {0}, ShaderVisibility::All),
           modelBuffer(this, {1}, ShaderVisibility::All),
-          vertexBuffer(this, {2}, ShaderVisibility::All),
+          instanceBuffer(this, {10}, ShaderVisibility::All),
           debugBuffer(this, {9}, ShaderVisibility::All),
           waterPBRBuffer(this, {3}, ShaderVisibility::Pixel),
 
@@ -255,16 +255,8 @@ struct PrismParallaxDraw : ShaderJob {
     XMFLOAT3 center;
 
     float PrismHeight;
-    GpuVirtualAddress Upload(DynamicBufferManager &bufferManager) {
-      return bufferManager.AddBuffer(this);
-    }
-  };
-  struct VertexData {
-    struct InstanceData {
-      XMFLOAT2 scaling;
-      XMFLOAT2 offset;
-    };
-    std::array<InstanceData, DefaultsValues::App::maxInstances> instanceData;
+    // See WaterGraphicRootDescription::ModelConstants.
+    XMFLOAT4 oceanBounds;
     GpuVirtualAddress Upload(DynamicBufferManager &bufferManager) {
       return bufferManager.AddBuffer(this);
     }
@@ -279,7 +271,7 @@ struct PrismParallaxDraw : ShaderJob {
     GpuVirtualAddress waterPBRBuffers;
     GpuVirtualAddress modelBuffers;
     ImmutableMesh &mesh;
-    GpuVirtualAddress vertexData;
+    GpuVirtualAddress instances;
     u32 N;
   };
 
@@ -2,6 +2,7 @@
 Texture2D<float2> readbuff : register(t0);
 RWTexture2D<float2> writebuff : register(u0);
 
+// The largest size, smaller fields pack N / n rows into a group.
 #define N DISP_MAP_SIZE
 #define LOG2_N DISP_MAP_LOG2
 
@@ -19,6 +20,7 @@ output
 2. pass: text = writebuff, buff = output
 
 
+Dispatched with n * n / N groups for an n x n field (at least one).
 */
 
 
@@ -26,43 +28,49 @@ groupshared float2 pingpong[2][N];
 [numthreads(N, 1, 1)]
 void main(uint3 DTid : SV_DispatchThreadID, uint3 LTid : SV_GroupThreadID, uint3 GTid : SV_GroupID)
 {
-    int z = GTid.x;
-    int x = LTid.x;
+    uint n, height;
+    readbuff.GetDimensions(n, height);
+    const int log2n = firstbithigh(n);
+
+    // Row z of length n starts at base in the shared arrays.
+    int x = LTid.x & (n - 1);
+    int base = LTid.x - x;
+    int z = GTid.x * (N >> log2n) + (LTid.x >> log2n);
 
 
     // Rearrange array for FFT
     // We use f32 => 32 bits
 
-    int nj = (reversebits(x) >> (32 - LOG2_N)) & (N - 1);
-    pingpong[0][nj] = readbuff[int2(z, x)];
+    int nj = (reversebits(x) >> (32 - log2n)) & (n - 1);
+    pingpong[0][base + nj] = readbuff[int2(z, x)];
 
 
     
 
     int src = 0;
 
-    for (int s = 1; s <= LOG2_N; ++s)
+    for (int s = 1; s <= log2n; ++s)
     {
         int m = 1L << s; // Height of butterfly group
         int mh = m >> 1; // Half height of butterfly group
 
-        int k = (x * (N / m)) & (N - 1);
+        int k = (x * (n / m)) & (n - 1);
         int i = (x & ~(m - 1)); // Starting row of butterfly group
         int j = (x & (mh - 1)); // Butterfly index in group
 
-        float theta = (TWO_PI * float(k)) / float(N);
+        float theta = (TWO_PI * float(k)) / float(n);
         float2 W_N_k = float2(cos(theta), sin(theta));
     
         GroupMemoryBarrierWithGroupSync();
-        float2 input1 = pingpong[src][i + j + mh];
-        float2 input2 = pingpong[src][i + j];
+        float2 input1 = pingpong[src][base + i + j + mh];
+        float2 input2 = pingpong[src][base + i + j];
 
         src = 1 - src;
-        pingpong[src][x] = input2 + ComplexMul(W_N_k, input1);
+        pingpong[src][base + x] = input2 + ComplexMul(W_N_k, input1);
 
     }
 
-    float2 result = pingpong[src][x];
+    float2 result = pingpong[src][base + x];
 
     writebuff[uint2(x, z)] = result;
 }
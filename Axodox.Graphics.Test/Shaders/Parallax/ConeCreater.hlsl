@@ -8,14 +8,11 @@ cbuffer Test : register(b9)
 }
 
 
-#define N DISP_MAP_SIZE
 #define LOG2_M 4
 #define M (1<<LOG2_M)
 // must be odd
 #define BOXSIZE 11
 #define MHalf (M>>1)
-#define LOG2_N_DIV_M (DISP_MAP_LOG2-LOG2_M)
-#define N_DIV_M (1 << LOG2_N_DIV_M)
 
 #define K (BOXSIZE>>1)
 #define InnerK K
@@ -37,7 +34,7 @@ float naive_method(uint2 px)
     L(-2, +2);L(-1, +2);L(+0, +2);L(+1, +2);L(+2, +2);
     return ta;
 }
-float smart_method(uint2 threadID)
+float smart_method(uint2 threadID, uint N)
 {
     
     float ta = 1.0;
@@ -68,7 +65,7 @@ float smart_method(uint2 threadID)
             {
                 float distance = sqrt(k * k + l * l);
                 ta = min(ta,
-                distance / (hkl - hij) / DISP_MAP_SIZE);
+                distance / (hkl - hij) / N);
             }
         }
     }
@@ -82,11 +79,15 @@ float smart_method(uint2 threadID)
 void main(uint3 DTid : SV_DispatchThreadID, uint3 LTid : SV_GroupThreadID, uint3 GTid : SV_GroupID)
 {
    
+    // The size of this cascade
+    uint N, height;
+    displacement.GetDimensions(N, height);
+
     int2 groupID = GTid.xy;
     int2 threadID = LTid.xy;
 
     
-    int2 loc = (groupID * M + threadID.xy - K) & (DISP_MAP_SIZE - 1);
+    int2 loc = (groupID * M + threadID.xy - K) & (N - 1);
     float h = displacement.Load(int3(loc, 0)).y;
     
     
@@ -102,7 +103,7 @@ void main(uint3 DTid : SV_DispatchThreadID, uint3 LTid : SV_GroupThreadID, uint3
     }
 
     float hij = cache[threadID.x][threadID.y];
-    float ta = smart_method(threadID);
+    float ta = smart_method(threadID, N);
     //float ta = naive_method(threadID);
     
     
@@ -110,7 +111,7 @@ void main(uint3 DTid : SV_DispatchThreadID, uint3 LTid : SV_GroupThreadID, uint3
     // or is it
     const float PATCH_SIZE = constants.patchSize;
     // Why the div by 2?
-    float NN = float(DISP_MAP_SIZE);
+    float NN = float(N);
     const float TILE_SIZE = PATCH_SIZE / NN;
 
     // ta = ta * TILE_SIZE  ;// * NN * NN;
@@ -244,6 +244,10 @@ float3 viewPos, float3 localPos)
     float3 dat;
 
 
+    // The size of the highest cascade
+    uint coneMapSize, coneMapHeight;
+    _coneMap1.GetDimensions(coneMapSize, coneMapHeight);
+
     res.flags = BIT(1);
     for (i = 0; i <
 maxSteps; ++i)
@@ -267,7 +271,7 @@ maxSteps; ++i)
 
         // ensure we atleast reach a new data holding texel.
         float x1 =
-           dcell(GetTextureCoordFromPlaneCoordAndPatch(uv + u, debugValues.patchSizes.r), rayv.xz, DISP_MAP_SIZE) * debugValues.patchSizes.r;
+           dcell(GetTextureCoordFromPlaneCoordAndPatch(uv + u, debugValues.patchSizes.r), rayv.xz, coneMapSize) * debugValues.patchSizes.r;
        // dcell(GetTextureCoordFromPlaneCoordAndPatch(uv, mult), rayv.xz, DISP_MAP_SIZE) * mult;
         
 
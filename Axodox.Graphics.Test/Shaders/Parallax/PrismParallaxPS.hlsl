@@ -1,4 +1,5 @@
 #include "../common.hlsli"
+#include "../oceanInstances.hlsli"
 Texture2D<float4> _texture : register(t9);
 SamplerState _sampler : register(s0);
 
@@ -193,18 +194,9 @@ cbuffer ModelBuffer : register(b1)
     float4x4 mINVMatrix;
     float3 center;
     float PrismHeight;
+    float4 oceanBounds;
 }
 
-struct InstanceData
-{
-    float2 scaling;
-    float2 offset;
-};
-
-cbuffer VertexBuffer : register(b2)
-{
-    InstanceData instances[NUM_INSTANCES];
-};
 
 
 float ConeApprox(
@@ -258,6 +250,10 @@ ConeMarchResult ParallaxConemarch(float3 viewPos, float3 localPos, float2 mid, f
     float3 dat;
 
 
+    // The size of the highest cascade
+    uint coneMapSize, coneMapHeight;
+    _coneMap1.GetDimensions(coneMapSize, coneMapHeight);
+
     res.flags = BIT(1);
     for (i = 0; i < maxSteps; ++i)
     {
@@ -286,7 +282,7 @@ ConeMarchResult ParallaxConemarch(float3 viewPos, float3 localPos, float2 mid, f
 
         // ensure we atleast reach a new data holding texel.
         float x1 =
-           dcell(GetTextureCoordFromPlaneCoordAndPatch(uv + u, debugValues.patchSizes.r), rayv.xz, DISP_MAP_SIZE) * debugValues.patchSizes.r;
+           dcell(GetTextureCoordFromPlaneCoordAndPatch(uv + u, debugValues.patchSizes.r), rayv.xz, coneMapSize) * debugValues.patchSizes.r;
        // dcell(GetTextureCoordFromPlaneCoordAndPatch(uv, mult), rayv.xz, DISP_MAP_SIZE) * mult;
         
 
@@ -336,8 +332,9 @@ output_t main(input_t input)
     //}
     
             
-    float2 centerOfPatch = instances[input.instanceID].offset;
-    float2 halfExtentOfPatch = instances[input.instanceID].scaling / 2;
+    const OceanInstance instance = GetOceanInstance(input.instanceID, oceanBounds);
+    float2 centerOfPatch = instance.offset;
+    float2 halfExtentOfPatch = instance.scaling / 2;
     //if (any(abs(abs((input.localPos - center).xz - centerOfPatch) - halfExtentOfPatch) < 0.001))
     //{
     //    output_t output;
@@ -1,5 +1,6 @@
 
 #include "../common.hlsli"
+#include "../oceanInstances.hlsli"
 
 
 cbuffer CameraBuffer : register(b0)
@@ -13,18 +14,9 @@ cbuffer ModelBuffer : register(b1)
     float4x4 mINVMatrix;
     float3 center;
     float PrismHeight;
+    float4 oceanBounds;
 };
 
-struct InstanceData
-{
-    float2 scaling;
-    float2 offset;
-};
-
-cbuffer VertexBuffer : register(b2)
-{
-    InstanceData instances[NUM_INSTANCES];
-};
 
 
 struct output_t
@@ -53,8 +45,9 @@ output_t main(input_t input)
     uint instanceID = input.instanceID;
     output_t output;
 
-    const float2 scaling = instances[instanceID].scaling;
-    const float2 offset = instances[instanceID].offset;
+    const OceanInstance instance = GetOceanInstance(instanceID, oceanBounds);
+    const float2 scaling = instance.scaling;
+    const float2 offset = instance.offset;
 
     float3 localPos = float3(0, 0, 0);
     localPos.xz = input.localPos.xz * scaling + offset;
@@ -1,6 +1,9 @@
 #include "common.hlsli"
 // HLSL compute shader
-Texture2D<float2> tilde_h0 : register(t0);
+// Half spectra of N x (N / 2 + 1) texels (see HalfSpectrum in Ocean.Core):
+// .xy is h0(k) at the texel, .zw is h0(-k), the one of the texel
+// ((N - x) % N, (N - y) % N).
+Texture2D<float4> tilde_h0 : register(t0);
 Texture2D<float> frequencies : register(t1);
 RWTexture2D<float2> tilde_h : register(u0);
 RWTexture2D<float2> tilde_D : register(u1);
@@ -14,33 +17,49 @@ cbuffer Constants : register(b0)
 
 
 
-#define N DISP_MAP_SIZE
 #define LOG2_M 4
 #define M (1<<LOG2_M)
 #define MHalf (M>>1)
-#define LOG2_N_DIV_M (DISP_MAP_LOG2-LOG2_M)
-#define N_DIV_M (1 << LOG2_N_DIV_M)
 
 
 
+// h0 and w anywhere on the N x N grid, the columns past N / 2 through -k.
+float2 Tildeh0At(int2 loc, int N)
+{
+    if (loc.x <= N / 2)
+        return tilde_h0[loc].xy;
+    return tilde_h0[int2(N - loc.x, (N - loc.y) % N)].zw;
+}
+
+float FrequencyAt(int2 loc, int N)
+{
+    if (loc.x <= N / 2)
+        return frequencies[loc];
+    return frequencies[int2(N - loc.x, (N - loc.y) % N)];
+}
+
 groupshared float2 cache[M][M];
 [numthreads(MHalf, M, 2)]
 void main(uint3 DTid : SV_DispatchThreadID, uint3 LTid : SV_GroupThreadID, uint3 GTid : SV_GroupID)
 {
+    // The size of this cascade
+    uint width, N;
+    tilde_h0.GetDimensions(width, N);
+
     int2 groupID = GTid.xy;
     int2 threadID = LTid.xy;
     bool mirroredInMiddle = LTid.z == 1;
 
     if (mirroredInMiddle)
     {
-        groupID = N_DIV_M - 1 - groupID;
+        groupID = int(N / M) - 1 - groupID;
         threadID = M - 1 - threadID;
     }
     
     int2 loc1 = groupID * M + threadID.xy;
     int2 loc2 = int2(N - 1 - loc1.x, N - 1 - loc1.y);
 
-    float2 h0_k = tilde_h0[loc1].rg;
+    float2 h0_k = Tildeh0At(loc1, N);
     cache[threadID.x][threadID.y] = h0_k;
     GroupMemoryBarrierWithGroupSync();
     float2 h0_mk = cache[M - 1 - threadID.x][M - 1 - threadID.y];
@@ -52,12 +71,12 @@ void main(uint3 DTid : SV_DispatchThreadID, uint3 LTid : SV_GroupThreadID, uint3
     int2 loc1 = DTid.xy;
     int2 loc2 = int2(N - 1 - loc1.x, N - 1 - loc1.y);
     // Load initial spectrum
-    float2 h0_k = tilde_h0[loc1].rg;
-    float2 h0_mk = tilde_h0[loc2].rg;
+    float2 h0_k = Tildeh0At(loc1, N);
+    float2 h0_mk = Tildeh0At(loc2, N);
 */
     
     
-    float w_k = frequencies[loc1].r;
+    float w_k = FrequencyAt(loc1, N);
 
     // Height spectrum
     const float time = timeData.timeSinceLaunch;
@@ -68,7 +87,7 @@ void main(uint3 DTid : SV_DispatchThreadID, uint3 LTid : SV_GroupThreadID, uint3
     
 
     // "Choppy" 
-    float2 k = float2(N / 2 - loc1.x, N / 2 - loc1.y);
+    float2 k = float2(int(N / 2) - loc1.x, int(N / 2) - loc1.y);
     float2 nk = float2(0, 0);
 
     
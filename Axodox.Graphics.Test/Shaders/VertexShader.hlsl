@@ -1,4 +1,5 @@
 #include "common.hlsli"
+#include "oceanInstances.hlsli"
 
 
 
@@ -9,15 +10,7 @@ cbuffer CameraBuffer : register(b0)
 cbuffer ModelBuffer : register(b1)
 {
     float4x4 mMatrix;
-};
-struct InstanceData
-{
-    float2 scaling;
-    float2 offset;
-};
-cbuffer VertexBuffer : register(b2)
-{
-    InstanceData instances[NUM_INSTANCES];
+    float4 oceanBounds;
 };
 struct input_t
 {
@@ -41,8 +34,9 @@ output_t main(input_t input)
 {
     output_t output;
 
-    const float2 scaling = instances[input.instanceID].scaling;
-    const float2 offset = instances[input.instanceID].offset;
+    const OceanInstance instance = GetOceanInstance(input.instanceID, oceanBounds);
+    const float2 scaling = instance.scaling;
+    const float2 offset = instance.offset;
     float2 pos = input.Position.xz * scaling + offset;
     // The problem here is floating point precision. Going far out, thousands of units, this will become inaccurate enough for this to become a problem.
     float2 texCoord = pos;
@@ -1,5 +1,5 @@
-#define NUM_INSTANCES (1 << 12)
 #define DISP_MAP_LOG2 10
+// The size of the largest cascade, the shaders read their own from the textures
 #define DISP_MAP_SIZE (1<<DISP_MAP_LOG2)
 #define MAX_LIGHT_COUNT 1
 
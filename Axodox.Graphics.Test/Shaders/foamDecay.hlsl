@@ -16,11 +16,8 @@ cbuffer Test : register(b9)
 
 #define LOG2_M 4
 
-#define N DISP_MAP_SIZE
 #define M (1<<LOG2_M)
 #define MHalf (M>>1)
-#define LOG2_N_DIV_M (DISP_MAP_LOG2-LOG2_M)
-#define N_DIV_M (1 << LOG2_N_DIV_M)
 
 
 
@@ -7,12 +7,9 @@ cbuffer Test : register(b9)
 }
 
 
-#define N DISP_MAP_SIZE
 #define LOG2_M 4
 #define M (1<<LOG2_M)
 #define MHalf (M>>1)
-#define LOG2_N_DIV_M (DISP_MAP_LOG2-LOG2_M)
-#define N_DIV_M (1 << LOG2_N_DIV_M)
 
 
 
@@ -24,10 +21,14 @@ groupshared float3 cache[M + 2][M + 2];
 void main(uint3 DTid : SV_DispatchThreadID, uint3 LTid : SV_GroupThreadID, uint3 GTid : SV_GroupID)
 {
 
+    // The size of this cascade
+    uint N, height;
+    displacement.GetDimensions(N, height);
+
     const float PATCH_SIZE = constants.patchSize;
     // Why the div by 2?
-    const float TILE_SIZE_X2 = PATCH_SIZE * 2. / float(DISP_MAP_SIZE) / 2.;
-    const float INV_TILE_SIZE = float(DISP_MAP_SIZE) / PATCH_SIZE;
+    const float TILE_SIZE_X2 = PATCH_SIZE * 2. / float(N) / 2.;
+    const float INV_TILE_SIZE = float(N) / PATCH_SIZE;
     
     
     
@@ -35,7 +36,7 @@ void main(uint3 DTid : SV_DispatchThreadID, uint3 LTid : SV_GroupThreadID, uint3
     int2 threadID = LTid.xy;
 
     
-    int2 loc = (groupID * M + threadID.xy - 1) & (DISP_MAP_SIZE - 1);
+    int2 loc = (groupID * M + threadID.xy - 1) & (N - 1);
     cache[threadID.x][threadID.y] = displacement[loc].xyz;
 
     GroupMemoryBarrierWithGroupSync();
@@ -1,10 +1,5 @@
 #include "common.hlsli"
-
-cbuffer HullBuffer : register(b1)
-{
-    // zneg,xneg, zpos, xpos
-    float4 TessellationFactor[NUM_INSTANCES];
-};
+#include "oceanInstances.hlsli"
 
 
 // Input
@@ -152,11 +147,12 @@ HS_CONSTANT_DATA_OUTPUT HSConstantFunction(InputPatch<HS_INPUT_PATCH, 4> patch,
     //output.edges[0] = dostuff(patch[2].Position, patch[0].Position);
     //output.edges[1] = dostuff(patch[2].Position, patch[3].Position);
     
-    uint instanceID = patch[0].instanceID;
-    output.edges[0] *= TessellationFactor[instanceID].g;
-    output.edges[1] *= TessellationFactor[instanceID].b;
-    output.edges[2] *= TessellationFactor[instanceID].a;
-    output.edges[3] *= TessellationFactor[instanceID].r;
+    // zneg,xneg, zpos, xpos
+    const float4 TessellationFactor = GetOceanTessellation(patch[0].instanceID);
+    output.edges[0] *= TessellationFactor.g;
+    output.edges[1] *= TessellationFactor.b;
+    output.edges[2] *= TessellationFactor.a;
+    output.edges[3] *= TessellationFactor.r;
 
     output.inside[1] = (output.edges[1] + output.edges[2]) / 2;
     output.inside[0] = (output.edges[0] + output.edges[3]) / 2;
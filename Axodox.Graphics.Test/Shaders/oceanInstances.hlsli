@@ -0,0 +1,30 @@
+// The drawn patches of the ocean, 8 bytes each, see Ocean::PackedOceanQuad:
+// the cell of the leaf on x and z with a 1 bit above the digits of its
+// level, then the four tessellation ratios as bytes.
+StructuredBuffer<uint2> oceanInstances : register(t10);
+
+struct OceanInstance
+{
+    float2 scaling;
+    float2 offset;
+};
+
+// bounds holds the corner of the ocean plane in xy and its size in zw.
+OceanInstance GetOceanInstance(uint instanceID, float4 bounds)
+{
+    const uint packed = oceanInstances[instanceID].x;
+    const uint2 cell = uint2(packed & 0xFFFF, packed >> 16);
+    const uint level = firstbithigh(cell.x);
+
+    OceanInstance instance;
+    instance.scaling = bounds.zw / float(1u << level);
+    instance.offset = bounds.xy + (float2(cell ^ (1u << level)) + 0.5) * instance.scaling;
+    return instance;
+}
+
+// zneg, xneg, zpos, xpos
+float4 GetOceanTessellation(uint instanceID)
+{
+    const uint packed = oceanInstances[instanceID].y;
+    return float4(packed & 0xFF, (packed >> 8) & 0xFF, (packed >> 16) & 0xFF, packed >> 24);
+}
@@ -72,6 +72,45 @@ bool SimulationData::PatchData::DrawImGui(std::string_view ID) {
   change |= ImGui::InputFloat(text7.c_str(), &foamBias);
   const std::string text8 = "Foam Mult##" + std::string(ID);
   change |= ImGui::InputFloat(text8.c_str(), &foamMult);
+  const std::string text9 = "Seed##" + std::string(ID);
+  i32 seedValue = (i32)seed;
+  change |= ImGui::InputInt(text9.c_str(), &seedValue);
+  seed = (u32)seedValue;
+
+  const std::string text9_2 = "Resolution##" + std::string(ID);
+  if (ImGui::BeginCombo(text9_2.c_str(), std::to_string(N).c_str())) {
+    for (u32 size = DefaultsValues::Simulation::minN;
+         size <= DefaultsValues::Simulation::N; size *= 2)
+      if (ImGui::Selectable(std::to_string(size).c_str(), size == N) &&
+          size != N) {
+        N = M = size;
+        change = true;
+      }
+    ImGui::EndCombo();
+  }
+
+  static const char *spectra[] = {"Phillips", "Pierson-Moskowitz", "JONSWAP",
+                                  "TMA"};
+  const std::string text10 = "Spectrum##" + std::string(ID);
+  i32 spectrumValue = (i32)spectrum;
+  change |= ImGui::Combo(text10.c_str(), &spectrumValue, spectra,
+                         IM_ARRAYSIZE(spectra));
+  spectrum = (Ocean::SpectrumType)spectrumValue;
+  if (spectrum != Ocean::SpectrumType::Phillips) {
+    static const char *spreadings[] = {"cos-2s", "Donelan-Banner"};
+    const std::string text11 = "Spreading##" + std::string(ID);
+    i32 spreadingValue = (i32)spreading;
+    change |= ImGui::Combo(text11.c_str(), &spreadingValue, spreadings,
+                           IM_ARRAYSIZE(spreadings));
+    spreading = (Ocean::Spreading)spreadingValue;
+  }
+  if (spectrum == Ocean::SpectrumType::Jonswap ||
+      spectrum == Ocean::SpectrumType::Tma) {
+    const std::string text12 = "Fetch##" + std::string(ID);
+    change |= ImGui::InputFloat(text12.c_str(), &fetch);
+    const std::string text13 = "Peak Enhancement##" + std::string(ID);
+    change |= ImGui::InputFloat(text13.c_str(), &peakEnhancement);
+  }
   return change;
 }
 
@@ -79,7 +118,38 @@ bool SimulationData::PatchData::compatibleSim(const PatchData &other) {
   return N == other.N && M == other.M && windDirection == other.windDirection &&
          gravity == other.gravity && Depth == other.Depth &&
          patchSize == other.patchSize && Amplitude == other.Amplitude &&
-         WindForce == other.WindForce;
+         WindForce == other.WindForce && seed == other.seed &&
+         spectrum == other.spectrum && spreading == other.spreading &&
+         fetch == other.fetch && peakEnhancement == other.peakEnhancement;
+}
+
+Ocean::SpectrumParameters SimulationData::PatchData::GetSpectrumParameters() const {
+  return {.N = N,
+          .M = M,
+          .patchSize = patchSize,
+          .Amplitude = Amplitude,
+          .WindForce = WindForce,
+          .windDirection = ToOcean(windDirection),
+          .gravity = gravity,
+          .Depth = Depth,
+          .seed = seed,
+          .spectrum = spectrum,
+          .spreading = spreading,
+          .fetch = fetch,
+          .peakEnhancement = peakEnhancement};
+}
+
+PatchSpectrum GeneratePatchSpectrum(const SimulationData::PatchData &dat,
+                                    Ocean::ThreadPool *pool) {
+  auto half = Ocean::CalculateHalfSpectrum(dat.GetSpectrumParameters(), pool);
+  PatchSpectrum res{.frequencies = std::move(half.frequencies),
+                    .bounds = Ocean::CalculateDisplacementBounds(half)};
+  res.tildeh0.resize(2 * half.tildeh0.size());
+  for (size_t i = 0; i < half.tildeh0.size(); ++i) {
+    res.tildeh0[2 * i] = half.tildeh0[i];
+    res.tildeh0[2 * i + 1] = half.tildeh0Mirrored[i];
+  }
+  return res;
 }
 
 static SimulationData Preset1() {
@@ -108,6 +178,7 @@ static SimulationData Preset1() {
                              .windDirection = res.windDirection,
                              .gravity = res.gravity,
                              .Depth = res.Depth,
+                             .seed = 1,
                          },
                      .Medium =
                          {
@@ -125,6 +196,7 @@ static SimulationData Preset1() {
                              .windDirection = res.windDirection,
                              .gravity = res.gravity,
                              .Depth = res.Depth,
+                             .seed = 2,
                          },
                      .Lowest = {
                          .displacementLambda = float3(0.0f, 0.7f, 0.0f),
@@ -141,6 +213,7 @@ static SimulationData Preset1() {
                          .windDirection = res.windDirection,
                          .gravity = res.gravity,
                          .Depth = res.Depth,
+                         .seed = 3,
                      }};
   return res;
 }
@@ -172,6 +245,7 @@ SimulationData OldPreset() {
                              .windDirection = res.windDirection,
                              .gravity = res.gravity,
                              .Depth = res.Depth,
+                             .seed = 1,
                          },
                      .Medium =
                          {
@@ -189,6 +263,7 @@ SimulationData OldPreset() {
                              .windDirection = res.windDirection,
                              .gravity = res.gravity,
                              .Depth = res.Depth,
+                             .seed = 2,
                          },
                      .Lowest = {
                          .displacementLambda = float3(0.0f, 0.5, 0.0f),
@@ -205,6 +280,7 @@ SimulationData OldPreset() {
                          .windDirection = res.windDirection,
                          .gravity = res.gravity,
                          .Depth = res.Depth,
+                         .seed = 3,
                      }};
 
   return res;
@@ -245,6 +321,7 @@ SimulationData SimulationData::Default() {
                              .windDirection = res.windDirection,
                              .gravity = res.gravity,
                              .Depth = res.Depth,
+                             .seed = 1,
                          },
                      .Medium =
                          {
@@ -262,6 +339,7 @@ SimulationData SimulationData::Default() {
                              .windDirection = res.windDirection,
                              .gravity = res.gravity,
                              .Depth = res.Depth,
+                             .seed = 2,
                          },
                      .Lowest = {
                          .displacementLambda = float3(0.0f, 1.0f, 0.0f),
@@ -278,6 +356,7 @@ SimulationData SimulationData::Default() {
                          .windDirection = res.windDirection,
                          .gravity = res.gravity,
                          .Depth = res.Depth,
+                         .seed = 3,
                      }};
 
   return res;
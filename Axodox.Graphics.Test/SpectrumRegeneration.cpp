@@ -0,0 +1,113 @@
+#include "pch.h"
+#include "SpectrumRegeneration.h"
+
+using namespace Axodox::Threading;
+
+namespace {
+// Tildeh0 and Frequencies.
+constexpr u32 TextureCount = 2;
+
+bool IsReady(const std::future<PatchSpectrum> &future) {
+  return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+} // namespace
+
+SpectrumRegeneration::SpectrumRegeneration(
+    BatchedResourceUploader &uploader, const ResourceAllocationContext &context)
+    : uploader(uploader), context(context),
+      pool(Ocean::ThreadPool::DefaultWorkerCount() / 2) {}
+
+SpectrumRegeneration::~SpectrumRegeneration() {
+  // The generations use the pool
+  for (auto &slot : slots)
+    if (slot.generating.valid())
+      slot.generating.wait();
+}
+
+void SpectrumRegeneration::Request(u32 patch,
+                                   const SimulationData::PatchData &data) {
+  slots[patch].requested = data;
+}
+
+void SpectrumRegeneration::Update() {
+  for (auto &slot : slots) {
+    if (slot.generating.valid() && IsReady(slot.generating)) {
+      auto spectrum = slot.generating.get();
+      // Outdated by a newer request
+      if (!slot.requested)
+        slot.generated = Generated{slot.generatingData, std::move(spectrum)};
+    }
+
+    if (!slot.generating.valid() && slot.requested) {
+      slot.generatingData = *slot.requested;
+      slot.requested.reset();
+      slot.generating = threadpool_execute<PatchSpectrum>(
+          [this, data = slot.generatingData] {
+            return GeneratePatchSpectrum(data, &pool);
+          });
+    }
+
+    // An upload in progress is not dropped, its textures are being copied
+    // to. One done and not yet taken is outdated.
+    if (slot.generated && (!slot.upload || slot.upload->IsDone())) {
+      slot.upload = CreateUpload(*slot.generated);
+      slot.generated.reset();
+    }
+  }
+}
+
+std::array<const SpectrumRegeneration::LODDataSource *,
+           SpectrumRegeneration::PatchCount>
+SpectrumRegeneration::TakeReady(u64 fence) {
+  std::array<const LODDataSource *, PatchCount> res{};
+  for (u32 i = 0; i < PatchCount; ++i) {
+    auto &slot = slots[i];
+    if (!slot.upload || !slot.upload->IsDone())
+      continue;
+    res[i] = slot.upload->data.get();
+    retired.push_back({std::move(slot.upload), fence});
+  }
+  return res;
+}
+
+void SpectrumRegeneration::Retire(u64 completed) {
+  std::erase_if(retired, [completed](const Retired &r) {
+    return r.fence <= completed;
+  });
+}
+
+SpectrumRegeneration::State SpectrumRegeneration::GetState(u32 patch) const {
+  const auto &slot = slots[patch];
+  if (slot.generating.valid() || slot.requested)
+    return State::Generating;
+  if (slot.generated || (slot.upload && !slot.upload->IsDone()))
+    return State::Uploading;
+  return slot.upload ? State::Ready : State::Idle;
+}
+
+void SpectrumRegeneration::DrawImGui() const {
+  static const char *patches[] = {"Highest", "Medium", "Lowest"};
+  static const char *states[] = {"up to date", "pending: generating",
+                                 "pending: uploading", "pending: ready"};
+  if (ImGui::Begin("Simulation Data")) {
+    for (u32 i = 0; i < PatchCount; ++i)
+      ImGui::Text("%s spectrum %s", patches[i], states[(u32)GetState(i)]);
+  }
+  ImGui::End();
+}
+
+bool SpectrumRegeneration::Upload::IsDone() const {
+  // Nothing is enqueued before the textures are allocated
+  return group->GetCount() == TextureCount && group->IsDone();
+}
+
+std::unique_ptr<SpectrumRegeneration::Upload>
+SpectrumRegeneration::CreateUpload(const Generated &generated) {
+  auto res = std::make_unique<Upload>();
+  res->group = uploader.CreateGroup(Ocean::UploadPriority::High);
+  res->context = context;
+  res->context.ResourceUploader = res->group.get();
+  res->data = std::make_unique<LODDataSource>(res->context, generated.data,
+                                              generated.spectrum);
+  return res;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "pch.h"
+#include "ComputePipeline.h"
+#include "Simulation.h"
+
+// Regenerates the spectra of the patches without stalling the render loop.
+// The spectrum of a changed patch is generated on a background thread, then
+// its textures are created and uploaded, and only once the upload is done
+// is it handed to the compute stage, which copies it over the one in use.
+// A newer request of a patch replaces the older one still generating.
+class SpectrumRegeneration {
+public:
+  using LODDataSource = SimulationStage::ConstantGpuSources<>::LODDataSource;
+  static constexpr u32 PatchCount = 3;
+
+  enum class State : u8 { Idle, Generating, Uploading, Ready };
+
+  // The textures are created with context, their uploads go through
+  // uploader at High priority.
+  SpectrumRegeneration(BatchedResourceUploader &uploader,
+                       const ResourceAllocationContext &context);
+  ~SpectrumRegeneration();
+
+  void Request(u32 patch, const SimulationData::PatchData &data);
+  // Each frame before the resources are allocated: starts the requested
+  // generations and creates the textures of the generated spectra.
+  void Update();
+  // The patches uploaded since, nullptr for the rest. They are kept until
+  // Retire is called with fence completed, the fence of the compute work
+  // copying them.
+  std::array<const LODDataSource *, PatchCount> TakeReady(u64 fence);
+  void Retire(u64 completed);
+
+  State GetState(u32 patch) const;
+  void DrawImGui() const;
+
+private:
+  // The textures of a patch and their uploads.
+  struct Upload {
+    std::unique_ptr<BatchedResourceUploader::UploadGroup> group;
+    ResourceAllocationContext context;
+    std::unique_ptr<LODDataSource> data;
+
+    bool IsDone() const;
+  };
+  struct Generated {
+    SimulationData::PatchData data;
+    PatchSpectrum spectrum;
+  };
+  struct Slot {
+    std::future<PatchSpectrum> generating;
+    SimulationData::PatchData generatingData;
+    // Waits for the generation in progress.
+    std::optional<SimulationData::PatchData> requested;
+    // Waits for the upload in progress.
+    std::optional<Generated> generated;
+    std::unique_ptr<Upload> upload;
+  };
+  struct Retired {
+    std::unique_ptr<Upload> upload;
+    u64 fence;
+  };
+
+  std::unique_ptr<Upload> CreateUpload(const Generated &generated);
+
+  BatchedResourceUploader &uploader;
+  ResourceAllocationContext context;
+  // Of its own, so the render loop does not wait for the generation in the
+  // global one.
+  Ocean::ThreadPool pool;
+  std::array<Slot, PatchCount> slots;
+  std::vector<Retired> retired;
+};
@@ -0,0 +1,228 @@
+#include "pch.h"
+#include "BatchedResourceUploader.h"
+
+using namespace winrt;
+
+namespace {
+// The staging heap of the base class is not used, this is its least size.
+constexpr u64 UnusedHeapSize = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+} // namespace
+
+class BatchedResourceUploader::PriorityUploader final
+    : public ResourceUploader {
+public:
+  PriorityUploader(const GraphicsDevice &device,
+                   BatchedResourceUploader &owner,
+                   Ocean::UploadPriority priority)
+      : ResourceUploader(device, UnusedHeapSize), owner(owner),
+        priority(priority) {}
+
+  CommandFenceMarker EnqueueUploadTask(Resource *resource,
+                                       const ResourceData *data) override {
+    owner.EnqueueUploadTask(resource, data, priority);
+    return {};
+  }
+
+  Axodox::Threading::async_action
+  UploadResourcesAsync(CommandAllocator &allocator,
+                       uint64_t maxSize) override {
+    return owner.UploadResourcesAsync(allocator, maxSize);
+  }
+
+private:
+  BatchedResourceUploader &owner;
+  Ocean::UploadPriority priority;
+};
+
+struct BatchedResourceUploader::Copy {
+  com_ptr<ID3D12Resource> target;
+  // Released once written to the staging memory
+  std::optional<BufferData> buffer;
+  std::optional<TextureData> texture;
+  // Of the subresources of a texture, from the start of its staging memory
+  std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts;
+  std::vector<UINT> rowCounts;
+  u64 size = 0;
+};
+
+BatchedResourceUploader::BatchedResourceUploader(const GraphicsDevice &device,
+                                                 u64 pageSize, u64 capacity)
+    : ResourceUploader(device, UnusedHeapSize), device(device),
+      queue(
+          [device](u64 size) {
+            return std::make_unique<MappedUploadHeap>(device, size);
+          },
+          pageSize, capacity) {
+  for (u32 i = 0; i < priorityUploaders.size(); ++i)
+    priorityUploaders[i] = std::make_unique<PriorityUploader>(
+        device, *this, (Ocean::UploadPriority)i);
+}
+
+CommandFenceMarker
+BatchedResourceUploader::EnqueueUploadTask(Resource *resource,
+                                           const ResourceData *data) {
+  EnqueueUploadTask(resource, data, Ocean::UploadPriority::Normal);
+  return {};
+}
+
+std::future<void>
+BatchedResourceUploader::EnqueueUploadTask(Resource *resource,
+                                           const ResourceData *data,
+                                           Ocean::UploadPriority priority) {
+  auto copy = std::make_shared<Copy>();
+  copy->target = resource->get();
+  const D3D12_RESOURCE_DESC description = copy->target->GetDesc();
+  if (description.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) {
+    copy->buffer = dynamic_cast<const BufferData &>(*data);
+    copy->size = copy->buffer->ByteCount();
+  } else {
+    copy->texture = dynamic_cast<const TextureData &>(*data);
+    const u32 count = description.MipLevels * description.DepthOrArraySize;
+    copy->layouts.resize(count);
+    copy->rowCounts.resize(count);
+    device->GetCopyableFootprints(&description, 0u, count, 0ull,
+                                  copy->layouts.data(),
+                                  copy->rowCounts.data(), nullptr,
+                                  &copy->size);
+  }
+
+  return queue.Enqueue(
+      {.size = copy->size,
+       .alignment = copy->texture ? D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+                                  : Ocean::UploadRing::DefaultAlignment,
+       .priority = priority,
+       .write =
+           [copy](const Ocean::UploadQueue::Staging &staging) {
+             if (copy->buffer) {
+               const auto bytes = copy->buffer->AsRawSpan();
+               memcpy(staging.data, bytes.data(), bytes.size());
+               copy->buffer.reset();
+               return;
+             }
+
+             const auto mipLevels = copy->target->GetDesc().MipLevels;
+             for (u32 i = 0; i < copy->layouts.size(); ++i) {
+               const auto &layout = copy->layouts[i];
+               uint32_t sourcePitch;
+               const auto bytes =
+                   copy->texture->AsRawSpan(&sourcePitch, i / mipLevels,
+                                            i % mipLevels);
+               const auto stride =
+                   std::min<u64>(sourcePitch, layout.Footprint.RowPitch);
+               const u8 *pSource = bytes.data();
+               u8 *pTarget = staging.data + layout.Offset;
+               const u32 rows = copy->rowCounts[i] * layout.Footprint.Depth;
+               for (u32 row = 0; row < rows; ++row) {
+                 memcpy(pTarget, pSource, stride);
+                 pTarget += layout.Footprint.RowPitch;
+                 pSource += sourcePitch;
+               }
+             }
+             copy->texture.reset();
+           },
+       .record =
+           [copy](const Ocean::UploadQueue::Staging &staging,
+                  const std::any &context) {
+             auto &allocator = *std::any_cast<CommandAllocator *>(context);
+             auto source =
+                 static_cast<const MappedUploadHeap *>(staging.page)
+                     ->GetResource();
+
+             // Assume common state after resource creation and direct /
+             // compute engine use, as ResourceUploader
+             allocator.TransitionResource(copy->target, ResourceStates::Common,
+                                          ResourceStates::CopyDest);
+             if (copy->layouts.empty()) {
+               allocator->CopyBufferRegion(copy->target.get(), 0, source,
+                                           staging.offset, copy->size);
+             }
+             for (u32 i = 0; i < copy->layouts.size(); ++i) {
+               D3D12_TEXTURE_COPY_LOCATION sourceLocation{
+                   .pResource = source,
+                   .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+                   .PlacedFootprint = copy->layouts[i]};
+               sourceLocation.PlacedFootprint.Offset += staging.offset;
+
+               D3D12_TEXTURE_COPY_LOCATION targetLocation{
+                   .pResource = copy->target.get(),
+                   .Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+                   .SubresourceIndex = i};
+
+               allocator->CopyTextureRegion(&targetLocation, 0u, 0u, 0u,
+                                            &sourceLocation, nullptr);
+             }
+             allocator.TransitionResource(copy->target,
+                                          ResourceStates::CopyDest,
+                                          ResourceStates::Common);
+           }});
+}
+
+Axodox::Threading::async_action
+BatchedResourceUploader::UploadResourcesAsync(CommandAllocator &allocator,
+                                              uint64_t maxSize) {
+  const u64 batch = queue.Drain(maxSize, &allocator);
+  if (!batch)
+    co_return;
+
+  CommandFence &fence = GetFence(allocator);
+  const CommandFenceMarker marker = fence.CreateMarker();
+  allocator.AddSignaler(marker);
+  co_await fence.AwaitAsync(marker);
+
+  // Stages the uploads waiting for staging memory
+  queue.Complete(batch);
+}
+
+ResourceUploader *
+BatchedResourceUploader::WithPriority(Ocean::UploadPriority priority) {
+  return priorityUploaders[(u32)priority].get();
+}
+
+std::unique_ptr<BatchedResourceUploader::UploadGroup>
+BatchedResourceUploader::CreateGroup(Ocean::UploadPriority priority) {
+  return std::make_unique<UploadGroup>(*this, priority);
+}
+
+Ocean::UploadQueue::Statistics BatchedResourceUploader::GetStatistics() const {
+  return queue.GetStatistics();
+}
+
+CommandFence &BatchedResourceUploader::GetFence(CommandAllocator &allocator) {
+  std::lock_guard lock(fenceMutex);
+  auto &fence = fences[&allocator];
+  if (!fence)
+    fence = std::make_unique<CommandFence>(device);
+  return *fence;
+}
+
+BatchedResourceUploader::UploadGroup::UploadGroup(
+    BatchedResourceUploader &owner, Ocean::UploadPriority priority)
+    : ResourceUploader(owner.device, UnusedHeapSize), owner(owner),
+      priority(priority) {}
+
+CommandFenceMarker BatchedResourceUploader::UploadGroup::EnqueueUploadTask(
+    Resource *resource, const ResourceData *data) {
+  auto upload = owner.EnqueueUploadTask(resource, data, priority);
+  std::lock_guard lock(mutex);
+  uploads.push_back(std::move(upload));
+  return {};
+}
+
+Axodox::Threading::async_action
+BatchedResourceUploader::UploadGroup::UploadResourcesAsync(
+    CommandAllocator &allocator, uint64_t maxSize) {
+  return owner.UploadResourcesAsync(allocator, maxSize);
+}
+
+u32 BatchedResourceUploader::UploadGroup::GetCount() const {
+  std::lock_guard lock(mutex);
+  return (u32)uploads.size();
+}
+
+bool BatchedResourceUploader::UploadGroup::IsDone() const {
+  std::lock_guard lock(mutex);
+  return std::ranges::all_of(uploads, [](const std::future<void> &upload) {
+    return upload.wait_for(std::chrono::seconds(0)) ==
+           std::future_status::ready;
+  });
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "pch.h"
+#include "UploadRingBuffer.h"
+using namespace Axodox::Graphics::D3D12;
+
+/// <summary>
+/// ResourceUploader on Ocean::UploadQueue: the uploads share the pages of a
+/// persistently mapped staging memory instead of a placed resource each,
+/// are copied the most urgent first up to the maxSize of
+/// UploadResourcesAsync, and never block the thread enqueueing them. When
+/// the staging memory is full the upload waits in the queue.
+/// The uploads of the library go through EnqueueUploadTask without a
+/// priority, at Normal. To give the uploads of a resource another priority,
+/// allocate it with a context whose ResourceUploader is WithPriority.
+/// </summary>
+class BatchedResourceUploader final : public ResourceUploader {
+public:
+  explicit BatchedResourceUploader(const GraphicsDevice &device,
+                                   u64 pageSize = 4 << 20,
+                                   u64 capacity = u64(640) << 20);
+
+  /// Returns no marker, AwaitUploadTask does not apply: the overload with a
+  /// priority returns a future instead.
+  CommandFenceMarker EnqueueUploadTask(Resource *resource,
+                                       const ResourceData *data) override;
+  /// The data is copied, the future is set once the upload is done.
+  std::future<void> EnqueueUploadTask(Resource *resource,
+                                      const ResourceData *data,
+                                      Ocean::UploadPriority priority);
+
+  Axodox::Threading::async_action
+  UploadResourcesAsync(CommandAllocator &allocator,
+                       uint64_t maxSize = 0) override;
+
+  ResourceUploader *WithPriority(Ocean::UploadPriority priority);
+
+  /// Uploads of the resources allocated with it, telling when all of them
+  /// are done.
+  class UploadGroup final : public ResourceUploader {
+  public:
+    UploadGroup(BatchedResourceUploader &owner,
+                Ocean::UploadPriority priority);
+
+    CommandFenceMarker EnqueueUploadTask(Resource *resource,
+                                         const ResourceData *data) override;
+    Axodox::Threading::async_action
+    UploadResourcesAsync(CommandAllocator &allocator,
+                         uint64_t maxSize) override;
+
+    /// The uploads enqueued so far, 0 before the resources are allocated.
+    u32 GetCount() const;
+    bool IsDone() const;
+
+  private:
+    BatchedResourceUploader &owner;
+    Ocean::UploadPriority priority;
+    mutable std::mutex mutex;
+    std::vector<std::future<void>> uploads;
+  };
+  std::unique_ptr<UploadGroup> CreateGroup(Ocean::UploadPriority priority);
+
+  Ocean::UploadQueue::Statistics GetStatistics() const;
+
+private:
+  class PriorityUploader;
+  struct Copy;
+
+  CommandFence &GetFence(CommandAllocator &allocator);
+
+  GraphicsDevice device;
+  Ocean::UploadQueue queue;
+  std::array<std::unique_ptr<PriorityUploader>,
+             Ocean::UploadQueue::PriorityCount>
+      priorityUploaders;
+  // One for each command list, which always goes to the same queue, so
+  // the fence values signaled never decrease.
+  std::mutex fenceMutex;
+  std::unordered_map<CommandAllocator *, std::unique_ptr<CommandFence>>
+      fences;
+};
@@ -0,0 +1,71 @@
+#include "pch.h"
+#include "GpuTimer.h"
+
+using namespace winrt;
+
+GpuTimer::GpuTimer(const GraphicsDevice &device, const CommandQueue &queue,
+                   u32 slots)
+    : pending(slots, false) {
+  const D3D12_QUERY_HEAP_DESC heapDescription{
+      .Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP,
+      .Count = 2 * slots,
+      .NodeMask = 0};
+  check_hresult(
+      device->CreateQueryHeap(&heapDescription, IID_PPV_ARGS(heap.put())));
+
+  D3D12_HEAP_PROPERTIES heapProperties{
+      .Type = D3D12_HEAP_TYPE_READBACK,
+      .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
+      .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
+      .CreationNodeMask = 0,
+      .VisibleNodeMask = 0};
+
+  D3D12_RESOURCE_DESC resourceDescription{
+      .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+      .Alignment = 0,
+      .Width = 2 * slots * sizeof(u64),
+      .Height = 1,
+      .DepthOrArraySize = 1,
+      .MipLevels = 1,
+      .Format = DXGI_FORMAT_UNKNOWN,
+      .SampleDesc = {1u, 0u},
+      .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
+      .Flags = D3D12_RESOURCE_FLAG_NONE};
+
+  // Readback heaps must stay in the copy destination state
+  check_hresult(device->CreateCommittedResource(
+      &heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDescription,
+      D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(readback.put())));
+
+  u64 frequency = 0;
+  check_hresult(queue->GetTimestampFrequency(&frequency));
+  msPerTick = 1000.0 / (f64)frequency;
+}
+
+void GpuTimer::Begin(CommandAllocator &allocator, u32 slot) {
+  allocator->EndQuery(heap.get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 * slot);
+}
+
+void GpuTimer::End(CommandAllocator &allocator, u32 slot) {
+  allocator->EndQuery(heap.get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 * slot + 1);
+  allocator->ResolveQueryData(heap.get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 * slot,
+                              2, readback.get(), 2 * slot * sizeof(u64));
+  pending[slot] = true;
+}
+
+std::optional<f64> GpuTimer::Read(u32 slot) {
+  if (!pending[slot])
+    return std::nullopt;
+  pending[slot] = false;
+
+  const D3D12_RANGE readRange{2 * slot * sizeof(u64),
+                              (2 * slot + 2) * sizeof(u64)};
+  void *mapped = nullptr;
+  check_hresult(readback->Map(0, &readRange, &mapped));
+  const u64 *ticks = static_cast<const u64 *>(mapped) + 2 * slot;
+  const f64 res = (f64)(ticks[1] - ticks[0]) * msPerTick;
+  // The CPU wrote nothing
+  const D3D12_RANGE writeRange{0, 0};
+  readback->Unmap(0, &writeRange);
+  return res;
+}
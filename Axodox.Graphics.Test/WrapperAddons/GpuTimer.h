@@ -0,0 +1,26 @@
+#pragma once
+#include "pch.h"
+using namespace Axodox::Graphics::D3D12;
+
+/// <summary>
+/// GPU time between two points of a command list, from timestamp queries.
+/// Each slot is one measurement in flight, read back once the GPU is done
+/// with the commands recorded for it.
+/// </summary>
+class GpuTimer {
+public:
+  GpuTimer(const GraphicsDevice &device, const CommandQueue &queue,
+           u32 slots = 2);
+
+  void Begin(CommandAllocator &allocator, u32 slot);
+  /// Also resolves the slot into the readback buffer.
+  void End(CommandAllocator &allocator, u32 slot);
+  /// In milliseconds, once per End. The commands of the slot must be done.
+  std::optional<f64> Read(u32 slot);
+
+private:
+  winrt::com_ptr<ID3D12QueryHeap> heap;
+  winrt::com_ptr<ID3D12Resource> readback;
+  f64 msPerTick = 0;
+  std::vector<bool> pending;
+};
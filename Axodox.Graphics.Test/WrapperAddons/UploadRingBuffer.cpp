@@ -0,0 +1,80 @@
+#include "pch.h"
+#include "UploadRingBuffer.h"
+
+using namespace winrt;
+
+MappedUploadHeap::MappedUploadHeap(const GraphicsDevice &device, u64 size) {
+  D3D12_HEAP_PROPERTIES heapProperties{
+      .Type = D3D12_HEAP_TYPE_UPLOAD,
+      .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
+      .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
+      .CreationNodeMask = 0,
+      .VisibleNodeMask = 0};
+
+  D3D12_RESOURCE_DESC resourceDescription{
+      .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+      .Alignment = 0,
+      .Width = size,
+      .Height = 1,
+      .DepthOrArraySize = 1,
+      .MipLevels = 1,
+      .Format = DXGI_FORMAT_UNKNOWN,
+      .SampleDesc = {1u, 0u},
+      .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
+      .Flags = D3D12_RESOURCE_FLAG_NONE};
+
+  // Upload heaps must stay in the generic read state
+  check_hresult(device->CreateCommittedResource(
+      &heapProperties, D3D12_HEAP_FLAG_CREATE_NOT_ZEROED, &resourceDescription,
+      D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+      IID_PPV_ARGS(buffer.put())));
+
+  // The CPU only writes it
+  const D3D12_RANGE readRange{0, 0};
+  void *mapped = nullptr;
+  check_hresult(buffer->Map(0, &readRange, &mapped));
+  data = static_cast<u8 *>(mapped);
+  gpuAddress = buffer->GetGPUVirtualAddress();
+}
+
+MappedUploadHeap::~MappedUploadHeap() { buffer->Unmap(0, nullptr); }
+
+UploadRingBuffer::UploadRingBuffer(const GraphicsDevice &device,
+                                   u64 initialSize)
+    : ring(
+          [device](u64 size) {
+            return std::make_unique<MappedUploadHeap>(device, size);
+          },
+          initialSize),
+      cache([device](u64 size) {
+        return std::make_unique<MappedUploadHeap>(device, size);
+      }) {}
+
+GpuVirtualAddress
+UploadRingBuffer::AddBuffer(std::span<const uint8_t> buffer) {
+  std::lock_guard lock(mutex);
+  return ring.Write(buffer);
+}
+
+GpuVirtualAddress
+UploadRingBuffer::AddConstants(std::span<const uint8_t> buffer) {
+  std::lock_guard lock(mutex);
+  return cache.Write(buffer);
+}
+
+void UploadRingBuffer::EndFrame(u64 fence) {
+  std::lock_guard lock(mutex);
+  ring.EndFrame(fence);
+  cache.EndFrame(fence);
+}
+
+void UploadRingBuffer::Retire(u64 completed) {
+  std::lock_guard lock(mutex);
+  ring.Retire(completed);
+  cache.Retire(completed);
+}
+
+Ocean::ConstantCache::Statistics UploadRingBuffer::GetCacheStatistics() {
+  std::lock_guard lock(mutex);
+  return cache.GetStatistics();
+}
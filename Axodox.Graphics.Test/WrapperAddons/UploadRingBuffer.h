@@ -0,0 +1,60 @@
+#pragma once
+#include "pch.h"
+using namespace Axodox::Graphics::D3D12;
+
+/// <summary>
+/// An upload heap buffer mapped once for its whole lifetime. The GPU reads
+/// the constants from it directly.
+/// </summary>
+class MappedUploadHeap final : public Ocean::UploadMemory {
+public:
+  MappedUploadHeap(const GraphicsDevice &device, u64 size);
+  ~MappedUploadHeap() override;
+
+  u8 *GetData() override { return data; }
+  u64 GetGpuAddress() const override { return gpuAddress; }
+  ID3D12Resource *GetResource() const { return buffer.get(); }
+
+private:
+  winrt::com_ptr<ID3D12Resource> buffer;
+  u8 *data = nullptr;
+  u64 gpuAddress = 0;
+};
+
+/// <summary>
+/// Drop in for DynamicBufferManager on the graphics queue: the buffers are
+/// written straight into a persistently mapped ring, so there is no copy
+/// into a default buffer and no barrier before drawing. Shared by the frames
+/// in flight, each closed with EndFrame and released with Retire once the
+/// GPU is done with it. AddConstants goes through a cache instead, for
+/// constants which rarely change: unchanged ones are not written again.
+/// </summary>
+class UploadRingBuffer {
+public:
+  explicit UploadRingBuffer(const GraphicsDevice &device,
+                            u64 initialSize = 1 << 20);
+
+  [[nodiscard]] GpuVirtualAddress AddBuffer(std::span<const uint8_t> buffer);
+
+  template <typename T>
+  [[nodiscard]] GpuVirtualAddress AddBuffer(const T &value) {
+    return AddBuffer(Axodox::Infrastructure::to_span(value));
+  }
+
+  [[nodiscard]] GpuVirtualAddress AddConstants(std::span<const uint8_t> buffer);
+
+  template <typename T>
+  [[nodiscard]] GpuVirtualAddress AddConstants(const T &value) {
+    return AddConstants(Axodox::Infrastructure::to_span(value));
+  }
+
+  void EndFrame(u64 fence);
+  void Retire(u64 completed);
+
+  Ocean::ConstantCache::Statistics GetCacheStatistics();
+
+private:
+  std::mutex mutex;
+  Ocean::UploadRing ring;
+  Ocean::ConstantCache cache;
+};
@@ -1,6 +1,9 @@
 #pragma once
+#include "BatchedResourceUploader.h"
 #include "ConstantGPUBuffer.h"
 #include "CubeMap.h"
+#include "GpuTimer.h"
 #include "MutableTextureWithViews.h"
 #include "StructuredObject.h"
 #include "ResourceTransitor.h"
+#include "UploadRingBuffer.h"
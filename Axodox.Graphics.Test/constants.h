@@ -3,7 +3,6 @@
 #include "Typedefs.h"
 #define CONST_QUALIFIER static const constexpr
 namespace ShaderConstantCompat {
-CONST_QUALIFIER u32 numInstances = NUM_INSTANCES;
 CONST_QUALIFIER u32 dispMapLog2 = DISP_MAP_LOG2;
 CONST_QUALIFIER u32 dispMapSize = DISP_MAP_SIZE;
 CONST_QUALIFIER f32 defaultTesselation = DEFAULT_TESSELATION;
@@ -11,7 +10,6 @@ CONST_QUALIFIER u32 maxLightCount = MAX_LIGHT_COUNT;
 CONST_QUALIFIER u32 maxShadowMapMatrices = MAX_SHADOWMAP_MATRICES;
 } // namespace ShaderConstantCompat
 
-#undef NUM_INSTANCES
 #undef DISP_MAP_LOG2
 #undef DISP_MAP_SIZE
 #undef DEFAULT_TESSELATION
@@ -17,4 +17,5 @@
 #include "../ImGUI/Includes/includes.h"
 
 #include "Typedefs.h"
+#include "Include/Ocean.Core.h"
 #include "WrapperAddons/includes.h"
@@ -0,0 +1,58 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "Ocean/Typedefs.h"
+
+// Tiny timing harness shared by the headless benchmarks. Every benchmark is a
+// standalone executable printing one line per measured configuration.
+namespace Ocean::Benchmarks {
+struct Result {
+  f64 minMs = 0;
+  f64 medianMs = 0;
+  f64 meanMs = 0;
+  u32 iterations = 0;
+};
+
+// Keeps the optimizer from discarding a computed value.
+template <typename T> inline void DoNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const T *sink;
+  sink = &value;
+#endif
+}
+
+template <typename Fn>
+Result Measure(Fn &&fn, u32 iterations = 10, u32 warmup = 1) {
+  using clock = std::chrono::high_resolution_clock;
+  for (u32 i = 0; i < warmup; ++i)
+    fn();
+
+  std::vector<f64> times;
+  times.reserve(iterations);
+  for (u32 i = 0; i < iterations; ++i) {
+    const auto start = clock::now();
+    fn();
+    times.push_back(
+        std::chrono::duration<f64, std::milli>(clock::now() - start).count());
+  }
+  std::ranges::sort(times);
+
+  Result res;
+  res.iterations = iterations;
+  res.minMs = times.front();
+  res.medianMs = times[times.size() / 2];
+  for (f64 t : times)
+    res.meanMs += t;
+  res.meanMs /= (f64)times.size();
+  return res;
+}
+
+inline void Print(const char *name, const Result &res) {
+  std::printf("%-48s min %9.3f ms  median %9.3f ms  mean %9.3f ms\n", name,
+              res.minMs, res.medianMs, res.meanMs);
+}
+} // namespace Ocean::Benchmarks
@@ -0,0 +1,151 @@
+#include "Ocean/Culling/CameraPredictor.h"
+#include <cstdio>
+#include "Benchmark.h"
+#include "Scene.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+constexpr f32 DeltaTime = 1.f / 60.f;
+
+// A camera steered by hand: the speed and the turn rate change in steps
+// every so often, as keys are pressed and the mouse is dragged.
+class SteeredCamera {
+public:
+  ViewPoint Next() {
+    constexpr f32 Speeds[] = {0.f, 5.f, 16.f, 40.f, 16.f};
+    constexpr f32 Turns[] = {0.f, 0.5f, -1.f, 2.f, 0.f, -0.25f};
+    speed = Speeds[frame / 45 % std::size(Speeds)];
+    turn = Turns[frame / 30 % std::size(Turns)];
+    heading += turn * DeltaTime;
+    const float3 forward = {std::cos(heading) * std::cos(Pitch),
+                            std::sin(Pitch),
+                            std::sin(heading) * std::cos(Pitch)};
+    eye += forward * float3(1, 0, 1) * (speed * DeltaTime);
+    ++frame;
+    return ViewPoint::LookAt(eye, eye + forward);
+  }
+
+private:
+  static constexpr f32 Pitch = -0.3f;
+  u32 frame = 0;
+  f32 speed = 0, turn = 0, heading = 0;
+  float3 eye = {0, 8, 0};
+};
+
+// Whether any of the flat cell is inside the frustum, exactly: the
+// per-plane test of AABB::isOnFrustum also passes some boxes outside of it.
+bool Intersects(const Frustum &frustum, const Node &cell, f32 height,
+                const float4x4 &model) {
+  const float2 low = cell.center - cell.size / 2;
+  const float2 high = cell.center + cell.size / 2;
+  std::vector<float3> polygon = {
+      TransformCoord(float3(low.x, height, low.y), model),
+      TransformCoord(float3(high.x, height, low.y), model),
+      TransformCoord(float3(high.x, height, high.y), model),
+      TransformCoord(float3(low.x, height, high.y), model)};
+  std::vector<float3> clipped;
+  for (const Plane *plane :
+       {&frustum.topFace, &frustum.bottomFace, &frustum.rightFace,
+        &frustum.leftFace, &frustum.farFace, &frustum.nearFace}) {
+    clipped.clear();
+    for (size_t i = 0; i < polygon.size(); ++i) {
+      const float3 &a = polygon[i];
+      const float3 &b = polygon[(i + 1) % polygon.size()];
+      const f32 da = plane->getSignedDistanceToPlane(a);
+      const f32 db = plane->getSignedDistanceToPlane(b);
+      if (da >= 0)
+        clipped.push_back(a);
+      if ((da >= 0) != (db >= 0))
+        clipped.push_back(a + (b - a) * (da / (da - db)));
+    }
+    polygon.swap(clipped);
+    if (polygon.empty())
+      return false;
+  }
+  return true;
+}
+
+// Leaves of the tree built for the prediction which the frustum of the
+// actual camera sees, but which were left unsplit though near.
+u32 FalseCulls(const QuadTree &qt, const QuadCollectionDescription &desc,
+               const Frustum &actual) {
+  u32 res = 0;
+  for (const QuadTree::Leaf &leaf : qt.GetLeaves()) {
+    const Node cell = qt.GetNode(leaf);
+    const float3 diff = {cell.center.x - desc.camEye.x,
+                         desc.center.y - desc.camEye.y,
+                         cell.center.y - desc.camEye.z};
+    const bool near =
+        dot(diff, diff) / (cell.size.x * cell.size.y) < desc.distanceThreshold;
+    res += leaf.level < desc.maxDepth && near &&
+           Intersects(actual, cell, desc.center.y, desc.modelMatrix);
+  }
+  return res;
+}
+} // namespace
+
+int main() {
+  constexpr u32 Frames = 1800;
+  constexpr Depth MaxDepth = 9;
+  SteeredCamera camera;
+  CameraPredictor predictor;
+  QuadTree predicted, actual;
+
+  u32 hits = 0, falseCulls = 0, stationary = 0;
+  u64 predictedLeaves = 0, actualLeaves = 0;
+  f64 eyeError = 0;
+  ViewPoint view = camera.Next();
+  predictor.Observe(view.Pose(), DeltaTime);
+  for (u32 frame = 1; frame < Frames; ++frame) {
+    // Built while the previous frame is recorded, the application skips
+    // it for a camera standing still.
+    stationary += predictor.IsStationary();
+    const CameraPredictor::Prediction prediction =
+        predictor.Predict(DeltaTime);
+    auto desc = MakeQuadDescription(view, MaxDepth);
+    desc.camEye = prediction.pose.eye;
+    desc.camForward = prediction.pose.forward;
+    desc.frustum = prediction.frustum;
+    CollectOceanQuads(predicted, desc, [](const OceanQuad &) {});
+
+    view = camera.Next();
+    predictor.Observe(view.Pose(), DeltaTime);
+    eyeError += length(prediction.pose.eye - view.eye);
+    if (!CameraPredictor::Covers(prediction, view.Pose()))
+      continue;
+    ++hits;
+    falseCulls += FalseCulls(predicted, desc, view.GetFrustum());
+    CollectOceanQuads(actual, MakeQuadDescription(view, MaxDepth),
+                      [](const OceanQuad &) {});
+    predictedLeaves += predicted.GetLeaves().size();
+    actualLeaves += actual.GetLeaves().size();
+  }
+
+  std::printf("Camera prediction over %u frames at 60 fps\n", Frames - 1);
+  std::printf("  %u hits (%.1f%%), mean eye error %.4f, %u false culls on "
+              "hits\n",
+              hits, 100.0 * hits / (Frames - 1), eyeError / (Frames - 1),
+              falseCulls);
+  std::printf("  %.1f leaves per predicted tree against %.1f for the actual "
+              "camera\n",
+              (f64)predictedLeaves / hits, (f64)actualLeaves / hits);
+  std::printf("  %u frames with a stationary camera, no prediction built\n\n",
+              stationary);
+
+  // The build a hit takes off the critical path of the frame.
+  SteeredCamera timed;
+  std::vector<QuadCollectionDescription> descs;
+  for (u32 frame = 0; frame < 64; ++frame)
+    descs.push_back(MakeQuadDescription(timed.Next(), MaxDepth));
+  u32 frame = 0;
+  const auto buildRes = Measure(
+      [&] {
+        CollectOceanQuads(actual, descs[frame++ % descs.size()],
+                          [](const OceanQuad &) {});
+      },
+      200, 10);
+  Print("Quadtree build per frame, depth 9", buildRes);
+  return 0;
+}
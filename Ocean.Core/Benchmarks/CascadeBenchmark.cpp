@@ -0,0 +1,118 @@
+#include "Ocean/Simulation/CpuSimulation.h"
+#include <cstdio>
+#include <string>
+#include "Benchmark.h"
+#include "Scene.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+constexpr f32 DeltaTime = 1.f / 60.f;
+
+LodParameters DefaultLod(f32 patchSize) {
+  return LodParameters{.displacementLambda = {1.f, 0.9f, 1.f},
+                       .patchSize = patchSize,
+                       .foamExponentialDecay = 0.32f,
+                       .foamMinValue = 0.f,
+                       .foamBias = 0.85f,
+                       .foamMult = 7.f};
+}
+
+// Cascade i of the patch size 12 * 4^i, of its own resolution.
+HalfSpectrum CascadeSpectrum(u32 i, u32 N) {
+  auto spectrum = DefaultSpectrum(N);
+  spectrum.patchSize *= (f32)(1u << (2 * i));
+  return CalculateHalfSpectrum(spectrum, &ThreadPool::Global());
+}
+
+std::string Describe(std::span<const u32> sizes) {
+  std::string res;
+  for (u32 N : sizes) {
+    if (!res.empty())
+      res += '/';
+    res += std::to_string(N);
+  }
+  return res;
+}
+
+// A cascade simulated next to others of other sizes has to give what it
+// gives alone.
+void Validate() {
+  const u32 sizes[] = {256, 64, 128};
+  CpuSimulation mixed;
+  std::vector<std::unique_ptr<CpuSimulation>> alone;
+  for (u32 i = 0; i < std::size(sizes); ++i) {
+    const auto spectrum = CascadeSpectrum(i, sizes[i]);
+    const f32 patchSize = 12.f * (f32)(1u << (2 * i));
+    mixed.AddLod(spectrum, DefaultLod(patchSize));
+    alone.push_back(std::make_unique<CpuSimulation>());
+    alone.back()->AddLod(spectrum, DefaultLod(patchSize));
+  }
+
+  u32 differences = 0;
+  for (u32 frame = 1; frame <= 10; ++frame) {
+    const TimeConstants time{.deltaTime = DeltaTime,
+                             .timeSinceLaunch = frame * DeltaTime};
+    mixed.Update(time);
+    for (u32 i = 0; i < std::size(sizes); ++i) {
+      alone[i]->Update(time);
+      const LodFields &a = mixed.GetLod(i), &b = alone[i]->GetLod(0);
+      for (u32 j = 0; j < sizes[i] * sizes[i]; ++j)
+        differences += a.DisplacementAt(j) != b.DisplacementAt(j) ||
+                       a.GradientAt(j) != b.GradientAt(j);
+    }
+  }
+  std::printf("Validation %s, 10 frames: %u elements differ from the "
+              "cascades simulated alone\n\n",
+              Describe(sizes).c_str(), differences);
+}
+} // namespace
+
+int main() {
+  Validate();
+
+  std::printf("Threads: %u\n", ThreadPool::Global().GetConcurrency());
+  const std::vector<std::vector<u32>> configurations = {
+      {512, 512, 512}, {512, 256, 128}, {512, 128, 32},  {1024, 1024, 1024},
+      {1024, 512, 256}, {256, 256, 256}, {512, 256},      {512, 256, 128, 64},
+  };
+  for (const auto &sizes : configurations) {
+    const Result generation = Measure(
+        [&] {
+          for (u32 i = 0; i < sizes.size(); ++i)
+            DoNotOptimize(CascadeSpectrum(i, sizes[i]).frequencies[0]);
+        },
+        3, 1);
+
+    CpuSimulation sim;
+    for (u32 i = 0; i < sizes.size(); ++i)
+      sim.AddLod(CascadeSpectrum(i, sizes[i]),
+                 DefaultLod(12.f * (f32)(1u << (2 * i))));
+    f32 t = 0;
+    CpuSimulation::StageTimes stages;
+    const Result update = Measure(
+        [&] {
+          t += DeltaTime;
+          sim.Update({.deltaTime = DeltaTime, .timeSinceLaunch = t});
+          DoNotOptimize(sim.GetLod(0).gradientW[0]);
+          const auto &last = sim.GetStageTimes();
+          stages.spektrum += last.spektrum;
+          stages.fft += last.fft;
+          stages.postFft += last.postFft;
+        },
+        10, 0);
+
+    const std::string name = Describe(sizes);
+    Print(("spectra " + name).c_str(), generation);
+    Print(("Update " + name).c_str(), update);
+    const auto share = [&](std::chrono::nanoseconds stage) {
+      return std::chrono::duration<f64, std::milli>(stage).count() /
+             update.iterations;
+    };
+    std::printf("  mean spectrum %.3f ms, FFT %.3f ms, post FFT %.3f ms\n",
+                share(stages.spektrum), share(stages.fft),
+                share(stages.postFft));
+  }
+  return 0;
+}
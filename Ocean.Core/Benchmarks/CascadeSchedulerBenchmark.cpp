@@ -0,0 +1,113 @@
+#include "Ocean/Simulation/CascadeScheduler.h"
+#include "Ocean/Simulation/CpuSimulation.h"
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include "Benchmark.h"
+#include "Scene.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+constexpr f32 DeltaTime = 1.f / 60.f;
+constexpr u32 Frames = 240;
+
+// The near cascade every frame, the far ones every 2nd and 4th at least.
+constexpr CascadeScheduler::Cascade Cascades[] = {
+    {.N = 512, .maxInterval = 1},
+    {.N = 256, .maxInterval = 2},
+    {.N = 128, .maxInterval = 4}};
+
+struct Run {
+  Result frame;
+  f64 maxMs = 0;
+  f32 interval[3] = {};
+  // Of the time shown against the one of the frame, over the frames.
+  f64 meanLag = 0;
+  f64 meanLagWithoutOffset = 0;
+  u32 overdue = 0;
+};
+
+// Each cascade is a simulation of its own, so the ones planned are
+// simulated alone and the plan is timed as a whole, as on the GPU.
+Run Simulate(f64 budgetMs) {
+  std::vector<std::unique_ptr<CpuSimulation>> sims;
+  for (u32 i = 0; i < std::size(Cascades); ++i) {
+    auto spectrum = DefaultSpectrum(Cascades[i].N);
+    spectrum.patchSize *= (f32)(1u << (2 * i));
+    sims.push_back(std::make_unique<CpuSimulation>());
+    sims.back()->AddLod(CalculateHalfSpectrum(spectrum),
+                        LodParameters{.patchSize = spectrum.patchSize});
+  }
+  CascadeScheduler scheduler(Cascades);
+
+  Run res;
+  std::vector<f64> times;
+  f32 shown[3] = {}, shownWithoutOffset[3] = {};
+  u32 sinceSimulated[3] = {};
+  for (u32 frame = 1; frame <= Frames; ++frame) {
+    const f32 time = frame * DeltaTime;
+    // The results of the previous frame are shown in this one.
+    for (u32 i = 0; i < 3; ++i) {
+      res.meanLag += std::abs(shown[i] - time);
+      res.meanLagWithoutOffset += std::abs(shownWithoutOffset[i] - time);
+    }
+
+    const auto &plan = scheduler.Schedule(time, DeltaTime, budgetMs);
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (u32 i = 0; i < 3; ++i) {
+      const auto &decision = plan.cascades[i];
+      res.overdue += !decision.simulate &&
+                     ++sinceSimulated[i] >= Cascades[i].maxInterval;
+      if (!decision.simulate)
+        continue;
+      sims[i]->Update({.deltaTime = decision.deltaTime,
+                       .timeSinceLaunch = decision.time});
+      DoNotOptimize(sims[i]->GetLod(0).gradientW[0]);
+      shown[i] = decision.time;
+      shownWithoutOffset[i] = decision.time - decision.timeOffset;
+      sinceSimulated[i] = 0;
+    }
+    const f64 ms = std::chrono::duration<f64, std::milli>(
+                       std::chrono::high_resolution_clock::now() - start)
+                       .count();
+    scheduler.Measured(plan, ms);
+    // The first frames fill the pipeline.
+    if (frame > 2) {
+      times.push_back(ms);
+      res.maxMs = std::max(res.maxMs, ms);
+    }
+  }
+
+  std::ranges::sort(times);
+  res.frame.iterations = (u32)times.size();
+  res.frame.minMs = times.front();
+  res.frame.medianMs = times[times.size() / 2];
+  for (f64 t : times)
+    res.frame.meanMs += t;
+  res.frame.meanMs /= (f64)times.size();
+  for (u32 i = 0; i < 3; ++i)
+    res.interval[i] = scheduler.GetPlan().cascades[i].interval;
+  res.meanLag /= 3.0 * Frames;
+  res.meanLagWithoutOffset /= 3.0 * Frames;
+  return res;
+}
+} // namespace
+
+int main() {
+  std::printf("Threads: %u, cascades 512/256/128 at most every 1/2/4 "
+              "frames\n",
+              ThreadPool::Global().GetConcurrency());
+  for (f64 budget : {0.0, 6.0, 5.0, 4.0, 1.0}) {
+    const Run run = Simulate(budget);
+    char name[64];
+    std::snprintf(name, sizeof(name), "budget %.1f ms", budget);
+    Print(name, run.frame);
+    std::printf("  max %.3f ms, intervals %.2f/%.2f/%.2f frames, %u overdue, "
+                "time shown off by %.2f ms (%.2f ms without offset)\n",
+                run.maxMs, run.interval[0], run.interval[1], run.interval[2],
+                run.overdue, run.meanLag * 1e3, run.meanLagWithoutOffset * 1e3);
+  }
+  return 0;
+}
@@ -0,0 +1,156 @@
+#include "Ocean/Memory/ConstantCache.h"
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <random>
+#include "Benchmark.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+constexpr u32 FramesInFlight = 2;
+
+// Host pages at made up addresses, which can be read back through them.
+class StubAddressSpace {
+public:
+  UploadMemoryFactory Factory() {
+    return [this](u64 size) {
+      base += u64(1) << 32;
+      auto memory = std::make_unique<HostUploadMemory>(size, base);
+      pages[base] = memory->GetData();
+      return memory;
+    };
+  }
+
+  const u8 *Resolve(u64 gpuAddress) const {
+    const auto it = std::prev(pages.upper_bound(gpuAddress));
+    return it->second + (gpuAddress - it->first);
+  }
+
+private:
+  u64 base = u64(1) << 40;
+  std::map<u64, u8 *> pages;
+};
+
+// The constants the app uploads each frame, by size: the camera moves now
+// and then, the time changes every frame, the rest only when a setting is
+// touched.
+class AppConstants {
+public:
+  std::vector<std::vector<u8>> Next() {
+    ++frame;
+    if (frame % 120 < 40)
+      ++camera;
+    if (frame % 600 == 0)
+      ++settings;
+    std::vector<std::vector<u8>> res;
+    res.push_back(Payload(160, camera));
+    res.push_back(Payload(48, settings));
+    res.push_back(Payload(64, settings));
+    res.push_back(Payload(448, settings));
+    res.push_back(Payload(16, frame));
+    // The model matrices of the passes, twice the same for the water.
+    for (u32 pass : {0, 1, 2, 2})
+      res.push_back(Payload(128, 1000 + pass));
+    return res;
+  }
+
+private:
+  static std::vector<u8> Payload(u64 size, u32 value) {
+    std::vector<u8> res(size);
+    for (u64 i = 0; i < size; i += sizeof(value))
+      std::memcpy(res.data() + i, &value, sizeof(value));
+    return res;
+  }
+
+  u32 frame = 0, camera = 0, settings = 0;
+};
+
+struct Written {
+  u64 gpuAddress;
+  std::vector<u8> content;
+};
+
+// The constants of each frame are read back when its fence completes: no
+// later frame may have replaced them, even when they were hits on entries
+// written long before.
+void Validate() {
+  StubAddressSpace addresses;
+  ConstantCache cache(addresses.Factory(), 4096);
+  AppConstants constants;
+  std::vector<std::vector<Written>> inFlight(FramesInFlight);
+  u32 corrupted = 0, checked = 0;
+  constexpr u32 Frames = 5000;
+  for (u32 frame = 0; frame < Frames; ++frame) {
+    std::vector<Written> &written = inFlight[frame % FramesInFlight];
+    for (const Written &w : written) {
+      corrupted += std::memcmp(addresses.Resolve(w.gpuAddress),
+                               w.content.data(), w.content.size()) != 0;
+      ++checked;
+    }
+    written.clear();
+    if (frame >= FramesInFlight)
+      cache.Retire(frame - FramesInFlight + 1);
+
+    for (auto &payload : constants.Next()) {
+      const u64 address = cache.Write(payload);
+      written.push_back({address, std::move(payload)});
+    }
+    cache.EndFrame(frame + 1);
+  }
+  const auto &stats = cache.GetStatistics();
+  std::printf("Validated %u constants over %u frames: %u corrupted\n",
+              checked, Frames, corrupted);
+  std::printf("  %u hits, %u misses (%.1f%% hits), %u reused entries\n",
+              stats.hits, stats.misses,
+              100.0 * stats.hits / (stats.hits + stats.misses), stats.reuses);
+  std::printf("  %u entries in %llu KB, %llu KB not written again\n\n",
+              stats.entries, (unsigned long long)stats.reservedBytes / 1024,
+              (unsigned long long)stats.savedBytes / 1024);
+}
+} // namespace
+
+int main() {
+  Validate();
+
+  AppConstants constants;
+  std::vector<std::vector<std::vector<u8>>> frames;
+  for (u32 i = 0; i < 1200; ++i)
+    frames.push_back(constants.Next());
+
+  StubAddressSpace addresses;
+  UploadRing ring(addresses.Factory());
+  u64 fence = 0;
+  const auto ringRes = Measure(
+      [&] {
+        for (const auto &frame : frames) {
+          for (const auto &payload : frame)
+            DoNotOptimize(ring.Write(payload));
+          ring.EndFrame(++fence);
+          if (fence > FramesInFlight)
+            ring.Retire(fence - FramesInFlight);
+        }
+      },
+      20, 2);
+  Print("UploadRing, every constant written", ringRes);
+
+  ConstantCache cache(addresses.Factory());
+  fence = 0;
+  const auto cacheRes = Measure(
+      [&] {
+        for (const auto &frame : frames) {
+          for (const auto &payload : frame)
+            DoNotOptimize(cache.Write(payload));
+          cache.EndFrame(++fence);
+          if (fence > FramesInFlight)
+            cache.Retire(fence - FramesInFlight);
+        }
+      },
+      20, 2);
+  Print("ConstantCache", cacheRes);
+  std::printf("  %.3f us per frame against %.3f us\n",
+              cacheRes.minMs * 1e3 / frames.size(),
+              ringRes.minMs * 1e3 / frames.size());
+  return 0;
+}
@@ -0,0 +1,189 @@
+#include "Ocean/Simulation/CpuSimulation.h"
+#include <cstdio>
+#include <string>
+#include "Benchmark.h"
+#include "Scene.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+using cd = std::complex<f64>;
+
+// Straight per element transcription of the compute shaders with a naive
+// DFT, in double precision. Returns displacement and gradient as float4s.
+struct Reference {
+  u32 N;
+  std::vector<cd> h0;
+  std::vector<f32> w;
+  LodParameters params;
+  std::vector<f64> foam;
+  std::vector<float4> displacement;
+  std::vector<float4> gradients;
+
+  void InverseDft2D(std::vector<cd> &field) const {
+    std::vector<cd> tmp(field.size());
+    const auto twiddle = [&](u32 n) {
+      const f64 theta = 2 * std::numbers::pi * (f64)n / (f64)N;
+      return cd(std::cos(theta), std::sin(theta));
+    };
+    for (u32 y = 0; y < N; ++y)
+      for (u32 k = 0; k < N; ++k) {
+        cd sum = 0;
+        for (u32 x = 0; x < N; ++x)
+          sum += field[y * N + x] * twiddle((x * k) % N);
+        tmp[y * N + k] = sum;
+      }
+    for (u32 x = 0; x < N; ++x)
+      for (u32 k = 0; k < N; ++k) {
+        cd sum = 0;
+        for (u32 y = 0; y < N; ++y)
+          sum += tmp[y * N + x] * twiddle((y * k) % N);
+        field[k * N + x] = sum;
+      }
+  }
+
+  void Update(const TimeConstants &time) {
+    std::vector<cd> h(N * N), D(N * N);
+    for (u32 y = 0; y < N; ++y)
+      for (u32 x = 0; x < N; ++x) {
+        const cd h0k = h0[y * N + x];
+        const cd h0mk = h0[(N - 1 - y) * N + (N - 1 - x)];
+        const f64 wt = (f64)w[y * N + x] * time.timeSinceLaunch;
+        const cd e(std::cos(wt), std::sin(wt));
+        const cd htk = h0k * e + std::conj(h0mk) * std::conj(e);
+
+        f64 kx = (f64)N / 2 - x, ky = (f64)N / 2 - y;
+        const f64 len = std::sqrt(kx * kx + ky * ky);
+        kx = len > 1e-6 ? kx / len : 0;
+        ky = len > 1e-6 ? ky / len : 0;
+        h[y * N + x] = htk;
+        D[y * N + x] = cd(htk.imag() * kx, -htk.real() * kx) +
+                       cd(htk.real() * ky, htk.imag() * ky);
+      }
+    InverseDft2D(h);
+    InverseDft2D(D);
+
+    std::vector<std::array<f64, 3>> disp(N * N);
+    for (u32 y = 0; y < N; ++y)
+      for (u32 x = 0; x < N; ++x) {
+        const f64 sign = ((x + y) & 1) ? -1.0 : 1.0;
+        const u32 i = y * N + x;
+        disp[i] = {sign * D[i].real() * params.displacementLambda.x,
+                   (sign * h[i].real() + 2) / 5. * params.displacementLambda.y,
+                   sign * D[i].imag() * params.displacementLambda.z};
+        displacement[i] = {(f32)disp[i][0], (f32)disp[i][1], (f32)disp[i][2],
+                           0.f};
+      }
+
+    const f64 tile = params.patchSize / (f64)N;
+    const f64 inv = (f64)N / params.patchSize;
+    const f64 step = time.deltaTime >= 0.0001f ? 1 : 0;
+    for (u32 y = 0; y < N; ++y)
+      for (u32 x = 0; x < N; ++x) {
+        const auto at = [&](u32 px, u32 py) {
+          return disp[(py & (N - 1)) * N + (px & (N - 1))];
+        };
+        const auto l = at(x - 1, y), r = at(x + 1, y);
+        const auto b = at(x, y - 1), t = at(x, y + 1);
+        const f64 dv[3] = {r[0] - l[0] + tile, r[1] - l[1], r[2] - l[2]};
+        const f64 du[3] = {t[0] - b[0], t[1] - b[1], t[2] - b[2] + tile};
+        f64 g[3] = {du[1] * dv[2] - du[2] * dv[1], du[2] * dv[0] - du[0] * dv[2],
+                    du[0] * dv[1] - du[1] * dv[0]};
+        const f64 glen = std::sqrt(g[0] * g[0] + g[1] * g[1] + g[2] * g[2]);
+        const f64 J = (dv[0] * inv) * (du[2] * inv) - (dv[2] * inv) * (du[0] * inv);
+
+        const u32 i = y * N + x;
+        f64 old = foam[i];
+        old -= params.foamExponentialDecay * 60 * time.deltaTime * old;
+        f64 newval = std::max(0.0, -J * params.foamMult + params.foamBias) * step;
+        foam[i] = old + (newval > params.foamMinValue ? newval : 0);
+        gradients[i] = {(f32)(g[0] / glen), (f32)(g[1] / glen),
+                        (f32)(g[2] / glen), (f32)foam[i]};
+      }
+  }
+};
+
+LodParameters DefaultLod(f32 patchSize) {
+  return LodParameters{.displacementLambda = {1.f, 0.9f, 1.f},
+                       .patchSize = patchSize,
+                       .foamExponentialDecay = 0.32f,
+                       .foamMinValue = 0.f,
+                       .foamBias = 0.85f,
+                       .foamMult = 7.f};
+}
+
+void Validate() {
+  // Three LODs, so that two of them share a height transform.
+  const u32 N = 64;
+  CpuSimulation sim;
+  std::vector<Reference> refs;
+  for (f32 patchSize : {5.f, 20.f, 100.f}) {
+    auto spectrum = DefaultSpectrum(N);
+    spectrum.patchSize = patchSize;
+    const auto half = CalculateHalfSpectrum(spectrum);
+    const auto h0 = half.ExpandTildeh0();
+    const auto w = half.ExpandFrequencies();
+    const auto params = DefaultLod(patchSize);
+    sim.AddLod(half, params);
+    refs.push_back({.N = N,
+                    .h0 = std::vector<cd>(h0.begin(), h0.end()),
+                    .w = w,
+                    .params = params,
+                    .foam = std::vector<f64>(N * N),
+                    .displacement = std::vector<float4>(N * N),
+                    .gradients = std::vector<float4>(N * N)});
+  }
+
+  f32 maxDisp = 0, maxGrad = 0, maxFoam = 0;
+  for (u32 frame = 1; frame <= 20; ++frame) {
+    const TimeConstants time{.deltaTime = 1.f / 60.f,
+                             .timeSinceLaunch = (f32)frame * 3.7f};
+    sim.Update(time);
+    for (u32 lod = 0; lod < refs.size(); ++lod) {
+      auto &ref = refs[lod];
+      ref.Update(time);
+      const auto &fields = sim.GetLod(lod);
+      for (u32 i = 0; i < N * N; ++i) {
+        const float4 d = fields.DisplacementAt(i) - ref.displacement[i];
+        const float4 g = fields.GradientAt(i) - ref.gradients[i];
+        maxDisp =
+            std::max({maxDisp, std::abs(d.x), std::abs(d.y), std::abs(d.z)});
+        maxGrad =
+            std::max({maxGrad, std::abs(g.x), std::abs(g.y), std::abs(g.z)});
+        maxFoam = std::max(maxFoam, std::abs(g.w) /
+                                        std::max(1.f, ref.gradients[i].w));
+      }
+    }
+  }
+  std::printf("Validation N=%u, 3 LODs against double precision reference: "
+              "max |d displacement| %.2e, max |d normal| %.2e, max rel d foam "
+              "%.2e\n",
+              N, maxDisp, maxGrad, maxFoam);
+}
+} // namespace
+
+int main() {
+  Validate();
+
+  std::printf("Threads: %u\n", ThreadPool::Global().GetConcurrency());
+  for (u32 N : {256u, 512u, 1024u}) {
+    CpuSimulation sim;
+    for (f32 patchSize : {5.f, 20.f, 100.f}) {
+      auto spectrum = DefaultSpectrum(N);
+      spectrum.patchSize = patchSize;
+      sim.AddLod(CalculateHalfSpectrum(spectrum), DefaultLod(patchSize));
+    }
+
+    f32 t = 0;
+    const auto res = Measure(
+        [&] {
+          t += 1.f / 60.f;
+          sim.Update({.deltaTime = 1.f / 60.f, .timeSinceLaunch = t});
+          DoNotOptimize(sim.GetLod(0).gradientW[0]);
+        },
+        10, 2);
+    Print(("CpuSimulation::Update 3 LODs N=" + std::to_string(N)).c_str(), res);
+  }
+  return 0;
+}
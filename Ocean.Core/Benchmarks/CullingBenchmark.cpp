@@ -0,0 +1,173 @@
+#include "Ocean/Culling/FrustumCuller.h"
+#include <bit>
+#include <cstdio>
+#include <string>
+#include "Benchmark.h"
+#include "Scene.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+// The cells of one level of the ocean quadtree, as the tree tests them.
+struct Grid {
+  u32 side;
+  f32 cellSize;
+  std::vector<f32> centerX, centerY, centerZ, extentX, extentY, extentZ;
+
+  explicit Grid(u32 level) : side(1u << level), cellSize(1000.f / side) {
+    const u32 count = side * side;
+    const u32 padded = (count + FrustumCuller::BlockSize - 1) /
+                       FrustumCuller::BlockSize * FrustumCuller::BlockSize;
+    for (auto *v : {&centerX, &centerY, &centerZ, &extentX, &extentY,
+                    &extentZ})
+      v->assign(padded, 0.f);
+    for (u32 x = 0; x < side; ++x)
+      for (u32 z = 0; z < side; ++z) {
+        const u32 i = x * side + z;
+        centerX[i] = -500.f + (x + .5f) * cellSize;
+        centerZ[i] = -500.f + (z + .5f) * cellSize;
+        extentX[i] = extentZ[i] = cellSize / 2;
+      }
+  }
+
+  u32 Count() const { return side * side; }
+  FrustumCuller::Boxes Boxes(u32 first = 0) const {
+    return {centerX.data() + first, centerY.data() + first,
+            centerZ.data() + first, extentX.data() + first,
+            extentY.data() + first, extentZ.data() + first};
+  }
+};
+
+// Top down over the levels: the children of a visible cell are tested as one
+// block, skipping the planes their parent is entirely in front of.
+struct Hierarchy {
+  std::vector<Grid> levels;
+  u32 planeTests = 0;
+
+  explicit Hierarchy(u32 depth) {
+    for (u32 level = 0; level <= depth; ++level)
+      levels.emplace_back(level);
+  }
+
+  template <typename Fn>
+  void Visit(const FrustumCuller &culler, u32 level, u32 x, u32 z,
+             FrustumCuller::PlaneMask inside, Fn &&visible) {
+    if (level + 1 == (u32)levels.size()) {
+      visible(x, z);
+      return;
+    }
+    const Grid &grid = levels[level + 1];
+    std::array<f32, FrustumCuller::BlockSize> cx{}, cy{}, cz{}, ex{}, ey{},
+        ez{};
+    for (u32 c = 0; c < 4; ++c) {
+      const u32 i = (2 * x + (c >> 1)) * grid.side + 2 * z + (c & 1);
+      cx[c] = grid.centerX[i];
+      cz[c] = grid.centerZ[i];
+      ex[c] = grid.extentX[i];
+      ez[c] = grid.extentZ[i];
+    }
+    std::array<FrustumCuller::Visibility, FrustumCuller::BlockSize> res;
+    culler.Test({cx.data(), cy.data(), cz.data(), ex.data(), ey.data(),
+                 ez.data()},
+                4, inside, res.data());
+    planeTests += 4 * (FrustumCuller::PlaneCount - (u32)std::popcount(inside));
+    for (u32 c = 0; c < 4; ++c)
+      if (res[c].visible)
+        Visit(culler, level + 1, 2 * x + (c >> 1), 2 * z + (c & 1),
+              res[c].inside, visible);
+  }
+};
+} // namespace
+
+int main() {
+  constexpr u32 Level = 6;
+  constexpr u32 Views = 64;
+  const Grid grid(Level);
+  const float4x4 model = OceanModelMatrix();
+  std::vector<Frustum> frustums;
+  for (u32 v = 0; v < Views; ++v)
+    frustums.push_back(FlyingCamera(v * 97).GetFrustum());
+
+  std::vector<u8> reference(grid.Count());
+  u32 visible = 0;
+  const auto virtualRes = Measure(
+      [&] {
+        visible = 0;
+        for (const Frustum &f : frustums)
+          for (u32 i = 0; i < grid.Count(); ++i) {
+            const AABB box{float3{grid.centerX[i], 0, grid.centerZ[i]},
+                           grid.extentX[i], 0, grid.extentZ[i]};
+            reference[i] = box.isOnFrustum(f, model);
+            visible += reference[i];
+          }
+        DoNotOptimize(visible);
+      },
+      20, 2);
+  Print(("AABB::isOnFrustum " + std::to_string(grid.Count()) + " boxes x " +
+         std::to_string(Views))
+            .c_str(),
+        virtualRes);
+
+  std::vector<FrustumCuller::Visibility> out(grid.centerX.size());
+  u32 culledVisible = 0;
+  const auto batchRes = Measure(
+      [&] {
+        culledVisible = 0;
+        for (const Frustum &f : frustums) {
+          const FrustumCuller culler(f, model);
+          culler.Test(grid.Boxes(), grid.Count(), 0, out.data());
+          for (u32 i = 0; i < grid.Count(); ++i)
+            culledVisible += out[i].visible;
+        }
+        DoNotOptimize(culledVisible);
+      },
+      20, 2);
+  Print("FrustumCuller::Test", batchRes);
+  std::printf("  %.2f ns per box, speedup %.2fx\n",
+              batchRes.minMs * 1e6 / (Views * grid.Count()),
+              virtualRes.minMs / batchRes.minMs);
+
+  // Agreement with isOnFrustum, box by box, and of the hierarchical test
+  // with the flat one.
+  Hierarchy hierarchy(Level);
+  u32 flatMismatches = 0, hierarchyMismatches = 0;
+  for (const Frustum &f : frustums) {
+    const FrustumCuller culler(f, model);
+    culler.Test(grid.Boxes(), grid.Count(), 0, out.data());
+    std::vector<u8> found(grid.Count(), 0);
+    if (culler.Test(float3{0, 0, 0}, float3{500, 0, 500}).visible)
+      hierarchy.Visit(culler, 0, 0, 0, 0,
+                      [&](u32 x, u32 z) { found[x * grid.side + z] = 1; });
+    for (u32 i = 0; i < grid.Count(); ++i) {
+      const AABB box{float3{grid.centerX[i], 0, grid.centerZ[i]},
+                     grid.extentX[i], 0, grid.extentZ[i]};
+      flatMismatches += out[i].visible != box.isOnFrustum(f, model);
+      hierarchyMismatches += found[i] != out[i].visible;
+    }
+  }
+  std::printf("  %u of %u boxes visible, %u mismatches against isOnFrustum, "
+              "%u in the hierarchy\n\n",
+              culledVisible, Views * grid.Count(), flatMismatches,
+              hierarchyMismatches);
+
+  hierarchy.planeTests = 0;
+  for (const Frustum &f : frustums)
+    hierarchy.Visit(FrustumCuller(f, model), 0, 0, 0, 0, [](u32, u32) {});
+  const u32 planeTests = hierarchy.planeTests;
+  const auto hierarchyRes = Measure(
+      [&] {
+        u32 count = 0;
+        for (const Frustum &f : frustums) {
+          const FrustumCuller culler(f, model);
+          hierarchy.Visit(culler, 0, 0, 0, 0, [&](u32, u32) { ++count; });
+        }
+        DoNotOptimize(count);
+      },
+      20, 2);
+  Print("Hierarchical with plane masks", hierarchyRes);
+  std::printf("  %.1f plane tests per view, %u for the flat test\n",
+              (f64)planeTests / Views,
+              FrustumCuller::PlaneCount * grid.Count());
+  return 0;
+}
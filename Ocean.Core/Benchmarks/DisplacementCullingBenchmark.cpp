@@ -0,0 +1,198 @@
+#include "Ocean/Simulation/CpuSimulation.h"
+#include <bit>
+#include <cstdio>
+#include <unordered_map>
+#include "Benchmark.h"
+#include "Scene.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+// A rough sea: JONSWAP waves of a few meters over a 100 m patch.
+SpectrumParameters StormSpectrum(u32 N) {
+  return SpectrumParameters{.N = N,
+                            .M = N,
+                            .patchSize = 100.f,
+                            .Amplitude = 1.f,
+                            .WindForce = 15.f,
+                            .windDirection = float2(1.f, 1.f),
+                            .gravity = 9.81f,
+                            .Depth = 100.f,
+                            .spectrum = SpectrumType::Jonswap};
+}
+
+// The displacement map of one frame, tiled over the plane as the domain
+// shader samples it, with the range of the displacement over any cell.
+class DisplacedPlane {
+public:
+  DisplacedPlane(const LodFields &fields, u32 N, f32 patchSize)
+      : fields(fields), N(N), patchSize(patchSize) {
+    all = Range(0, N, 0, N);
+  }
+
+  // The box the displaced cell occupies in model space.
+  AABB GetBox(const Node &cell, f32 height) {
+    const u64 key = (u64)std::bit_cast<u32>(cell.center.x) << 32 |
+                    std::bit_cast<u32>(cell.center.y);
+    auto [it, added] = boxes.try_emplace(key, float3{}, 0.f, 0.f, 0.f);
+    if (added) {
+      const float2 low = cell.center - cell.size / 2;
+      const float2 high = cell.center + cell.size / 2;
+      const DisplacementRange range =
+          Range(Texel(low.x), Texel(high.x) + 1, Texel(low.y),
+                Texel(high.y) + 1);
+      it->second = AABB(float3(low.x, height, low.y) + range.low,
+                        float3(high.x, height, high.y) + range.high);
+    }
+    return it->second;
+  }
+
+  const DisplacementRange &GetRange() const { return all; }
+
+private:
+  i64 Texel(f32 x) const {
+    return (i64)std::floor((x / patchSize + 0.5f) * (f32)N);
+  }
+
+  // Over the texels [x0, x1) x [z0, z1), wrapped.
+  DisplacementRange Range(i64 x0, i64 x1, i64 z0, i64 z1) const {
+    if (x1 - x0 >= N && z1 - z0 >= N && all.low.x <= all.high.x)
+      return all;
+    x1 = std::min(x1, x0 + N);
+    z1 = std::min(z1, z0 + N);
+    DisplacementRange res{{1e30f, 1e30f, 1e30f}, {-1e30f, -1e30f, -1e30f}};
+    for (i64 z = z0; z < z1; ++z)
+      for (i64 x = x0; x < x1; ++x) {
+        const u32 index = (u32)((z & (N - 1)) * N + (x & (N - 1)));
+        const float3 d = {fields.displacementX[index],
+                          fields.displacementY[index],
+                          fields.displacementZ[index]};
+        res.low = {std::min(res.low.x, d.x), std::min(res.low.y, d.y),
+                   std::min(res.low.z, d.z)};
+        res.high = {std::max(res.high.x, d.x), std::max(res.high.y, d.y),
+                    std::max(res.high.z, d.z)};
+      }
+    return res;
+  }
+
+  const LodFields &fields;
+  i64 N;
+  f32 patchSize;
+  DisplacementRange all{{1, 1, 1}, {0, 0, 0}};
+  std::unordered_map<u64, AABB> boxes;
+};
+
+struct Counts {
+  u32 leaves = 0;
+  // Leaves the frustum kept from being split, though their waves are in
+  // view.
+  u32 falseCulls = 0;
+  // Leaves of a split parent whose waves are all out of view.
+  u32 wasted = 0;
+};
+
+// The leaves of one build against the displaced plane of the frame.
+void Count(const QuadTree &qt, const QuadCollectionDescription &desc,
+           DisplacedPlane &plane, Counts &counts) {
+  for (const QuadTree::Leaf &leaf : qt.GetLeaves()) {
+    const Node cell = qt.GetNode(leaf);
+    ++counts.leaves;
+    const float3 diff = {cell.center.x - desc.camEye.x,
+                         desc.center.y - desc.camEye.y,
+                         cell.center.y - desc.camEye.z};
+    const bool near =
+        dot(diff, diff) / (cell.size.x * cell.size.y) < desc.distanceThreshold;
+    if (leaf.level <= desc.maxDepth && near &&
+        plane.GetBox(cell, desc.center.y)
+            .isOnFrustum(desc.frustum, desc.modelMatrix))
+      ++counts.falseCulls;
+
+    if (leaf.level == 0)
+      continue;
+    const Node parent = {
+        cell.center - cell.size / 2 +
+            float2((Morton::DecodeX(leaf.code) >>
+                    (QuadTree::MaxLevel - leaf.level)) % 2 == 0
+                       ? cell.size.x
+                       : 0.f,
+                   (Morton::DecodeZ(leaf.code) >>
+                    (QuadTree::MaxLevel - leaf.level)) % 2 == 0
+                       ? cell.size.y
+                       : 0.f),
+        cell.size * 2};
+    if (!plane.GetBox(parent, desc.center.y)
+             .isOnFrustum(desc.frustum, desc.modelMatrix))
+      ++counts.wasted;
+  }
+}
+} // namespace
+
+int main() {
+  constexpr u32 N = 64;
+  const SpectrumParameters spectrum = StormSpectrum(N);
+  const HalfSpectrum half = CalculateHalfSpectrum(spectrum);
+  const DisplacementBounds bounds = CalculateDisplacementBounds(half);
+  const float3 lambda = {1.f, 1.f, 1.f};
+  const DisplacementRange likely = bounds.GetRange(lambda);
+  const DisplacementRange sure = bounds.GetRange(lambda, true);
+
+  CpuSimulation simulation;
+  simulation.AddLod(half, {.displacementLambda = lambda,
+                           .patchSize = spectrum.patchSize});
+
+  struct Mode {
+    const char *name;
+    DisplacementRange range;
+    Counts counts;
+  };
+  std::array<Mode, 3> modes = {{{"flat boxes", {}, {}},
+                                {"likely displacement", likely, {}},
+                                {"sure displacement", sure, {}}}};
+
+  constexpr u32 Frames = 48;
+  u32 exceeded = 0;
+  DisplacementRange observed{{1e30f, 1e30f, 1e30f},
+                             {-1e30f, -1e30f, -1e30f}};
+  QuadTree qt;
+  for (u32 frame = 0; frame < Frames; ++frame) {
+    simulation.Update({.deltaTime = 0.5f, .timeSinceLaunch = frame * 0.5f});
+    DisplacedPlane plane(simulation.GetLod(0), N, spectrum.patchSize);
+    const DisplacementRange &range = plane.GetRange();
+    observed.low = {std::min(observed.low.x, range.low.x),
+                    std::min(observed.low.y, range.low.y),
+                    std::min(observed.low.z, range.low.z)};
+    observed.high = {std::max(observed.high.x, range.high.x),
+                     std::max(observed.high.y, range.high.y),
+                     std::max(observed.high.z, range.high.z)};
+    exceeded += range.low.x < likely.low.x || range.low.y < likely.low.y ||
+                range.low.z < likely.low.z || range.high.x > likely.high.x ||
+                range.high.y > likely.high.y || range.high.z > likely.high.z;
+
+    // Low over the water, where the waves reach into the bottom of the view.
+    for (f32 height : {2.f, 6.f}) {
+      auto desc = MakeQuadDescription(FlyingCamera(frame * 13, height), 7);
+      for (Mode &mode : modes) {
+        desc.displacementLow = mode.range.low;
+        desc.displacementHigh = mode.range.high;
+        CollectOceanQuads(qt, desc, [](const OceanQuad &) {});
+        Count(qt, desc, plane, mode.counts);
+      }
+    }
+  }
+
+  std::printf("Displacement bounds: peak %.2f, likely %.2f, deviation %.2f\n",
+              bounds.peak, bounds.likelyPeak, bounds.deviation);
+  std::printf("  likely range x [%.2f, %.2f] y [%.2f, %.2f] z [%.2f, %.2f]\n",
+              likely.low.x, likely.high.x, likely.low.y, likely.high.y,
+              likely.low.z, likely.high.z);
+  std::printf("  observed     x [%.2f, %.2f] y [%.2f, %.2f] z [%.2f, %.2f], "
+              "likely range exceeded in %u of %u frames\n\n",
+              observed.low.x, observed.high.x, observed.low.y, observed.high.y,
+              observed.low.z, observed.high.z, exceeded, Frames);
+  for (const Mode &mode : modes)
+    std::printf("%-24s leaves %6u  false culls %5u  wasted %5u\n", mode.name,
+                mode.counts.leaves, mode.counts.falseCulls,
+                mode.counts.wasted);
+  return 0;
+}
@@ -0,0 +1,270 @@
+#include "Ocean/Fft/Fft.h"
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <numbers>
+#include <random>
+#include <string>
+#include "Benchmark.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+using c32 = std::complex<f32>;
+
+// Textbook iterative radix-2 transform: bit reversal permutation, then log2(N)
+// butterfly passes with a precomputed twiddle table. Rows first, then the
+// columns through a transposed copy, the way FFT.hlsl runs its two passes.
+struct NaiveFft2D {
+  u32 N;
+  u32 log2N = 0;
+  std::vector<c32> twiddles;
+  std::vector<c32> tmp;
+
+  explicit NaiveFft2D(u32 N) : N(N), tmp((size_t)N * N) {
+    while ((1u << log2N) < N)
+      ++log2N;
+    for (u32 k = 0; k < N / 2; ++k) {
+      const f64 theta = 2 * std::numbers::pi * k / N;
+      twiddles.emplace_back((f32)std::cos(theta), (f32)std::sin(theta));
+    }
+  }
+
+  void Inverse1D(c32 *x) const {
+    for (u32 i = 0; i < N; ++i) {
+      u32 rev = 0;
+      for (u32 b = 0; b < log2N; ++b)
+        rev |= ((i >> b) & 1) << (log2N - 1 - b);
+      if (i < rev)
+        std::swap(x[i], x[rev]);
+    }
+    for (u32 half = 1; half < N; half *= 2) {
+      const u32 step = N / (2 * half);
+      for (u32 i = 0; i < N; i += 2 * half)
+        for (u32 j = 0; j < half; ++j) {
+          const c32 t = twiddles[j * step] * x[i + j + half];
+          x[i + j + half] = x[i + j] - t;
+          x[i + j] += t;
+        }
+    }
+  }
+
+  void Inverse(std::vector<c32> &data) {
+    for (u32 pass = 0; pass < 2; ++pass) {
+      for (u32 y = 0; y < N; ++y)
+        Inverse1D(data.data() + (size_t)y * N);
+      for (u32 y = 0; y < N; ++y)
+        for (u32 x = 0; x < N; ++x)
+          tmp[(size_t)x * N + y] = data[(size_t)y * N + x];
+      std::swap(data, tmp);
+    }
+  }
+};
+
+void BenchmarkSizes() {
+  std::mt19937 rng(7);
+  std::normal_distribution<f32> normal;
+
+  std::printf("Single thread, one N x N complex 2D inverse transform\n");
+  for (u32 N : {64u, 256u, 512u, 1024u, 2048u, 4096u}) {
+    const size_t count = (size_t)N * N;
+    std::vector<c32> input(count);
+    for (auto &v : input)
+      v = {normal(rng), normal(rng)};
+
+    NaiveFft2D naive(N);
+    std::vector<c32> reference = input;
+    naive.Inverse(reference);
+
+    Fft2D fft(N);
+    AlignedVector<f32> re(count), im(count);
+    for (size_t i = 0; i < count; ++i) {
+      re[i] = input[i].real();
+      im[i] = input[i].imag();
+    }
+    fft.Inverse(re.data(), im.data());
+
+    f64 maxError = 0, maxValue = 0;
+    for (size_t i = 0; i < count; ++i) {
+      const c32 value(re[i], im[i]);
+      maxError = std::max(maxError, (f64)std::abs(value - reference[i]));
+      maxValue = std::max(maxValue, (f64)std::abs(reference[i]));
+    }
+
+    const u32 naiveIterations = N >= 2048 ? 2 : 5;
+    const auto naiveRes = Measure(
+        [&] {
+          naive.Inverse(reference);
+          DoNotOptimize(reference[0]);
+        },
+        naiveIterations, 1);
+    const auto res = Measure(
+        [&] {
+          fft.Inverse(re.data(), im.data());
+          DoNotOptimize(re[0]);
+        },
+        N >= 2048 ? 10 : 30, 2);
+
+    const std::string size = std::to_string(N);
+    Print(("Naive radix-2 N=" + size).c_str(), naiveRes);
+    Print(("Fft2D N=" + size).c_str(), res);
+    const f64 flops = Fft2D::FlopCount(N);
+    std::printf("  %.2f GFLOP/s (naive %.2f), speedup %.1fx, max rel error "
+                "%.2e\n",
+                flops / (res.minMs * 1e6), flops / (naiveRes.minMs * 1e6),
+                naiveRes.minMs / res.minMs, maxError / maxValue);
+  }
+}
+
+// Random spectrum with X(-k) = X(k)*, its inverse transform is real.
+void RandomHermitian(f32 *re, f32 *im, u32 N, std::mt19937 &rng) {
+  std::normal_distribution<f32> normal;
+  std::vector<c32> x((size_t)N * N);
+  for (auto &v : x)
+    v = {normal(rng), normal(rng)};
+  for (u32 y = 0; y < N; ++y)
+    for (u32 i = 0; i < N; ++i) {
+      const c32 mirrored = x[(size_t)((N - y) % N) * N + (N - i) % N];
+      const c32 h = (x[(size_t)y * N + i] + std::conj(mirrored)) * 0.5f;
+      re[(size_t)y * N + i] = h.real();
+      im[(size_t)y * N + i] = h.imag();
+    }
+}
+
+// K fields with real results (like the heights and displacements of the
+// simulation), transformed one by one and two at a time with the real
+// output trick.
+void BenchmarkRealPairs() {
+  std::mt19937 rng(11);
+  std::printf("\nSingle thread, K N x N fields with real results\n");
+  for (u32 N : {256u, 512u, 1024u}) {
+    const size_t count = (size_t)N * N;
+    const Fft2D fft(N);
+    for (u32 K : {2u, 4u, 6u}) {
+      std::vector<AlignedVector<f32>> spectraRe(K), spectraIm(K);
+      for (u32 f = 0; f < K; ++f) {
+        spectraRe[f].resize(count);
+        spectraIm[f].resize(count);
+        RandomHermitian(spectraRe[f].data(), spectraIm[f].data(), N, rng);
+      }
+
+      // One complex field per spectrum.
+      std::vector<AlignedVector<f32>> re = spectraRe, im = spectraIm;
+
+      // Spectra a and b packed as a + i b.
+      std::vector<AlignedVector<f32>> pairRe(K / 2), pairIm(K / 2);
+      for (u32 p = 0; p < K / 2; ++p) {
+        pairRe[p].resize(count);
+        pairIm[p].resize(count);
+        for (size_t i = 0; i < count; ++i) {
+          pairRe[p][i] = spectraRe[2 * p][i] - spectraIm[2 * p + 1][i];
+          pairIm[p][i] = spectraIm[2 * p][i] + spectraRe[2 * p + 1][i];
+        }
+      }
+
+      for (u32 f = 0; f < K; ++f)
+        fft.Inverse(re[f].data(), im[f].data());
+      for (u32 p = 0; p < K / 2; ++p)
+        fft.Inverse(pairRe[p].data(), pairIm[p].data());
+      f64 maxError = 0, maxValue = 0;
+      for (u32 f = 0; f < K; ++f)
+        for (size_t i = 0; i < count; ++i) {
+          const f32 expected = re[f][i];
+          const f32 packed = f % 2 == 0 ? pairRe[f / 2][i] : pairIm[f / 2][i];
+          maxError = std::max(maxError, (f64)std::abs(packed - expected));
+          maxValue = std::max(maxValue, (f64)std::abs(expected));
+        }
+
+      const u32 iterations = N >= 1024 ? 5 : 20;
+      const auto separate = Measure(
+          [&] {
+            for (u32 f = 0; f < K; ++f)
+              fft.Inverse(re[f].data(), im[f].data());
+            DoNotOptimize(re[0][0]);
+          },
+          iterations, 1);
+      const auto realPairs = Measure(
+          [&] {
+            for (u32 p = 0; p < K / 2; ++p)
+              fft.Inverse(pairRe[p].data(), pairIm[p].data());
+            DoNotOptimize(pairRe[0][0]);
+          },
+          iterations, 1);
+
+      const std::string name =
+          " N=" + std::to_string(N) + " K=" + std::to_string(K);
+      Print(("Separate transforms" + name).c_str(), separate);
+      Print(("Real pairs" + name).c_str(), realPairs);
+      std::printf("  real pairs speedup %.2fx over separate, max rel error "
+                  "%.2e\n",
+                  separate.minMs / realPairs.minMs, maxError / maxValue);
+    }
+  }
+}
+
+// Real field from a Hermitian spectrum: complex transform of the whole
+// spectrum against the real transform of the half spectrum.
+void BenchmarkReal() {
+  std::mt19937 rng(13);
+  std::printf("\nSingle thread, one N x N field with real result\n");
+  for (u32 N : {256u, 512u, 1024u, 2048u}) {
+    const size_t count = (size_t)N * N;
+    AlignedVector<f32> spectrumRe(count), spectrumIm(count);
+    RandomHermitian(spectrumRe.data(), spectrumIm.data(), N, rng);
+
+    const RealFft2D real(N);
+    const u32 pitch = real.GetHalfPitch();
+    AlignedVector<f32> halfRe((size_t)N * pitch), halfIm((size_t)N * pitch);
+    const auto copyHalf = [&] {
+      for (u32 y = 0; y < N; ++y)
+        for (u32 x = 0; x < pitch; ++x) {
+          halfRe[(size_t)y * pitch + x] = spectrumRe[(size_t)y * N + x];
+          halfIm[(size_t)y * pitch + x] = spectrumIm[(size_t)y * N + x];
+        }
+    };
+    AlignedVector<f32> out(count);
+    const RealFft2D::Field field{halfRe.data(), halfIm.data(), out.data()};
+
+    const Fft2D complex(N);
+    AlignedVector<f32> re = spectrumRe, im = spectrumIm;
+    complex.Inverse(re.data(), im.data());
+    copyHalf();
+    real.Inverse({&field, 1});
+
+    f64 maxError = 0, maxValue = 0;
+    for (size_t i = 0; i < count; ++i) {
+      maxError = std::max(maxError, (f64)std::abs(out[i] - re[i]));
+      maxValue = std::max(maxValue, (f64)std::abs(re[i]));
+    }
+
+    // The transforms are in place, the input does not matter for the timing.
+    const u32 iterations = N >= 1024 ? 10 : 30;
+    const auto complexRes = Measure(
+        [&] {
+          complex.Inverse(re.data(), im.data());
+          DoNotOptimize(re[0]);
+        },
+        iterations, 1);
+    const auto realRes = Measure(
+        [&] {
+          real.Inverse({&field, 1});
+          DoNotOptimize(out[0]);
+        },
+        iterations, 1);
+
+    const std::string size = std::to_string(N);
+    Print(("Fft2D N=" + size).c_str(), complexRes);
+    Print(("RealFft2D N=" + size).c_str(), realRes);
+    std::printf("  speedup %.2fx, max rel error %.2e\n",
+                complexRes.minMs / realRes.minMs, maxError / maxValue);
+  }
+}
+} // namespace
+
+int main() {
+  BenchmarkSizes();
+  BenchmarkRealPairs();
+  BenchmarkReal();
+  return 0;
+}
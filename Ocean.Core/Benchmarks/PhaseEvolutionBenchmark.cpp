@@ -0,0 +1,147 @@
+#include "Ocean/Simulation/CpuSimulation.h"
+#include "Ocean/Simulation/PhaseEvolution.h"
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include "Benchmark.h"
+#include "Scene.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+constexpr f32 DeltaTime = 1.f / 60.f;
+
+struct Error {
+  // |e - e^(iwT)|, about the phase error in radians.
+  f64 maxPhase = 0;
+  f64 rmsPhase = 0;
+  f64 maxMagnitude = 0;
+};
+
+// Of the phasors against e^(iwT) in double precision.
+Error MeasureError(std::span<const f32> w, const f32 *c, const f32 *s, f64 T) {
+  Error res;
+  for (size_t i = 0; i < w.size(); ++i) {
+    const f64 wt = (f64)w[i] * T;
+    const f64 dc = c[i] - std::cos(wt), ds = s[i] - std::sin(wt);
+    const f64 phase = std::sqrt(dc * dc + ds * ds);
+    res.maxPhase = std::max(res.maxPhase, phase);
+    res.rmsPhase += phase * phase;
+    res.maxMagnitude = std::max(
+        res.maxMagnitude,
+        std::abs(std::sqrt((f64)c[i] * c[i] + (f64)s[i] * s[i]) - 1));
+  }
+  res.rmsPhase = std::sqrt(res.rmsPhase / (f64)w.size());
+  return res;
+}
+
+// An hour of fixed steps, checked against the exact phase of the summed
+// deltaTimes. Direct evaluates sin and cos of w t from t in f32, as
+// Spektrums.hlsl and TimeEvolution::Direct do.
+void Drift() {
+  const u32 N = 128;
+  const auto w = CalculateFrequencies(DefaultSpectrum(N));
+  PhaseEvolution phases(w);
+
+  std::vector<f32> directC(w.size()), directS(w.size());
+  f32 t = 0;
+  u32 step = 0;
+  std::printf("Drift, N=%u, dt 1/60 s, max |w| %.1f rad/s\n", N,
+              *std::ranges::max_element(w));
+  for (u32 minutes : {1u, 10u, 60u}) {
+    // The step before a sync, where the drift is the largest.
+    for (; step < minutes * 3600u - 1; ++step) {
+      t += DeltaTime;
+      phases.Begin(t, DeltaTime);
+      phases.Apply(0, phases.GetCount());
+    }
+
+    const f64 T = phases.GetTime();
+    for (size_t i = 0; i < w.size(); ++i) {
+      const f32 wt = w[i] * (f32)T;
+      directC[i] = std::cos(wt);
+      directS[i] = std::sin(wt);
+    }
+    const Error incremental =
+        MeasureError(w, phases.GetCos(), phases.GetSin(), T);
+    const Error direct = MeasureError(w, directC.data(), directS.data(), T);
+    std::printf("  %2u min: incremental max %.2e rms %.2e |e|-1 %.1e, "
+                "direct f32 max %.2e rms %.2e\n",
+                minutes, incremental.maxPhase, incremental.rmsPhase,
+                incremental.maxMagnitude, direct.maxPhase, direct.rmsPhase);
+  }
+  const auto &stats = phases.GetStatistics();
+  std::printf("  %u steps, %u rotation updates, %u resyncs, %u syncs, f32 "
+              "time off the summed steps by %.3f s\n\n",
+              stats.steps, stats.rotationUpdates, stats.resyncs, stats.syncs,
+              (f64)t - phases.GetTime());
+}
+
+// A resync, sin and cos of every element from the phase reduced in f64,
+// against a rotation.
+void Speed() {
+  for (u32 N : {256u, 512u}) {
+    const auto w = CalculateHalfSpectrum(DefaultSpectrum(N)).frequencies;
+    PhaseEvolution phases(w);
+    f32 t = 0;
+    // Every step jumps, so the phasors are resynchronized.
+    const auto resync = Measure(
+        [&] {
+          t += 1.f;
+          phases.Begin(t, DeltaTime);
+          phases.Apply(0, phases.GetCount());
+          DoNotOptimize(phases.GetCos()[1]);
+        },
+        50, 5);
+    const auto rotation = Measure(
+        [&] {
+          t += DeltaTime;
+          phases.Begin(t, DeltaTime);
+          phases.Apply(0, phases.GetCount());
+          DoNotOptimize(phases.GetCos()[1]);
+        },
+        50, 5);
+    const std::string size = " N=" + std::to_string(N) + " half spectrum";
+    Print(("resync" + size).c_str(), resync);
+    Print(("rotation" + size).c_str(), rotation);
+  }
+  std::printf("\n");
+}
+
+void Simulation() {
+  for (u32 N : {256u, 512u}) {
+    for (auto evolution : {TimeEvolution::Direct, TimeEvolution::Incremental}) {
+      CpuSimulation sim;
+      sim.SetTimeEvolution(evolution);
+      for (f32 patchSize : {5.f, 20.f, 100.f}) {
+        auto spectrum = DefaultSpectrum(N);
+        spectrum.patchSize = patchSize;
+        sim.AddLod(CalculateHalfSpectrum(spectrum),
+                   LodParameters{.patchSize = patchSize});
+      }
+
+      f32 t = 0;
+      const auto res = Measure(
+          [&] {
+            t += DeltaTime;
+            sim.Update({.deltaTime = DeltaTime, .timeSinceLaunch = t});
+            DoNotOptimize(sim.GetLod(0).gradientW[0]);
+          },
+          20, 3);
+      const std::string name =
+          std::string("CpuSimulation::Update ") +
+          (evolution == TimeEvolution::Direct ? "direct" : "incremental") +
+          " N=" + std::to_string(N);
+      Print(name.c_str(), res);
+    }
+  }
+}
+} // namespace
+
+int main() {
+  Drift();
+  Speed();
+  Simulation();
+  return 0;
+}
@@ -0,0 +1,116 @@
+#include "Ocean/Simulation/CpuSimulation.h"
+#include <cstdio>
+#include <string>
+#include "Benchmark.h"
+#include "Scene.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+constexpr f32 DeltaTime = 1.f / 60.f;
+
+// Planes of N*N f32 each pass reads and writes, the neighbour rows of the
+// gradient come from the cache.
+//   Staged: displacement 3 + 3, gradient 3 + 4, foam 2 + 2
+//   Fused:  3 + 3, 4, 1 + 2, the Jacobian and the rows around stay cached
+constexpr u32 StagedPlanes = 17;
+constexpr u32 FusedPlanes = 13;
+
+LodParameters DefaultLod(f32 patchSize) {
+  return LodParameters{.displacementLambda = {1.f, 0.9f, 1.f},
+                       .patchSize = patchSize,
+                       .foamExponentialDecay = 0.32f,
+                       .foamMinValue = 0.f,
+                       .foamBias = 0.85f,
+                       .foamMult = 7.f};
+}
+
+void AddLods(CpuSimulation &sim, u32 N, u32 count) {
+  for (u32 i = 0; i < count; ++i) {
+    const f32 patchSize = 5.f * (f32)(1u << (2 * i));
+    auto spectrum = DefaultSpectrum(N);
+    spectrum.patchSize = patchSize;
+    sim.AddLod(CalculateHalfSpectrum(spectrum), DefaultLod(patchSize));
+  }
+}
+
+// Both run on the same input, the results must be identical.
+void Validate() {
+  const u32 N = 256;
+  CpuSimulation staged, fused;
+  staged.SetPostFft(PostFft::Staged);
+  fused.SetPostFft(PostFft::Fused);
+  AddLods(staged, N, 3);
+  AddLods(fused, N, 3);
+
+  u32 differences = 0;
+  for (u32 frame = 1; frame <= 10; ++frame) {
+    const TimeConstants time{.deltaTime = DeltaTime,
+                             .timeSinceLaunch = frame * DeltaTime};
+    staged.Update(time);
+    fused.Update(time);
+    for (u32 lod = 0; lod < 3; ++lod) {
+      const LodFields &a = staged.GetLod(lod), &b = fused.GetLod(lod);
+      for (u32 i = 0; i < N * N; ++i)
+        differences += a.DisplacementAt(i) != b.DisplacementAt(i) ||
+                       a.GradientAt(i) != b.GradientAt(i) ||
+                       a.jacobian[i] != b.jacobian[i] || a.foam[i] != b.foam[i];
+    }
+  }
+  std::printf("Validation N=%u, 3 LODs, 10 frames: %u elements differ "
+              "between staged and fused\n\n",
+              N, differences);
+}
+
+// Of the passes after the FFTs only.
+Result MeasurePostFft(CpuSimulation &sim, f32 &t, u32 iterations) {
+  std::vector<f64> times;
+  for (u32 i = 0; i < iterations + 1; ++i) {
+    t += DeltaTime;
+    sim.Update({.deltaTime = DeltaTime, .timeSinceLaunch = t});
+    DoNotOptimize(sim.GetLod(0).gradientW[0]);
+    // The first one warms up
+    if (i > 0)
+      times.push_back(std::chrono::duration<f64, std::milli>(
+                          sim.GetStageTimes().postFft)
+                          .count());
+  }
+  std::ranges::sort(times);
+
+  Result res;
+  res.iterations = iterations;
+  res.minMs = times.front();
+  res.medianMs = times[times.size() / 2];
+  for (f64 time : times)
+    res.meanMs += time;
+  res.meanMs /= (f64)times.size();
+  return res;
+}
+} // namespace
+
+int main() {
+  Validate();
+
+  std::printf("Threads: %u\n", ThreadPool::Global().GetConcurrency());
+  for (u32 N : {512u, 1024u, 2048u}) {
+    CpuSimulation sim;
+    AddLods(sim, N, 1);
+    const f64 planeBytes = (f64)N * N * sizeof(f32);
+    f32 t = 0;
+    for (auto mode : {PostFft::Staged, PostFft::Fused}) {
+      sim.SetPostFft(mode);
+      const Result res = MeasurePostFft(sim, t, N >= 2048 ? 5 : 10);
+      const bool fused = mode == PostFft::Fused;
+      const f64 bytes = (fused ? FusedPlanes : StagedPlanes) * planeBytes;
+      Print(((fused ? "post FFT fused N=" : "post FFT staged N=") +
+             std::to_string(N))
+                .c_str(),
+            res);
+      std::printf("  %u planes, %.1f MB, %.2f GB/s\n",
+                  fused ? FusedPlanes : StagedPlanes, bytes / 1e6,
+                  bytes / res.minMs / 1e6);
+    }
+  }
+  return 0;
+}
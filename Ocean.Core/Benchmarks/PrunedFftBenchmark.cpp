@@ -0,0 +1,160 @@
+#include "Ocean/Simulation/CpuSimulation.h"
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include "Benchmark.h"
+#include "Scene.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+constexpr f32 DeltaTime = 1.f / 60.f;
+constexpr u32 N = 512;
+
+struct Cascade {
+  const char *name;
+  f32 patchSize;
+  f32 amplitude;
+  f32 windForce;
+};
+
+// The cascades of the Large and Weak presets of SimulationData.
+constexpr Cascade Cascades[] = {
+    {"Large highest", 12.f, 0.005f, 9.f},
+    {"Large medium", 91.f, 0.00003f, 9.f},
+    {"Large lowest", 383.f, 0.000002f, 15.f},
+    {"Weak highest", 13.f, 0.4e-3f, 3.f},
+    {"Weak medium", 91.f, 0.15e-3f, 3.f},
+    {"Weak lowest", 383.f, 0.1e-4f, 6.f},
+};
+
+HalfSpectrum Spectrum(const Cascade &cascade) {
+  auto spectrum = DefaultSpectrum(N);
+  spectrum.patchSize = cascade.patchSize;
+  spectrum.Amplitude = cascade.amplitude;
+  spectrum.WindForce = cascade.windForce;
+  return CalculateHalfSpectrum(spectrum);
+}
+
+// Of the FFT stage, the first pass included, over the updates.
+Result MeasureFft(CpuSimulation &sim, f32 &t, u32 iterations) {
+  std::vector<f64> times;
+  for (u32 i = 0; i < iterations + 1; ++i) {
+    t += DeltaTime;
+    sim.Update({.deltaTime = DeltaTime, .timeSinceLaunch = t});
+    DoNotOptimize(sim.GetLod(0).gradientW[0]);
+    if (i > 0)
+      times.push_back(
+          std::chrono::duration<f64, std::milli>(sim.GetStageTimes().fft)
+              .count());
+  }
+  std::ranges::sort(times);
+
+  Result res;
+  res.iterations = iterations;
+  res.minMs = times.front();
+  res.medianMs = times[times.size() / 2];
+  for (f64 time : times)
+    res.meanMs += time;
+  res.meanMs /= (f64)times.size();
+  return res;
+}
+
+// RMS of the difference of the displacements over the one of the full
+// transform, of the heights (centered) and of the horizontal ones.
+std::pair<f64, f64> RmsError(const LodFields &full, const LodFields &pruned) {
+  f64 height = 0, heightError = 0, horizontal = 0, horizontalError = 0;
+  f64 mean = 0;
+  for (u32 i = 0; i < N * N; ++i)
+    mean += full.displacementY[i];
+  mean /= (f64)N * N;
+  for (u32 i = 0; i < N * N; ++i) {
+    const f64 h = full.displacementY[i] - mean;
+    const f64 dh = (f64)pruned.displacementY[i] - full.displacementY[i];
+    const f64 dx = (f64)pruned.displacementX[i] - full.displacementX[i];
+    const f64 dz = (f64)pruned.displacementZ[i] - full.displacementZ[i];
+    height += h * h;
+    heightError += dh * dh;
+    horizontal += (f64)full.displacementX[i] * full.displacementX[i] +
+                  (f64)full.displacementZ[i] * full.displacementZ[i];
+    horizontalError += dx * dx + dz * dz;
+  }
+  return {std::sqrt(heightError / height),
+          std::sqrt(horizontalError / horizontal)};
+}
+// With TimeEvolution::Incremental the phasors of the elements left out are
+// not advanced. Pruning less must bring them back at the right phase, the
+// same result as Direct.
+void ValidateUnpruning() {
+  const auto spectrum = Spectrum(Cascades[0]);
+  CpuSimulation incremental, direct;
+  incremental.SetTimeEvolution(TimeEvolution::Incremental);
+  incremental.SetFftPruning(1e-4);
+  for (CpuSimulation *sim : {&incremental, &direct})
+    sim->AddLod(spectrum, LodParameters{.patchSize = Cascades[0].patchSize});
+
+  f32 t = 0;
+  for (u32 frame = 0; frame < 100; ++frame) {
+    t += DeltaTime;
+    incremental.Update({.deltaTime = DeltaTime, .timeSinceLaunch = t});
+  }
+  incremental.SetFftPruning(0);
+  for (u32 frame = 0; frame < 10; ++frame) {
+    t += DeltaTime;
+    incremental.Update({.deltaTime = DeltaTime, .timeSinceLaunch = t});
+  }
+  direct.Update({.deltaTime = DeltaTime, .timeSinceLaunch = t});
+
+  const auto [heightError, horizontalError] =
+      RmsError(direct.GetLod(0), incremental.GetLod(0));
+  std::printf("Validation, incremental pruned for 100 steps then unpruned "
+              "for 10 against direct: RMS error height %.2e, horizontal "
+              "%.2e\n\n",
+              heightError, horizontalError);
+}
+} // namespace
+
+int main() {
+  ValidateUnpruning();
+
+  std::printf("Threads: %u, N=%u\n", ThreadPool::Global().GetConcurrency(),
+              N);
+  for (const Cascade &cascade : Cascades) {
+    const auto spectrum = Spectrum(cascade);
+    CpuSimulation full;
+    full.AddLod(spectrum, LodParameters{.patchSize = cascade.patchSize});
+    f32 t = 0;
+    const Result reference = MeasureFft(full, t, 10);
+    Print((std::string(cascade.name) + " full FFT").c_str(), reference);
+
+    for (f64 pruning : {1e-6, 1e-4}) {
+      CpuSimulation pruned;
+      pruned.SetFftPruning(pruning);
+      pruned.AddLod(spectrum, LodParameters{.patchSize = cascade.patchSize});
+      f32 tp = 0;
+      const Result res = MeasureFft(pruned, tp, 10);
+
+      // Both at the same time.
+      const TimeConstants time{.deltaTime = DeltaTime, .timeSinceLaunch = t};
+      full.Update(time);
+      pruned.Update(time);
+      const auto [heightError, horizontalError] =
+          RmsError(full.GetLod(0), pruned.GetLod(0));
+
+      const auto &band = pruned.GetBand(0);
+      const u32 halfPitch = N / 2 + 1;
+      char name[96];
+      std::snprintf(name, sizeof(name), "%s pruned %.0e", cascade.name,
+                    pruning);
+      Print(name, res);
+      std::printf("  %.1f%% of the first pass and %.1f%% of the spectrum rows "
+                  "left out, %.2fx, RMS error height %.2e, horizontal %.2e\n",
+                  100.0 * band.firstColumn / halfPitch,
+                  100.0 * (N - (band.endRow - band.firstRow)) / N,
+                  reference.medianMs / res.medianMs, heightError,
+                  horizontalError);
+    }
+  }
+  return 0;
+}
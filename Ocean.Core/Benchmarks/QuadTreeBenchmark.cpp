@@ -0,0 +1,564 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "Benchmark.h"
+#include "Scene.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+// The pointer based tree the linear one replaced: preallocated nodes with
+// child and parent indices, cleared on every build, leaves visited by a
+// depth first iterator keeping its path, neighbours found by walking up to
+// a common ancestor and back down.
+class PointerQuadTree {
+public:
+  struct PointerNode {
+    NodeCenter center = {0, 0};
+    NodeSize size = {0, 0};
+    std::array<u32, 4> children = {0, 0, 0, 0};
+    u32 parent = 0;
+    bool HasChildren() const { return children[0] != 0; }
+  };
+
+  explicit PointerQuadTree(u32 allocation = 20000) : nodes(allocation) {}
+
+  void Build(const QuadCollectionDescription &desc) {
+    std::fill(nodes.begin(), nodes.end(), PointerNode{});
+    nodes[0] = {{desc.center.x, desc.center.z}, desc.fullSizeXZ};
+    count = 1;
+    const TravelOrder order(desc.camForward, desc.modelMatrix);
+    start = order.children[0];
+    for (u32 i = 0; i < 3; ++i)
+      next[order.children[i]] = (i32)order.children[i + 1];
+    next[order.children[3]] = -1;
+    BuildRecursively(0, 0, desc);
+  }
+
+  u32 GetSize() const { return count; }
+
+  // Leaves in travel order with their neighbour ratios.
+  template <typename Fn> void ForEachLeaf(Fn &&fn) const {
+    std::vector<i32> path = {-1};
+    u32 node = 0;
+    const auto descend = [&] {
+      while (nodes[node].HasChildren()) {
+        node = nodes[node].children[start];
+        path.push_back((i32)start);
+      }
+    };
+    descend();
+    while (true) {
+      fn(nodes[node], GetSmallerNeighbor(node, path));
+      while (path.back() != -1 && next[path.back()] == -1) {
+        path.pop_back();
+        node = nodes[node].parent;
+      }
+      if (path.back() == -1)
+        return;
+      const i32 dir = next[path.back()];
+      node = nodes[nodes[node].parent].children[dir];
+      path.back() = dir;
+      descend();
+    }
+  }
+
+private:
+  using Direction = std::array<std::pair<u32, bool>, 4>;
+
+  f32 IsSmaller(const Direction &directions, const std::vector<i32> &path,
+                u32 node) const {
+    std::vector<u32> buff;
+    bool stop = false;
+    for (auto it = path.rbegin(); it != path.rend() && !stop; ++it) {
+      if (*it == -1)
+        return 0;
+      const auto [child, goUp] = directions[*it];
+      stop = !goUp;
+      buff.push_back(child);
+      node = nodes[node].parent;
+    }
+    for (auto it = buff.rbegin(); it != buff.rend(); ++it) {
+      node = nodes[node].children[*it];
+      if (!nodes[node].HasChildren())
+        return 1;
+    }
+    f32 res = 1.f;
+    while (nodes[node].HasChildren()) {
+      node = nodes[node].children[buff.front()];
+      res *= 2.f;
+    }
+    return res;
+  }
+
+  QuadTree::SmallerNeighborRatio
+  GetSmallerNeighbor(u32 node, const std::vector<i32> &path) const {
+    static constexpr Direction xpos = {
+        {{2, false}, {3, false}, {0, true}, {1, true}}};
+    static constexpr Direction xneg = {
+        {{2, true}, {3, true}, {0, false}, {1, false}}};
+    static constexpr Direction zneg = {
+        {{1, true}, {0, false}, {3, true}, {2, false}}};
+    static constexpr Direction zpos = {
+        {{1, false}, {0, true}, {3, false}, {2, true}}};
+    return {IsSmaller(xpos, path, node), IsSmaller(xneg, path, node),
+            IsSmaller(zneg, path, node), IsSmaller(zpos, path, node)};
+  }
+
+  void BuildRecursively(u32 index, Depth depth,
+                        const QuadCollectionDescription &desc) {
+    if (depth > desc.maxDepth)
+      return;
+    if (count + 4 > nodes.size())
+      nodes.resize(count + 4);
+
+    const PointerNode &node = nodes[index];
+    const float3 diff = {node.center.x - desc.camEye.x,
+                         desc.center.y - desc.camEye.y,
+                         node.center.y - desc.camEye.z};
+    const bool cont = dot(diff, diff) / (node.size.x * node.size.y) <
+                      desc.distanceThreshold;
+    const AABB aabb{float3{node.center.x, desc.center.y, node.center.y},
+                    node.size.x / 2, 0, node.size.y / 2};
+    if (!cont || !aabb.isOnFrustum(desc.frustum, desc.modelMatrix))
+      return;
+    for (u32 i = 0; i < 4; i++) {
+      const u32 id = count++;
+      nodes[index].children[i] = id;
+      PointerNode &child = nodes[id];
+      child.parent = index;
+      child.size = nodes[index].size / 2;
+      child.center =
+          nodes[index].center + Node::childDirections[i] * (child.size / 2);
+      BuildRecursively(id, depth + 1, desc);
+    }
+  }
+
+  std::vector<PointerNode> nodes;
+  u32 count = 0;
+  u32 start = 0;
+  std::array<i32, 4> next = {1, 2, 3, -1};
+};
+
+// Neighbour level by brute force: the leaf containing the cell next to the
+// first corner of each edge.
+QuadTree::SmallerNeighborRatio BruteForceNeighbors(const QuadTree &qt,
+                                                   const QuadTree::Leaf &leaf) {
+  const auto find = [&](i64 x, i64 z) -> f32 {
+    const i64 cells = 1ll << QuadTree::MaxLevel;
+    if (x < 0 || z < 0 || x >= cells || z >= cells)
+      return 0;
+    for (const auto &other : qt.GetLeaves()) {
+      const i64 extent = 1ll << (QuadTree::MaxLevel - other.level);
+      const i64 ox = Morton::DecodeX(other.code);
+      const i64 oz = Morton::DecodeZ(other.code);
+      if (x >= ox && x < ox + extent && z >= oz && z < oz + extent)
+        return other.level > leaf.level
+                   ? (f32)(1u << (other.level - leaf.level))
+                   : 1.f;
+    }
+    return -1;
+  };
+  const i64 x = Morton::DecodeX(leaf.code);
+  const i64 z = Morton::DecodeZ(leaf.code);
+  const i64 extent = 1ll << (QuadTree::MaxLevel - leaf.level);
+  return {find(x + extent, z), find(x - 1, z), find(x, z - 1),
+          find(x, z + extent)};
+}
+
+bool SameRatios(const QuadTree::SmallerNeighborRatio &a,
+                const QuadTree::SmallerNeighborRatio &b) {
+  return a.xpos == b.xpos && a.xneg == b.xneg && a.zneg == b.zneg &&
+         a.zpos == b.zpos;
+}
+
+// Same leaves in the same order as the pointer tree, and the neighbours
+// resolved by the build against a brute force scan.
+void Validate() {
+  u32 leafMismatches = 0, neighborMismatches = 0, leaves = 0;
+  QuadTree qt;
+  PointerQuadTree reference;
+  for (Depth maxDepth : {3u, 5u, 7u})
+    for (u32 frame = 0; frame < 600; frame += 37) {
+      const auto desc = MakeQuadDescription(FlyingCamera(frame), maxDepth);
+      qt.Build(desc.center, desc.fullSizeXZ, desc.camEye, desc.camForward,
+               desc.frustum, desc.modelMatrix, desc.distanceThreshold,
+               desc.maxDepth);
+      reference.Build(desc);
+
+      std::vector<Node> expected;
+      reference.ForEachLeaf(
+          [&](const auto &node, const auto &) {
+            expected.push_back({node.center, node.size});
+          });
+      const auto got = qt.GetLeaves();
+      leafMismatches += expected.size() != got.size() ||
+                        reference.GetSize() != qt.GetSize();
+      for (u32 i = 0; i < std::min((u32)expected.size(), (u32)got.size());
+           ++i) {
+        const Node node = qt.GetNode(got[i]);
+        leafMismatches += !(node.center == expected[i].center &&
+                            node.size == expected[i].size);
+        if (maxDepth <= 5)
+          neighborMismatches += !SameRatios(qt.GetSmallerNeighbor(i),
+                                            BruteForceNeighbors(qt, got[i]));
+      }
+      leaves += (u32)got.size();
+    }
+  std::printf("Validated %u leaves: %u leaf mismatches, %u neighbour "
+              "mismatches\n\n",
+              leaves, leafMismatches, neighborMismatches);
+}
+
+// The tree kept up to date frame by frame against a full build, for a
+// continuous flight and for a camera jumping between far frames.
+void ValidateIncremental() {
+  u32 mismatches = 0, frames = 0;
+  QuadTree incremental, full;
+  for (Depth maxDepth : {5u, 7u, 9u})
+    for (u32 step : {1u, 97u})
+      for (u32 frame = 0; frame < 600 * step; frame += step, ++frames) {
+        const auto desc = MakeQuadDescription(FlyingCamera(frame), maxDepth);
+        incremental.Update(desc.center, desc.fullSizeXZ, desc.camEye,
+                           desc.camForward, desc.frustum, desc.modelMatrix,
+                           desc.distanceThreshold, desc.maxDepth);
+        full.Build(desc.center, desc.fullSizeXZ, desc.camEye, desc.camForward,
+                   desc.frustum, desc.modelMatrix, desc.distanceThreshold,
+                   desc.maxDepth);
+        const auto a = incremental.GetLeaves();
+        const auto b = full.GetLeaves();
+        bool same = a.size() == b.size() &&
+                    incremental.GetSize() == full.GetSize();
+        for (u32 i = 0; same && i < (u32)a.size(); ++i)
+          same = a[i].code == b[i].code && a[i].level == b[i].level &&
+                 SameRatios(a[i].neighbors, b[i].neighbors);
+        mismatches += !same;
+      }
+  std::printf("Validated %u incremental updates: %u mismatches\n\n", frames,
+              mismatches);
+}
+
+// A budget equal to the leaf count of the threshold build gives the same
+// tree, any other budget is met to within one split.
+void ValidateBudget() {
+  u32 mismatches = 0, missed = 0, builds = 0;
+  QuadTree threshold, budgeted;
+  for (Depth maxDepth : {5u, 7u, 9u})
+    for (u32 frame = 0; frame < 600; frame += 13, ++builds) {
+      const auto desc = MakeQuadDescription(FlyingCamera(frame), maxDepth);
+      threshold.Build(desc.center, desc.fullSizeXZ, desc.camEye,
+                      desc.camForward, desc.frustum, desc.modelMatrix,
+                      desc.distanceThreshold, desc.maxDepth);
+      budgeted.BuildBudgeted(desc.center, desc.fullSizeXZ, desc.camEye,
+                             desc.camForward, desc.frustum, desc.modelMatrix,
+                             threshold.GetLeafCount(), desc.maxDepth);
+      const auto a = threshold.GetLeaves();
+      const auto b = budgeted.GetLeaves();
+      bool same = a.size() == b.size();
+      for (u32 i = 0; same && i < (u32)a.size(); ++i)
+        same = a[i].code == b[i].code && a[i].level == b[i].level &&
+               SameRatios(a[i].neighbors, b[i].neighbors);
+      mismatches += !same;
+
+      const u32 budget = 100 + frame;
+      budgeted.BuildBudgeted(desc.center, desc.fullSizeXZ, desc.camEye,
+                             desc.camForward, desc.frustum, desc.modelMatrix,
+                             budget, 12);
+      missed += budgeted.GetLeafCount() > budget ||
+                budgeted.GetLeafCount() + 2 < budget;
+    }
+  std::printf("Validated %u budgeted builds: %u mismatches, %u budgets "
+              "missed\n\n",
+              builds, mismatches, missed);
+}
+
+bool SameQuads(const std::vector<OceanQuad> &a,
+               const std::vector<OceanQuad> &b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [](const OceanQuad &x, const OceanQuad &y) {
+                      return std::memcmp(&x, &y, sizeof(OceanQuad)) == 0;
+                    });
+}
+
+// Distance threshold of a tree of about 9000 leaves at maxDepth=14.
+constexpr f32 LargeThreshold = 4e+3f;
+
+// The quads collected on a pool of threads, built and updated, against the
+// serial collection: the same quads at the same indices. The last trees are
+// past QuadTree::ParallelLeaves.
+void ValidateParallel(ThreadPool &pool) {
+  u32 mismatches = 0, frames = 0;
+  QuadTree serial, parallel;
+  std::vector<OceanQuad> expected, got;
+  for (const auto &[maxDepth, threshold] :
+       {std::pair{5u, QuadTree::Defaults::DistanceThreshold},
+        {7u, QuadTree::Defaults::DistanceThreshold},
+        {9u, QuadTree::Defaults::DistanceThreshold}, {14u, LargeThreshold}})
+    for (bool incremental : {false, true})
+      for (u32 frame = 0; frame < 600; frame += 7, ++frames) {
+        auto desc =
+            MakeQuadDescription(FlyingCamera(frame), maxDepth, threshold);
+        desc.incremental = incremental;
+        expected.clear();
+        CollectOceanQuads(serial, desc, [&](const OceanQuad &quad) {
+          expected.push_back(quad);
+        });
+        got.assign(7, {});
+        CollectOceanQuads(
+            parallel, desc, pool, [&](u32 count) { got.resize(count); },
+            [&](u32 index, const OceanQuad &quad) { got[index] = quad; });
+        mismatches += !SameQuads(expected, got) ||
+                      serial.GetSize() != parallel.GetSize() ||
+                      serial.GetHeight() != parallel.GetHeight();
+      }
+  std::printf("Validated %u parallel collections on %u threads: %u "
+              "mismatches\n\n",
+              frames, pool.GetConcurrency(), mismatches);
+}
+
+// The packed quads unpacked against the quads of the same tree: the same
+// place, size and tessellation ratios.
+void ValidatePacked(ThreadPool &pool) {
+  u32 mismatches = 0, frames = 0;
+  QuadTree serial, packedTree;
+  std::vector<OceanQuad> expected, got;
+  std::vector<PackedOceanQuad> packed;
+  for (Depth maxDepth : {5u, 9u, 14u})
+    for (u32 frame = 0; frame < 600; frame += 7, ++frames) {
+      const auto desc = MakeQuadDescription(FlyingCamera(frame), maxDepth);
+      expected.clear();
+      CollectOceanQuads(serial, desc, [&](const OceanQuad &quad) {
+        expected.push_back(quad);
+      });
+      CollectOceanQuads(packedTree, desc, pool, packed);
+      got.clear();
+      for (const PackedOceanQuad &quad : packed)
+        got.push_back(UnpackOceanQuad(quad, desc.center, desc.fullSizeXZ));
+      mismatches += !SameQuads(expected, got);
+    }
+  std::printf("Validated %u packed collections: %u mismatches\n\n", frames,
+              mismatches);
+}
+
+// The per frame instance data before the packed stream: fixed chunks of
+// the full instance arrays of the vertex and hull shaders.
+struct InstanceChunk {
+  std::array<float4, 4096> vertex;
+  std::array<float4, 4096> hull;
+  u16 N = 0;
+};
+} // namespace
+
+int main() {
+  ThreadPool pool(7);
+  Validate();
+  ValidateIncremental();
+  ValidateParallel(pool);
+  ValidateBudget();
+  ValidatePacked(pool);
+
+  for (Depth maxDepth : {5u, 7u, 9u}) {
+    PointerQuadTree reference;
+    u32 frame = 0;
+    const auto referenceRes = Measure(
+        [&] {
+          const auto desc = MakeQuadDescription(FlyingCamera(frame++), maxDepth);
+          reference.Build(desc);
+          u32 quads = 0;
+          reference.ForEachLeaf([&](const auto &, const auto &ratio) {
+            quads += ratio.xpos > 0;
+          });
+          DoNotOptimize(quads);
+        },
+        200, 5);
+    Print(("Pointer quadtree maxDepth=" + std::to_string(maxDepth)).c_str(),
+          referenceRes);
+
+    QuadTree qt;
+    QuadCollectionStatistics stats;
+    frame = 0;
+    u32 quads = 0;
+    const auto res = Measure(
+        [&] {
+          const auto desc = MakeQuadDescription(FlyingCamera(frame++), maxDepth);
+          CollectOceanQuads(
+              qt, desc, [&quads](const OceanQuad &) { ++quads; }, &stats);
+        },
+        200, 5);
+    Print(("CollectOceanQuads maxDepth=" + std::to_string(maxDepth)).c_str(),
+          res);
+    std::printf("  avg nodes %u, avg drawn %u, build %.3f ms, navigate %.3f "
+                "ms, speedup %.2fx\n",
+                stats.qtNodes / 205, stats.drawnNodes / 205,
+                std::chrono::duration<double, std::milli>(
+                    stats.QuadTreeBuildTime)
+                        .count() /
+                    205,
+                std::chrono::duration<double, std::milli>(
+                    stats.NavigatingTheQuadTree)
+                        .count() /
+                    205,
+                referenceRes.minMs / res.minMs);
+
+    // The same flight, keeping the tree between frames.
+    QuadTree kept;
+    QuadCollectionStatistics keptStats;
+    frame = 0;
+    const auto keptRes = Measure(
+        [&] {
+          auto desc = MakeQuadDescription(FlyingCamera(frame++), maxDepth);
+          desc.incremental = true;
+          CollectOceanQuads(
+              kept, desc, [&quads](const OceanQuad &) { ++quads; }, &keptStats);
+        },
+        200, 5);
+    Print(("Incremental update maxDepth=" + std::to_string(maxDepth)).c_str(),
+          keptRes);
+    std::printf("  avg touched %u of %u nodes, speedup %.2fx over a full "
+                "build\n",
+                keptStats.touchedNodes / 205, keptStats.qtNodes / 205,
+                res.minMs / keptRes.minMs);
+
+    // The same flight again, the subtrees and the quads on 8 threads.
+    QuadTree shared;
+    std::vector<OceanQuad> collected;
+    frame = 0;
+    const auto parallelRes = Measure(
+        [&] {
+          const auto desc = MakeQuadDescription(FlyingCamera(frame++), maxDepth);
+          CollectOceanQuads(
+              shared, desc, pool,
+              [&collected](u32 count) { collected.resize(count); },
+              [&collected](u32 index, const OceanQuad &quad) {
+                collected[index] = quad;
+              });
+          DoNotOptimize(collected.data());
+        },
+        200, 5);
+    Print(("Parallel collection maxDepth=" + std::to_string(maxDepth)).c_str(),
+          parallelRes);
+    std::printf("  %u threads, speedup %.2fx over a serial build\n",
+                pool.GetConcurrency(), res.minMs / parallelRes.minMs);
+  }
+
+  // A tree past QuadTree::ParallelLeaves, serial and on the pool.
+  {
+    QuadTree serial, shared;
+    std::vector<OceanQuad> collected;
+    u32 frame = 0, quads = 0;
+    const auto serialRes = Measure(
+        [&] {
+          const auto desc =
+              MakeQuadDescription(FlyingCamera(frame++), 14, LargeThreshold);
+          CollectOceanQuads(serial, desc,
+                            [&quads](const OceanQuad &) { ++quads; });
+        },
+        50, 3);
+    Print("CollectOceanQuads large tree", serialRes);
+    frame = 0;
+    const auto parallelRes = Measure(
+        [&] {
+          const auto desc =
+              MakeQuadDescription(FlyingCamera(frame++), 14, LargeThreshold);
+          CollectOceanQuads(
+              shared, desc, pool,
+              [&collected](u32 count) { collected.resize(count); },
+              [&collected](u32 index, const OceanQuad &quad) {
+                collected[index] = quad;
+              });
+          DoNotOptimize(collected.data());
+        },
+        50, 3);
+    Print("Parallel collection large tree", parallelRes);
+    std::printf("  %u leaves, %u threads, speedup %.2fx over a serial build\n",
+                shared.GetLeafCount(), pool.GetConcurrency(),
+                serialRes.minMs / parallelRes.minMs);
+  }
+
+  // The leaf count over the flight: refined by the distance threshold, and
+  // by a budget of the mean of that.
+  QuadTree qt;
+  u32 fewest = ~0u, most = 0, total = 0;
+  constexpr u32 Frames = 600;
+  for (u32 frame = 0; frame < Frames; ++frame) {
+    const auto desc = MakeQuadDescription(FlyingCamera(frame), 9);
+    qt.Build(desc.center, desc.fullSizeXZ, desc.camEye, desc.camForward,
+             desc.frustum, desc.modelMatrix, desc.distanceThreshold,
+             desc.maxDepth);
+    fewest = std::min(fewest, qt.GetLeafCount());
+    most = std::max(most, qt.GetLeafCount());
+    total += qt.GetLeafCount();
+  }
+  std::printf("\nThreshold leaves maxDepth=9: %u to %u, mean %u\n", fewest,
+              most, total / Frames);
+
+  const u32 budget = total / Frames;
+  fewest = ~0u, most = 0;
+  u32 frame = 0;
+  const auto budgetRes = Measure(
+      [&] {
+        auto desc = MakeQuadDescription(FlyingCamera(frame++ % Frames), 9);
+        desc.leafBudget = budget;
+        CollectOceanQuads(qt, desc, [](const OceanQuad &) {});
+        fewest = std::min(fewest, qt.GetLeafCount());
+        most = std::max(most, qt.GetLeafCount());
+      },
+      Frames, 5);
+  Print(("Budgeted build leafBudget=" + std::to_string(budget)).c_str(),
+        budgetRes);
+  std::printf("  leaves %u to %u\n", fewest, most);
+
+  // The instance data of a frame written and copied for the upload, as
+  // chunks of full arrays and as the packed stream.
+  std::vector<InstanceChunk> chunks;
+  std::vector<u8> upload;
+  u64 chunkBytes = 0;
+  frame = 0;
+  const auto chunkRes = Measure(
+      [&] {
+        auto desc = MakeQuadDescription(FlyingCamera(frame++ % Frames), 9);
+        CollectOceanQuads(
+            qt, desc, pool,
+            [&](u32 count) {
+              chunks.resize(count / 4096 + 1);
+              for (u32 i = 0; i < (u32)chunks.size(); ++i)
+                chunks[i].N = (u16)std::min(4096u, count - i * 4096);
+            },
+            [&](u32 index, const OceanQuad &quad) {
+              InstanceChunk &chunk = chunks[index / 4096];
+              chunk.vertex[index % 4096] = {quad.scaling.x, quad.scaling.y,
+                                            quad.offset.x, quad.offset.y};
+              chunk.hull[index % 4096] = quad.tessellation;
+            });
+        upload.clear();
+        for (const InstanceChunk &chunk : chunks) {
+          const auto *vertex = (const u8 *)chunk.vertex.data();
+          const auto *hull = (const u8 *)chunk.hull.data();
+          upload.insert(upload.end(), vertex, vertex + sizeof(chunk.vertex));
+          upload.insert(upload.end(), hull, hull + sizeof(chunk.hull));
+        }
+        chunkBytes += upload.size();
+      },
+      Frames, 5);
+  Print("Instance chunks maxDepth=9", chunkRes);
+
+  std::vector<PackedOceanQuad> packed;
+  u64 packedBytes = 0;
+  frame = 0;
+  const auto packedRes = Measure(
+      [&] {
+        auto desc = MakeQuadDescription(FlyingCamera(frame++ % Frames), 9);
+        CollectOceanQuads(qt, desc, pool, packed);
+        const auto *data = (const u8 *)packed.data();
+        upload.assign(data, data + packed.size() * sizeof(PackedOceanQuad));
+        packedBytes += upload.size();
+      },
+      Frames, 5);
+  Print("Packed instance stream maxDepth=9", packedRes);
+  std::printf("  %.1f KB uploaded per frame against %.1f KB, speedup %.2fx\n",
+              packedBytes / 1024.0 / (Frames + 5),
+              chunkBytes / 1024.0 / (Frames + 5),
+              chunkRes.minMs / packedRes.minMs);
+  return 0;
+}
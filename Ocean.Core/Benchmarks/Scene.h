@@ -0,0 +1,79 @@
+#pragma once
+#include <numbers>
+#include "Ocean/Culling/CameraPredictor.h"
+#include "Ocean/Culling/Frustum.h"
+#include "Ocean/Spectrum/Spectrum.h"
+#include "Ocean/QuadTree/OceanQuads.h"
+
+// Headless stand-ins for the application's camera and default simulation
+// settings, so benchmarks measure the same workload as the app.
+namespace Ocean::Benchmarks {
+struct ViewPoint {
+  float3 eye;
+  float3 forward;
+  float3 right;
+  float3 up;
+  f32 fovY = 27.f * std::numbers::pi_v<f32> / 180.f;
+  f32 aspect = 16.f / 9.f;
+  f32 zNear = 0.1f;
+  f32 zFar = 1000.f;
+
+  // Right handed, first person camera as in Camera::UpdateParams.
+  static ViewPoint LookAt(const float3 &eye, const float3 &at) {
+    ViewPoint res;
+    res.eye = eye;
+    res.forward = normalize(at - eye);
+    res.right = normalize(cross(res.forward, float3(0, 1, 0)));
+    res.up = normalize(cross(res.right, res.forward));
+    return res;
+  }
+
+  Frustum GetFrustum() const {
+    return MakeFrustum(eye, forward, right, up, fovY, aspect, zNear, zFar);
+  }
+
+  CameraPose Pose() const {
+    return {eye, forward, right, up, fovY, aspect, zNear, zFar};
+  }
+};
+
+// Same as the oceanModelMatrix used by the application.
+inline float4x4 OceanModelMatrix() {
+  return float4x4::Translation(float3(0, -5, 0));
+}
+
+inline QuadCollectionDescription
+MakeQuadDescription(const ViewPoint &view, Depth maxDepth,
+                    f32 threshold = QuadTree::Defaults::DistanceThreshold) {
+  QuadCollectionDescription desc;
+  desc.fullSizeXZ = {1000.f, 1000.f};
+  desc.camEye = view.eye;
+  desc.camForward = view.forward;
+  desc.frustum = view.GetFrustum();
+  desc.modelMatrix = OceanModelMatrix();
+  desc.distanceThreshold = threshold;
+  desc.maxDepth = maxDepth;
+  return desc;
+}
+
+// A camera flying a slow circle above the water, frame by frame.
+inline ViewPoint FlyingCamera(u32 frame, f32 height = 10.f) {
+  const f32 t = (f32)frame * 0.01f;
+  const float3 eye = {60.f * std::cos(t), height, 60.f * std::sin(t)};
+  const float3 at = {60.f * std::cos(t + 0.3f), 0.f,
+                     60.f * std::sin(t + 0.3f)};
+  return ViewPoint::LookAt(eye, at);
+}
+
+// SimulationData::Default(), highest cascade.
+inline SpectrumParameters DefaultSpectrum(u32 N) {
+  return SpectrumParameters{.N = N,
+                            .M = N,
+                            .patchSize = 12.f,
+                            .Amplitude = 0.005f,
+                            .WindForce = 9,
+                            .windDirection = float2(-1.f, 1.f),
+                            .gravity = 9.81f,
+                            .Depth = 100.f};
+}
+} // namespace Ocean::Benchmarks
@@ -0,0 +1,373 @@
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstring>
+#include <numbers>
+#include <random>
+#include <string>
+#include "Ocean/Spectrum/Random.h"
+#include "Ocean/Threading/ThreadPool.h"
+#include "Benchmark.h"
+#include "Scene.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+using c32 = std::complex<f32>;
+
+// The scalar Phillips spectrum of the application before Ocean.Core, the
+// baseline of the generators.
+f32 PhilipsSpektrum(const float2 &k, f32 Amplitude, f32 largestHeight,
+                    const float2 &wind) {
+  // Smaller than these waves
+  const f32 l = largestHeight / 1000.f;
+
+  const f32 kdotw = dot(k, normalize(wind));
+  const f32 klengthsq = dot(k, k);
+  f32 P_h = Amplitude *
+            (std::exp(-1.0f / (klengthsq * largestHeight * largestHeight))) /
+            (klengthsq * klengthsq * klengthsq) * (kdotw * kdotw);
+
+  if (kdotw < 0.0f) {
+    // wave is moving against wind direction w
+    P_h *= 0.07f;
+  }
+
+  return P_h * std::exp(-klengthsq * l * l);
+}
+
+c32 tilde_h0(const float2 &k, f32 xi_real, f32 xi_im, f32 Amplitude,
+             f32 largestHeight, const float2 &wind) {
+  c32 res(xi_real, xi_im);
+  f32 sqrt_Ph = 0;
+  if (k.x != 0.f || k.y != 0.f)
+    sqrt_Ph = std::sqrt(PhilipsSpektrum(k, Amplitude, largestHeight, wind));
+  res *= sqrt_Ph;
+  res *= 1 / std::numbers::sqrt2_v<f32>;
+  return res;
+}
+
+float2 WaveVector(const SpectrumParameters &dat, u32 i, u32 j) {
+  const f32 dk = 2.f * std::numbers::pi_v<f32> / dat.patchSize;
+  return {(f32)((i32)dat.N / 2 - (i32)i) * dk,
+          (f32)((i32)dat.M / 2 - (i32)j) * dk};
+}
+
+// The sequential generator the parallel one replaced: one Xorshift128
+// stream through std::normal_distribution, scalar Phillips spectrum.
+std::vector<c32> SequentialTildeh0(const SpectrumParameters &dat) {
+  Xorshift128 gen(dat.seed);
+  std::normal_distribution<f32> dis(0, 1);
+  const auto wind = normalize(dat.windDirection);
+  const f32 largestHeight = dat.WindForce * dat.WindForce / dat.gravity;
+  std::vector<c32> res((size_t)dat.N * dat.M);
+  for (u32 i = 0; i < dat.N; ++i)
+    for (u32 j = 0; j < dat.M; ++j) {
+      const float2 k = WaveVector(dat, i, j);
+      res[(size_t)i * dat.M + j] = tilde_h0(k, dis(gen), dis(gen),
+                                            dat.Amplitude, largestHeight, wind);
+    }
+  return res;
+}
+
+std::vector<f32> SequentialFrequencies(const SpectrumParameters &dat) {
+  std::vector<f32> res((size_t)dat.N * dat.M);
+  for (u32 i = 0; i < dat.N; ++i)
+    for (u32 j = 0; j < dat.M; ++j) {
+      const float2 k = WaveVector(dat, i, j);
+      const f32 klength = length(k);
+      res[(size_t)i * dat.M + j] =
+          std::sqrt(dat.gravity * klength * std::tanh(klength * dat.Depth));
+    }
+  return res;
+}
+
+// Direct double precision transcriptions of the spectra of
+// SpectrumModels.h.
+f64 ReferenceDensity(const SpectrumParameters &dat, f64 omega) {
+  const f64 g = dat.gravity;
+  const f64 U = dat.WindForce;
+  const f64 F = dat.fetch;
+  if (dat.spectrum == SpectrumType::PiersonMoskowitz) {
+    const f64 peak = 0.855 * g / U;
+    return 8.1e-3 * g * g / std::pow(omega, 5) *
+           std::exp(-1.25 * std::pow(peak / omega, 4));
+  }
+  const f64 alpha = 0.076 * std::pow(U * U / (F * g), 0.22);
+  const f64 peak = 22 * std::cbrt(g * g / (U * F));
+  const f64 sigma = omega <= peak ? 0.07 : 0.09;
+  const f64 r = std::exp(-(omega - peak) * (omega - peak) /
+                         (2 * sigma * sigma * peak * peak));
+  f64 res = alpha * g * g / std::pow(omega, 5) *
+            std::exp(-1.25 * std::pow(peak / omega, 4)) *
+            std::pow((f64)dat.peakEnhancement, r);
+  if (dat.spectrum == SpectrumType::Tma) {
+    const f64 wh = omega * std::sqrt(dat.Depth / g);
+    res *= wh <= 1 ? 0.5 * wh * wh
+           : wh < 2 ? 1 - 0.5 * (2 - wh) * (2 - wh)
+                    : 1;
+  }
+  return res;
+}
+
+f64 ReferencePeak(const SpectrumParameters &dat) {
+  if (dat.spectrum == SpectrumType::PiersonMoskowitz)
+    return 0.855 * dat.gravity / dat.WindForce;
+  return 22 * std::cbrt((f64)dat.gravity * dat.gravity /
+                        ((f64)dat.WindForce * dat.fetch));
+}
+
+f64 ReferenceSpreading(const SpectrumParameters &dat, f64 omega, f64 theta) {
+  const f64 peak = ReferencePeak(dat);
+  const f64 ratio = omega / peak;
+  if (dat.spreading == Spreading::Cos2s) {
+    const f64 sp = 11.5 * std::pow(dat.gravity / (peak * dat.WindForce), 2.5);
+    const f64 s = sp * std::pow(ratio, ratio <= 1 ? 5 : -2.5);
+    const f64 norm = std::exp(std::lgamma(s + 1) - std::lgamma(s + 0.5)) /
+                     (2 * std::sqrt(std::numbers::pi));
+    return norm * std::pow(std::abs(std::cos(theta / 2)), 2 * s);
+  }
+  const f64 beta =
+      ratio < 0.95  ? 2.61 * std::pow(ratio, 1.3)
+      : ratio < 1.6 ? 2.28 * std::pow(ratio, -1.3)
+                    : std::pow(10, -0.4 + 0.8393 *
+                                              std::exp(-0.567 *
+                                                       std::log(ratio * ratio)));
+  const f64 sech = 1 / std::cosh(beta * theta);
+  return beta / (2 * std::tanh(beta * std::numbers::pi)) * sech * sech;
+}
+
+// Standard deviation of the parts of tilde_h0(k).
+f64 ReferenceAmplitude(const SpectrumParameters &dat, const float2 &k) {
+  if (dat.spectrum == SpectrumType::Phillips)
+    return tilde_h0(k, 1, 0, dat.Amplitude,
+                    dat.WindForce * dat.WindForce / dat.gravity,
+                    normalize(dat.windDirection))
+        .real();
+  const f64 kx = k.x, ky = k.y;
+  const f64 klength = std::sqrt(kx * kx + ky * ky);
+  if (klength == 0)
+    return 0;
+  const f64 g = dat.gravity, D = dat.Depth;
+  const f64 tanh = std::tanh(klength * D);
+  const f64 omega = std::sqrt(g * klength * tanh);
+  const f64 derivative =
+      g * (tanh + klength * D * (1 - tanh * tanh)) / (2 * omega);
+  const float2 wind = normalize(dat.windDirection);
+  const f64 theta =
+      std::atan2(kx * wind.y - ky * wind.x, kx * wind.x + ky * wind.y);
+  const f64 dk = 2 * std::numbers::pi / dat.patchSize;
+  return std::sqrt(ReferenceDensity(dat, omega) *
+                   ReferenceSpreading(dat, omega, theta) * derivative /
+                   klength * dk * dk / 2);
+}
+
+// Element (i, j) of CalculateTildeh0 from the same Philox noise, in double
+// precision.
+c32 ReferenceTildeh0(const SpectrumParameters &dat, u32 i, u32 j) {
+  const auto block = Philox4x32(dat.seed)({j / 2, i, 0, 0});
+  const f64 u1 = ((block[2 * (j % 2)] >> 8) + 1) / f64(1 << 24);
+  const f64 u2 = (block[2 * (j % 2) + 1] >> 8) / f64(1 << 24);
+  const f64 r = std::sqrt(-2 * std::log(u1));
+  const f64 phi = 2 * std::numbers::pi * u2;
+  const f64 amplitude = ReferenceAmplitude(dat, WaveVector(dat, i, j));
+  return {(f32)(r * std::cos(phi) * amplitude),
+          (f32)(r * std::sin(phi) * amplitude)};
+}
+
+template <typename T>
+bool SameBits(const std::vector<T> &a, const std::vector<T> &b) {
+  return a.size() == b.size() &&
+         std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+void Validate(ThreadPool &pool) {
+  SpectrumParameters params = DefaultSpectrum(256);
+  params.seed = 42;
+
+  // Identical for any number of threads.
+  ThreadPool single(0);
+  const auto h0 = CalculateTildeh0(params);
+  const auto frequencies = CalculateFrequencies(params);
+  const auto half = CalculateHalfSpectrum(params);
+  bool deterministic = true;
+  for (ThreadPool *threads : {&single, &pool}) {
+    deterministic &= SameBits(h0, CalculateTildeh0(params, threads));
+    deterministic &=
+        SameBits(frequencies, CalculateFrequencies(params, threads));
+    const auto other = CalculateHalfSpectrum(params, threads);
+    deterministic &= SameBits(half.tildeh0, other.tildeh0) &&
+                     SameBits(half.tildeh0Mirrored, other.tildeh0Mirrored) &&
+                     SameBits(half.frequencies, other.frequencies);
+  }
+
+  // Against the scalar evaluation, and the half spectrum against the full.
+  const auto frequencyReference = SequentialFrequencies(params);
+  const auto h0Expanded = half.ExpandTildeh0();
+  const auto frequenciesExpanded = half.ExpandFrequencies();
+  f64 h0Error = 0, h0Max = 0, frequencyError = 0, halfError = 0;
+  for (u32 i = 0; i < params.N; ++i)
+    for (u32 j = 0; j < params.M; ++j) {
+      const size_t index = (size_t)i * params.M + j;
+      const c32 reference = ReferenceTildeh0(params, i, j);
+      h0Error = std::max(h0Error, (f64)std::abs(h0[index] - reference));
+      h0Max = std::max(h0Max, (f64)std::abs(reference));
+      halfError =
+          std::max(halfError, (f64)std::abs(h0[index] - h0Expanded[index]));
+      if (frequencyReference[index] > 0)
+        frequencyError = std::max(
+            frequencyError, (f64)std::abs(frequencies[index] -
+                                          frequencyReference[index]) /
+                                frequencyReference[index]);
+      halfError =
+          std::max(halfError, (f64)std::abs(frequencies[index] -
+                                            frequenciesExpanded[index]));
+    }
+  std::printf("Deterministic across thread counts: %s\n",
+              deterministic ? "yes" : "NO");
+  std::printf("Max rel error tilde_h0 %.2e, frequencies %.2e, half vs full "
+              "%.2e\n\n",
+              h0Error / h0Max, frequencyError, halfError);
+}
+
+struct Model {
+  const char *name;
+  SpectrumType spectrum;
+  Spreading spreading;
+};
+
+constexpr Model Models[] = {
+    {"Phillips", SpectrumType::Phillips, Spreading::Cos2s},
+    {"Pierson-Moskowitz cos-2s", SpectrumType::PiersonMoskowitz,
+     Spreading::Cos2s},
+    {"JONSWAP cos-2s", SpectrumType::Jonswap, Spreading::Cos2s},
+    {"JONSWAP Donelan-Banner", SpectrumType::Jonswap,
+     Spreading::DonelanBanner},
+    {"TMA cos-2s", SpectrumType::Tma, Spreading::Cos2s},
+    {"TMA Donelan-Banner", SpectrumType::Tma, Spreading::DonelanBanner},
+};
+
+SpectrumParameters ModelSpectrum(u32 N, const Model &model) {
+  SpectrumParameters res = DefaultSpectrum(N);
+  res.spectrum = model.spectrum;
+  res.spreading = model.spreading;
+  return res;
+}
+
+// Every model against its double precision reference, on a patch large
+// enough to hold the spectral peak, in water shallow enough for TMA.
+void ValidateModels() {
+  for (const Model &model : Models) {
+    SpectrumParameters params = ModelSpectrum(128, model);
+    params.patchSize = 200.f;
+    params.Depth = 5.f;
+    params.seed = 7;
+
+    const auto h0 = CalculateTildeh0(params);
+    const auto half = CalculateHalfSpectrum(params).ExpandTildeh0();
+    f64 error = 0, maxValue = 0, halfError = 0, variance = 0;
+    for (u32 i = 0; i < params.N; ++i)
+      for (u32 j = 0; j < params.M; ++j) {
+        const size_t index = (size_t)i * params.M + j;
+        const c32 reference = ReferenceTildeh0(params, i, j);
+        error = std::max(error, (f64)std::abs(h0[index] - reference));
+        maxValue = std::max(maxValue, (f64)std::abs(reference));
+        halfError = std::max(halfError, (f64)std::abs(h0[index] - half[index]));
+        variance += std::norm(h0[index]);
+      }
+
+    // The spreading integrates to 1 over the directions.
+    f64 normError = 0;
+    if (model.spectrum != SpectrumType::Phillips)
+      for (f64 ratio : {0.5, 1.0, 2.0, 5.0}) {
+        const u32 steps = 4096;
+        f64 sum = 0;
+        for (u32 s = 0; s < steps; ++s) {
+          const f64 theta = -std::numbers::pi +
+                            2 * std::numbers::pi * (s + 0.5) / steps;
+          sum += ReferenceSpreading(params, ratio * ReferencePeak(params),
+                                    theta);
+        }
+        normError = std::max(
+            normError, std::abs(sum * 2 * std::numbers::pi / steps - 1));
+      }
+
+    std::printf("%-26s max rel error %.2e, half vs full %.2e, spreading "
+                "norm error %.1e, Hs %.3f\n",
+                model.name, error / maxValue, halfError / maxValue,
+                normError, 4 * std::sqrt(variance));
+  }
+  std::printf("\n");
+}
+
+// Bulk generation of every model, single thread, against the vectorized
+// Phillips path and the sequential one it replaced.
+void BenchmarkModels() {
+  std::printf("CalculateTildeh0 per spectrum, single thread\n");
+  for (u32 N : {256u, 512u, 1024u, 2048u, 4096u}) {
+    const u32 iterations = N >= 2048 ? 2 : 5;
+    const std::string size = " N=" + std::to_string(N);
+    const auto sequential = Measure(
+        [&] { DoNotOptimize(SequentialTildeh0(ModelSpectrum(N, Models[0]))); },
+        iterations, 1);
+    Print(("Sequential Phillips" + size).c_str(), sequential);
+    f64 phillipsMs = 0;
+    for (const Model &model : Models) {
+      const SpectrumParameters params = ModelSpectrum(N, model);
+      const auto res = Measure(
+          [&] { DoNotOptimize(CalculateTildeh0(params)); }, iterations, 1);
+      Print((std::string(model.name) + size).c_str(), res);
+      if (model.spectrum == SpectrumType::Phillips)
+        phillipsMs = res.minMs;
+      else
+        std::printf("  %.2fx the time of Phillips, %.2fx of sequential "
+                    "Phillips\n",
+                    res.minMs / phillipsMs, res.minMs / sequential.minMs);
+    }
+  }
+  std::printf("\n");
+}
+} // namespace
+
+int main() {
+  ThreadPool pool;
+  Validate(pool);
+  ValidateModels();
+  BenchmarkModels();
+
+  std::printf("Single thread unless noted, %u threads in the pool\n",
+              pool.GetConcurrency());
+  for (u32 N : {256u, 512u, 1024u}) {
+    const SpectrumParameters params = DefaultSpectrum(N);
+    const std::string size = " N=" + std::to_string(N);
+
+    const auto sequential =
+        Measure([&] { DoNotOptimize(SequentialTildeh0(params)); }, 5);
+    Print(("Sequential tilde_h0" + size).c_str(), sequential);
+    const auto tildeh0 =
+        Measure([&] { DoNotOptimize(CalculateTildeh0(params)); }, 5);
+    Print(("CalculateTildeh0" + size).c_str(), tildeh0);
+    const auto tildeh0Pool =
+        Measure([&] { DoNotOptimize(CalculateTildeh0(params, &pool)); }, 5);
+    Print(("CalculateTildeh0 pool" + size).c_str(), tildeh0Pool);
+
+    const auto sequentialFreq =
+        Measure([&] { DoNotOptimize(SequentialFrequencies(params)); }, 5);
+    Print(("Sequential frequencies" + size).c_str(), sequentialFreq);
+    const auto freq =
+        Measure([&] { DoNotOptimize(CalculateFrequencies(params)); }, 5);
+    Print(("CalculateFrequencies" + size).c_str(), freq);
+
+    const auto half =
+        Measure([&] { DoNotOptimize(CalculateHalfSpectrum(params)); }, 5);
+    Print(("CalculateHalfSpectrum" + size).c_str(), half);
+    const auto halfPool = Measure(
+        [&] { DoNotOptimize(CalculateHalfSpectrum(params, &pool)); }, 5);
+    Print(("CalculateHalfSpectrum pool" + size).c_str(), halfPool);
+    std::printf("  tilde_h0 speedup %.1fx single thread, frequencies %.1fx\n",
+                sequential.minMs / tildeh0.minMs,
+                sequentialFreq.minMs / freq.minMs);
+  }
+  return 0;
+}
@@ -0,0 +1,225 @@
+#include "Ocean/Memory/UploadQueue.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include "Benchmark.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+// Frames until the copies recorded in a frame are done.
+constexpr u32 CopyLatency = 3;
+// Placement alignment of a resource of its own, what each upload takes in
+// the staging heap of ResourceUploader.
+constexpr u64 PlacementAlignment = 64 * 1024;
+
+UploadMemoryFactory HostMemory() {
+  return [base = u64(1) << 40](u64 size) mutable {
+    base += u64(1) << 32;
+    return std::make_unique<HostUploadMemory>(size, base);
+  };
+}
+
+// What gets loaded while the app runs: meshes and constant buffers, the
+// spectrum textures regenerated now and then and once a skybox.
+struct Upload {
+  u64 size;
+  UploadPriority priority;
+};
+
+class Workload {
+public:
+  std::vector<Upload> Next(u32 frame) {
+    std::vector<Upload> res;
+    const u32 small = frame < 30 ? 200 : random() % 8;
+    for (u32 i = 0; i < small; ++i)
+      res.push_back({256 + random() % (64 * 1024), UploadPriority::Normal});
+    if (frame % 45 == 10)
+      for (u64 size : {512 * 512 * 8, 512 * 512 * 4})
+        res.push_back({(u64)size, UploadPriority::High});
+    if (frame == 20)
+      res.push_back({6 * 1024 * 1024 * 16, UploadPriority::Low});
+    return res;
+  }
+
+private:
+  std::mt19937 random{11};
+};
+
+struct Recorded {
+  const u8 *data;
+  u64 size;
+  u8 pattern;
+};
+
+struct Latency {
+  u64 frames = 0;
+  u32 count = 0;
+  u32 worst = 0;
+};
+
+// Frames of uploads through a staging memory smaller than what a burst of
+// them needs. The staging memory of each recorded upload is checked when
+// its copy completes, before it is released.
+void Simulate(u64 budget) {
+  constexpr u64 Capacity = 64 << 20;
+  UploadQueue queue(HostMemory(), 4 << 20, Capacity);
+  Workload workload;
+  struct Pending {
+    std::future<void> done;
+    u32 frame;
+    UploadPriority priority;
+    u64 placed;
+  };
+  std::vector<Pending> pending;
+  std::array<std::vector<Recorded>, CopyLatency> recorded;
+  std::array<u64, CopyLatency> batches{};
+  std::array<Latency, UploadQueue::PriorityCount> latency;
+  u32 corrupted = 0, id = 0;
+  u64 placedLive = 0, placedPeak = 0;
+  u32 placedBlocked = 0;
+  f64 utilization = 0, worstEnqueueUs = 0;
+  u32 frame = 0, utilizationFrames = 0;
+  constexpr u32 Frames = 600;
+  for (; frame < Frames || !pending.empty(); ++frame) {
+    const u32 slot = frame % recorded.size();
+    for (const Recorded &r : recorded[slot])
+      for (u64 i = 0; i < r.size; i += 61)
+        corrupted += r.data[i] != r.pattern;
+    recorded[slot].clear();
+    if (batches[slot])
+      queue.Complete(batches[slot]);
+
+    std::erase_if(pending, [&](Pending &p) {
+      if (p.done.wait_for(std::chrono::seconds(0)) !=
+          std::future_status::ready)
+        return false;
+      Latency &l = latency[(u32)p.priority];
+      l.frames += frame - p.frame;
+      l.worst = std::max(l.worst, frame - p.frame);
+      ++l.count;
+      placedLive -= p.placed;
+      return true;
+    });
+
+    if (frame < Frames)
+      for (const Upload &upload : workload.Next(frame)) {
+        const u8 pattern = (u8)++id;
+        // Only the sampled bytes are written, the rest is not checked.
+        UploadQueue::Task task{
+            .size = upload.size,
+            .alignment = upload.size > 64 * 1024 ? 512u : 256u,
+            .priority = upload.priority,
+            .write =
+                [pattern, size = upload.size](
+                    const UploadQueue::Staging &staging) {
+                  for (u64 i = 0; i < size; i += 61)
+                    staging.data[i] = pattern;
+                },
+            .record =
+                [&recorded, slot, pattern,
+                 size = upload.size](const UploadQueue::Staging &staging,
+                                     const std::any &) {
+                  recorded[slot].push_back({staging.data, size, pattern});
+                }};
+        // A placed resource of ResourceUploader, which blocks the
+        // producer when its heap is full.
+        const u64 placed =
+            (upload.size + PlacementAlignment - 1) & ~(PlacementAlignment - 1);
+        placedBlocked += placedLive + placed > Capacity;
+        placedLive += placed;
+        placedPeak = std::max(placedPeak, placedLive);
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        pending.push_back(
+            {queue.Enqueue(std::move(task)), frame, upload.priority, placed});
+        worstEnqueueUs = std::max(
+            worstEnqueueUs, std::chrono::duration<f64, std::micro>(
+                                std::chrono::high_resolution_clock::now() -
+                                start)
+                                .count());
+      }
+    batches[slot] = queue.Drain(budget);
+
+    const auto stats = queue.GetStatistics();
+    if (stats.consumedBytes > 0 && frame < Frames) {
+      utilization += (f64)stats.liveBytes / stats.consumedBytes;
+      ++utilizationFrames;
+    }
+  }
+
+  const auto stats = queue.GetStatistics();
+  std::printf("Budget %llu MB per frame: %u uploads done in %u frames, "
+              "%u corrupted, %u waited for staging memory\n",
+              (unsigned long long)budget >> 20, id, frame, corrupted,
+              stats.deferred);
+  const char *names[] = {"high", "normal", "low"};
+  for (u32 p = 0; p < UploadQueue::PriorityCount; ++p)
+    std::printf("  %-6s priority: %5u uploads, mean latency %.2f frames, "
+                "worst %u\n",
+                names[p], latency[p].count,
+                (f64)latency[p].frames / std::max(latency[p].count, 1u),
+                latency[p].worst);
+  std::printf("  staging peak %llu MB, %.1f%% of the used page bytes live, "
+              "worst Enqueue %.1f us\n",
+              (unsigned long long)stats.peakReservedBytes >> 20,
+              100.0 * utilization / std::max(utilizationFrames, 1u),
+              worstEnqueueUs);
+  std::printf("  a placed resource per upload: %llu MB peak, %u blocking "
+              "Enqueues\n\n",
+              (unsigned long long)placedPeak >> 20, placedBlocked);
+}
+
+// Producers enqueueing small uploads from threads while one thread drains
+// and completes them at once, copying them out of the staging memory.
+void Throughput() {
+  constexpr u32 Producers = 4;
+  constexpr u32 PerProducer = 20000;
+  u64 copied = 0;
+  const auto res = Measure(
+      [&] {
+        UploadQueue queue(HostMemory(), 4 << 20, 64 << 20);
+        std::vector<std::thread> producers;
+        std::atomic<u32> finished = 0;
+        for (u32 t = 0; t < Producers; ++t)
+          producers.emplace_back([&queue, &finished, t] {
+            std::mt19937 random(t);
+            for (u32 i = 0; i < PerProducer; ++i) {
+              const u64 size = 256 + random() % 16384;
+              queue.Enqueue(
+                  {.size = size,
+                   .write =
+                       [size](const UploadQueue::Staging &staging) {
+                         std::memset(staging.data, 1, size);
+                       },
+                   .record = [](const UploadQueue::Staging &,
+                                const std::any &) {}});
+            }
+            ++finished;
+          });
+        while (finished < Producers ||
+               queue.GetStatistics().ready + queue.GetStatistics().waiting) {
+          const u64 batch = queue.Drain(8 << 20);
+          if (batch)
+            queue.Complete(batch);
+        }
+        for (auto &producer : producers)
+          producer.join();
+        copied = queue.GetStatistics().drainedBytes;
+      },
+      5, 1);
+  Print("UploadQueue, 4 producers, small uploads", res);
+  std::printf("  %.1f M uploads/s, %.2f GB/s staged\n",
+              Producers * PerProducer / res.minMs / 1e3,
+              (f64)copied / res.minMs / 1e6);
+}
+} // namespace
+
+int main() {
+  for (u64 budget : {u64(0), u64(4) << 20, u64(1) << 20})
+    Simulate(budget);
+  Throughput();
+  return 0;
+}
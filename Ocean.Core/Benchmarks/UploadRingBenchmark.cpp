@@ -0,0 +1,145 @@
+#include "Ocean/Memory/UploadRing.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include "Benchmark.h"
+
+using namespace Ocean;
+using namespace Ocean::Benchmarks;
+
+namespace {
+// Frames recorded while the GPU is busy with the previous ones, as with
+// the two FrameResources of the app.
+constexpr u32 FramesInFlight = 2;
+
+UploadMemoryFactory HostMemory() {
+  return [base = u64(1) << 40](u64 size) mutable {
+    base += u64(1) << 32;
+    return std::make_unique<HostUploadMemory>(size, base);
+  };
+}
+
+struct Written {
+  const u8 *data;
+  u64 size;
+  u8 pattern;
+};
+
+// Frames of random constants and instance streams, some of them far
+// larger than the rest. The data of a frame is checked when its fence
+// completes, before it is retired: nothing written later may have reused
+// its space.
+void Validate() {
+  std::mt19937 random(7);
+  UploadRing ring(HostMemory(), 64 * 1024);
+  std::vector<std::vector<Written>> inFlight(FramesInFlight);
+  u32 corrupted = 0, misaligned = 0, checked = 0;
+  constexpr u32 Frames = 5000;
+  for (u32 frame = 0; frame < Frames; ++frame) {
+    std::vector<Written> &written = inFlight[frame % FramesInFlight];
+    for (const Written &w : written) {
+      for (u64 i = 0; i < w.size; ++i)
+        corrupted += w.data[i] != w.pattern;
+      ++checked;
+    }
+    written.clear();
+    if (frame >= FramesInFlight)
+      ring.Retire(frame - FramesInFlight + 1);
+
+    const bool spike = frame % 997 == 500;
+    const u32 count = 8 + random() % 32;
+    for (u32 i = 0; i < count; ++i) {
+      const u64 size = spike && i == 0 ? 300 * 1024 : 16 + random() % 8192;
+      const u64 alignment = u64(1) << (4 + random() % 5);
+      const auto allocation = ring.Allocate(size, alignment);
+      misaligned += allocation.gpuAddress % alignment != 0;
+      const u8 pattern = (u8)(frame * 31 + i);
+      std::memset(allocation.data, pattern, size);
+      written.push_back({allocation.data, size, pattern});
+    }
+    ring.EndFrame(frame + 1);
+  }
+  const auto &stats = ring.GetStatistics();
+  std::printf("Validated %u allocations over %u frames: %u corrupted bytes, "
+              "%u misaligned\n",
+              checked, Frames, corrupted, misaligned);
+  std::printf("  capacity %llu KB after %u grows, peak in flight %llu KB\n\n",
+              (unsigned long long)stats.capacity / 1024, stats.grows,
+              (unsigned long long)stats.peakInFlight / 1024);
+}
+
+// The constants of one frame of the app: the shared buffers, a model
+// matrix per pass and the packed instance stream.
+struct FrameData {
+  std::vector<std::vector<u8>> buffers;
+
+  FrameData() {
+    for (u64 size : {448, 160, 64, 48, 64, 160})
+      buffers.emplace_back(size, (u8)size);
+    buffers.emplace_back(640 * 8, 1);
+  }
+};
+
+// What DynamicBufferManager does: the buffers are copied into a write
+// buffer, then the whole block into the mapped upload buffer, which the
+// GPU copies again into a default buffer.
+struct StagedUpload {
+  std::vector<u8> writeBuffer = std::vector<u8>(1 << 20);
+  std::vector<u8> uploadBuffer = std::vector<u8>(1 << 20);
+  u64 position = 0;
+
+  u64 Add(std::span<const u8> bytes) {
+    std::memcpy(writeBuffer.data() + position, bytes.data(), bytes.size());
+    const u64 address = position;
+    position += (bytes.size() + 255) & ~u64(255);
+    return address;
+  }
+
+  void Upload(bool wholeBlock) {
+    std::memcpy(uploadBuffer.data(), writeBuffer.data(),
+                wholeBlock ? writeBuffer.size() : position);
+    position = 0;
+  }
+};
+} // namespace
+
+int main() {
+  Validate();
+
+  const FrameData frame;
+  constexpr u32 Frames = 1000;
+  StagedUpload staged;
+  for (bool wholeBlock : {true, false}) {
+    const auto res = Measure(
+        [&] {
+          for (u32 i = 0; i < Frames; ++i) {
+            for (const auto &buffer : frame.buffers)
+              DoNotOptimize(staged.Add(buffer));
+            staged.Upload(wholeBlock);
+          }
+        },
+        20, 2);
+    Print(wholeBlock ? "Staged, whole block copied" : "Staged, written part",
+          res);
+    std::printf("  %.3f us per frame\n", res.minMs * 1e3 / Frames);
+  }
+
+  UploadRing ring(HostMemory());
+  u64 fence = 0;
+  const auto ringRes = Measure(
+      [&] {
+        for (u32 i = 0; i < Frames; ++i) {
+          for (const auto &buffer : frame.buffers)
+            DoNotOptimize(ring.Write(buffer));
+          ring.EndFrame(++fence);
+          if (fence > FramesInFlight)
+            ring.Retire(fence - FramesInFlight);
+        }
+      },
+      20, 2);
+  Print("UploadRing, written in place", ringRes);
+  std::printf("  %.3f us per frame, no GPU copy, capacity %llu KB\n",
+              ringRes.minMs * 1e3 / Frames,
+              (unsigned long long)ring.GetStatistics().capacity / 1024);
+  return 0;
+}
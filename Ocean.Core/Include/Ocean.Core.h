@@ -0,0 +1,19 @@
+#pragma once
+#include "../Ocean/Typedefs.h"
+#include "../Ocean/Math/Vector.h"
+#include "../Ocean/Culling/Frustum.h"
+#include "../Ocean/Culling/FrustumCuller.h"
+#include "../Ocean/Culling/CameraPredictor.h"
+#include "../Ocean/Spectrum/Random.h"
+#include "../Ocean/Spectrum/Spectrum.h"
+#include "../Ocean/QuadTree/QuadTree.h"
+#include "../Ocean/QuadTree/OceanQuads.h"
+#include "../Ocean/Memory/AlignedVector.h"
+#include "../Ocean/Memory/ConstantCache.h"
+#include "../Ocean/Memory/UploadQueue.h"
+#include "../Ocean/Memory/UploadRing.h"
+#include "../Ocean/Threading/ThreadPool.h"
+#include "../Ocean/Fft/Fft.h"
+#include "../Ocean/Simulation/CpuSimulation.h"
+#include "../Ocean/Simulation/PhaseEvolution.h"
+#include "../Ocean/Simulation/CascadeScheduler.h"
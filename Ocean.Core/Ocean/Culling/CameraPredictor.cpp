@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "CameraPredictor.h"
+
+namespace Ocean {
+namespace {
+constexpr f32 Epsilon = 1e-6f;
+
+// Rodrigues: v turned around the axis of rotation by its length.
+float3 Rotate(const float3 &v, const float3 &rotation) {
+  const f32 angle = length(rotation);
+  if (angle < Epsilon)
+    return v;
+  const float3 axis = rotation / angle;
+  const f32 c = std::cos(angle), s = std::sin(angle);
+  return v * c + cross(axis, v) * s + axis * (dot(axis, v) * (1 - c));
+}
+} // namespace
+
+std::array<float3, 8> CameraPose::GetCorners() const {
+  std::array<float3, 8> corners;
+  const f32 tanY = std::tan(fovY / 2), tanX = tanY * aspect;
+  u32 i = 0;
+  for (f32 distance : {zNear, zFar})
+    for (f32 x : {-1.f, 1.f})
+      for (f32 y : {-1.f, 1.f})
+        corners[i++] = eye + forward * distance +
+                       right * (x * tanX * distance) +
+                       up * (y * tanY * distance);
+  return corners;
+}
+
+void CameraPredictor::Observe(const CameraPose &pose, f32 deltaTime) {
+  if (observed && deltaTime > 0) {
+    velocity = (pose.eye - last.eye) / deltaTime;
+    const float3 axis = cross(last.forward, pose.forward);
+    const f32 sine = length(axis);
+    spin = sine < Epsilon ? float3(0, 0, 0)
+                          : axis / sine *
+                                (std::atan2(sine, dot(last.forward,
+                                                      pose.forward)) /
+                                 deltaTime);
+  }
+  last = pose;
+  observed = true;
+}
+
+bool CameraPredictor::IsStationary() const {
+  return dot(velocity, velocity) == 0 && dot(spin, spin) == 0;
+}
+
+CameraPredictor::Prediction CameraPredictor::Predict(f32 deltaTime) const {
+  Prediction res;
+  res.pose = last;
+  const float3 turn = spin * deltaTime;
+  res.pose.eye += velocity * deltaTime;
+  res.pose.forward = normalize(Rotate(last.forward, turn));
+  res.pose.right = normalize(Rotate(last.right, turn));
+  res.pose.up = normalize(Rotate(last.up, turn));
+  res.eyeTolerance =
+      margins.eye + margins.motion * length(velocity) * deltaTime;
+  res.angleTolerance = margins.angle + margins.motion * length(turn);
+
+  // Every side turned out by the angle, then every plane moved back by the
+  // eye tolerance.
+  constexpr f32 MaxHalfAngle = 1.5f;
+  const f32 halfY = last.fovY / 2;
+  const f32 halfX = std::atan(std::tan(halfY) * last.aspect);
+  const f32 grownY = std::min(halfY + res.angleTolerance, MaxHalfAngle);
+  const f32 grownX = std::min(halfX + res.angleTolerance, MaxHalfAngle);
+  CameraPose grown = res.pose;
+  grown.fovY = 2 * grownY;
+  grown.aspect = std::tan(grownX) / std::tan(grownY);
+  res.frustum = grown.GetFrustum();
+  for (Plane *plane :
+       {&res.frustum.topFace, &res.frustum.bottomFace, &res.frustum.rightFace,
+        &res.frustum.leftFace, &res.frustum.farFace, &res.frustum.nearFace})
+    plane->distance -= res.eyeTolerance;
+  return res;
+}
+
+bool CameraPredictor::Covers(const Prediction &prediction,
+                             const CameraPose &pose) {
+  // The frusta are convex, the corners inside put the whole one inside.
+  constexpr f32 Slack = 1e-4f;
+  if (length(pose.eye - prediction.pose.eye) > prediction.eyeTolerance)
+    return false;
+  const Frustum &f = prediction.frustum;
+  for (const float3 &corner : pose.GetCorners())
+    for (const Plane *plane : {&f.topFace, &f.bottomFace, &f.rightFace,
+                               &f.leftFace, &f.farFace, &f.nearFace})
+      if (plane->getSignedDistanceToPlane(corner) <
+          -Slack * (1 + length(corner - pose.eye)))
+        return false;
+  return true;
+}
+} // namespace Ocean
@@ -0,0 +1,71 @@
+#pragma once
+#include <array>
+#include "Frustum.h"
+
+namespace Ocean {
+// A perspective camera as the culling sees it. forward, right and up must be
+// an orthonormal basis.
+struct CameraPose {
+  float3 eye = {0, 0, 0};
+  float3 forward = {0, 0, -1};
+  float3 right = {1, 0, 0};
+  float3 up = {0, 1, 0};
+  f32 fovY = 0.5f;
+  f32 aspect = 1.f;
+  f32 zNear = 0.1f;
+  f32 zFar = 1000.f;
+
+  Frustum GetFrustum() const {
+    return MakeFrustum(eye, forward, right, up, fovY, aspect, zNear, zFar);
+  }
+  // The corners of the near and of the far face.
+  std::array<float3, 8> GetCorners() const;
+};
+
+// Extrapolates the camera a frame ahead from its last two poses, so the LOD
+// of the next frame can be built while this one is recorded. The frustum of
+// the prediction is grown by a margin. When the camera of the next frame
+// ends up inside it, the LOD built for the prediction culls nothing that
+// camera sees, and its distances are off by at most eyeTolerance.
+class CameraPredictor {
+public:
+  struct Margins {
+    // Always allowed, in world units and radians.
+    f32 eye = 0.05f;
+    f32 angle = 0.005f;
+    // Share of the motion of the last frame allowed on top.
+    f32 motion = 0.5f;
+  };
+
+  struct Prediction {
+    CameraPose pose;
+    // The frustum of the pose grown by the tolerances.
+    Frustum frustum;
+    f32 eyeTolerance;
+    f32 angleTolerance;
+  };
+
+  CameraPredictor() = default;
+  explicit CameraPredictor(const Margins &margins) : margins(margins) {}
+
+  // The pose of a frame, deltaTime seconds after the previous one.
+  void Observe(const CameraPose &pose, f32 deltaTime);
+  // The pose deltaTime after the last observed one, moving and turning as
+  // in the last frame.
+  Prediction Predict(f32 deltaTime) const;
+  // Whether the camera neither moved nor turned in the last frame. Its
+  // prediction is the last pose then, and the LOD of that is already built.
+  bool IsStationary() const;
+  // Whether the LOD built for the prediction is good for the pose: the eye
+  // is within the tolerance and the frustum inside the grown one.
+  static bool Covers(const Prediction &prediction, const CameraPose &pose);
+
+private:
+  Margins margins;
+  CameraPose last;
+  bool observed = false;
+  float3 velocity = {0, 0, 0};
+  // Turn per second, the axis scaled by the angle.
+  float3 spin = {0, 0, 0};
+};
+} // namespace Ocean
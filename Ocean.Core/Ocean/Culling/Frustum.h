@@ -0,0 +1,112 @@
+#pragma once
+#include <cmath>
+#include "../Math/Vector.h"
+
+namespace Ocean {
+struct Plane {
+  // unit vector
+  float3 normal = {0.f, 1.f, 0.f};
+
+  // distance from origin to the nearest point in the plane
+  float distance = 0.f;
+
+  Plane() = default;
+  Plane(const float3 &p1, const float3 &norm)
+      : normal(normalize(norm)), distance(dot(normal, p1)) {}
+
+  float getSignedDistanceToPlane(const float3 &point) const {
+    return dot(normal, point) - distance;
+  }
+};
+
+struct Frustum {
+  Plane topFace;
+  Plane bottomFace;
+
+  Plane rightFace;
+  Plane leftFace;
+
+  Plane farFace;
+  Plane nearFace;
+};
+
+struct Volume {
+  virtual bool isOnFrustum(const Frustum &camFrustum,
+                           const float4x4 &mMatrix) const = 0;
+};
+
+struct AABB : public Volume {
+  // This is padded due to vtable. Cool
+  float3 center{0.f, 0.f, 0.f};
+  float3 extents{0.f, 0.f, 0.f};
+
+  AABB(const float3 &min, const float3 &max)
+      : Volume{}, center{(max + min) * 0.5f},
+        extents{max.x - center.x, max.y - center.y, max.z - center.z} {}
+
+  AABB(const float3 &inCenter, float iI, float iJ, float iK)
+      : Volume{}, center{inCenter}, extents{iI, iJ, iK} {}
+
+  bool isOnOrForwardPlane(const Plane &plane) const {
+    // Compute the projection interval radius of b onto L(t) = b.c + t * p.n
+    const float r = extents.x * std::abs(plane.normal.x) +
+                    extents.y * std::abs(plane.normal.y) +
+                    extents.z * std::abs(plane.normal.z);
+
+    return -r <= plane.getSignedDistanceToPlane(center);
+  }
+
+  // The box transformed by mMatrix, still axis aligned.
+  AABB getGlobal(const float4x4 &mMatrix) const {
+    // Get global scale thanks to our transform
+
+    const float3 globalCenter = TransformCoord(center, mMatrix);
+
+    // Scaled orientation
+
+    const float3 right = normalize(mMatrix.Row3(0)) * extents.x;
+    const float3 up = normalize(mMatrix.Row3(1)) * extents.y;
+    const float3 forward = normalize(mMatrix.Row3(2)) * extents.z;
+
+    const float newIi = std::abs(right.x) + std::abs(up.x) + std::abs(forward.x);
+    const float newIj = std::abs(right.y) + std::abs(up.y) + std::abs(forward.y);
+    const float newIk = std::abs(right.z) + std::abs(up.z) + std::abs(forward.z);
+
+    // We not need to divise scale because it's based on the half extention of
+    // the AABB
+    return AABB(globalCenter, newIi, newIj, newIk);
+  }
+
+  bool isOnFrustum(const Frustum &camFrustum,
+                   const float4x4 &mMatrix) const final {
+    const AABB globalAABB = getGlobal(mMatrix);
+
+    return (globalAABB.isOnOrForwardPlane(camFrustum.leftFace) &&
+            globalAABB.isOnOrForwardPlane(camFrustum.rightFace) &&
+            globalAABB.isOnOrForwardPlane(camFrustum.topFace) &&
+            globalAABB.isOnOrForwardPlane(camFrustum.bottomFace) &&
+            globalAABB.isOnOrForwardPlane(camFrustum.nearFace) &&
+            globalAABB.isOnOrForwardPlane(camFrustum.farFace));
+  };
+};
+
+// Builds the six planes of a perspective camera. forward, right and up must
+// be an orthonormal basis.
+inline Frustum MakeFrustum(const float3 &eye, const float3 &forward,
+                           const float3 &right, const float3 &up, f32 fovY,
+                           f32 aspect, f32 zNear, f32 zFar) {
+  Frustum frustum{};
+  const float halfVSide = zFar * std::tan(fovY * .5f);
+  const float halfHSide = halfVSide * aspect;
+  const float3 frontMultFar = zFar * forward;
+
+  frustum.nearFace = {eye + zNear * forward, forward};
+  frustum.farFace = {eye + frontMultFar, -forward};
+  frustum.rightFace = {eye, cross(frontMultFar - right * halfHSide, up)};
+  frustum.leftFace = {eye, cross(up, frontMultFar + right * halfHSide)};
+  frustum.topFace = {eye, cross(right, frontMultFar - up * halfVSide)};
+  frustum.bottomFace = {eye, cross(frontMultFar + up * halfVSide, right)};
+
+  return frustum;
+}
+} // namespace Ocean
@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "FrustumCuller.h"
+#include "../Simd/Simd.h"
+#include <limits>
+
+namespace Ocean {
+namespace {
+using namespace Simd;
+
+constexpr std::array<Plane Frustum::*, FrustumCuller::PlaneCount> Faces = {
+    &Frustum::leftFace,  &Frustum::rightFace, &Frustum::topFace,
+    &Frustum::bottomFace, &Frustum::nearFace, &Frustum::farFace};
+
+// One vector of boxes. The plane masks are summed as floats, they are small
+// integers.
+template <typename V>
+void TestBoxes(const std::array<f32, FrustumCuller::PlaneCount> &normalX,
+               const std::array<f32, FrustumCuller::PlaneCount> &normalY,
+               const std::array<f32, FrustumCuller::PlaneCount> &normalZ,
+               const std::array<f32, FrustumCuller::PlaneCount> &distance,
+               const FrustumCuller::Boxes &boxes, u32 i, u32 count,
+               FrustumCuller::PlaneMask skip,
+               FrustumCuller::Visibility *out) {
+  const V cx = V::Load(boxes.centerX + i);
+  const V cy = V::Load(boxes.centerY + i);
+  const V cz = V::Load(boxes.centerZ + i);
+  const V ex = V::Load(boxes.extentX + i);
+  const V ey = V::Load(boxes.extentY + i);
+  const V ez = V::Load(boxes.extentZ + i);
+
+  V front = V::Broadcast(std::numeric_limits<f32>::max());
+  V margin = front;
+  V inside = V::Broadcast((f32)skip);
+  for (u32 p = 0; p < FrustumCuller::PlaneCount; ++p) {
+    if (skip & (1u << p))
+      continue;
+    const V nx = V::Broadcast(normalX[p]);
+    const V ny = V::Broadcast(normalY[p]);
+    const V nz = V::Broadcast(normalZ[p]);
+    const V distanceToCenter = MulAdd(
+        nx, cx, MulAdd(ny, cy, MulAdd(nz, cz, V::Broadcast(-distance[p]))));
+    const V radius = MulAdd(Abs(nx), ex, MulAdd(Abs(ny), ey, Abs(nz) * ez));
+    const V nearest = distanceToCenter - radius;
+    const V farthest = distanceToCenter + radius;
+    const auto entirely = CmpGe(nearest, V::Zero());
+    front = Min(front, farthest);
+    margin = Min(margin, Select(entirely, nearest, Abs(farthest)));
+    inside = inside + Select(entirely, V::Broadcast((f32)(1u << p)), V::Zero());
+  }
+
+  // A culled box stays culled while it is behind the plane it is farthest
+  // behind, whatever the other planes do.
+  const auto visible = CmpGe(front, V::Zero());
+  margin = Select(visible, margin, -front);
+
+  f32 frontLanes[V::Width], marginLanes[V::Width], insideLanes[V::Width];
+  front.Store(frontLanes);
+  margin.Store(marginLanes);
+  inside.Store(insideLanes);
+  for (u32 l = 0; l < std::min(V::Width, count - i); ++l)
+    out[i + l] = {frontLanes[l] >= 0, (FrustumCuller::PlaneMask)insideLanes[l],
+                  marginLanes[l]};
+}
+} // namespace
+
+// With p the model space point and M = [R; t], the world point is p R + t
+// and n * (p R + t) - d = (R n) * p - (d - n * t).
+FrustumCuller::FrustumCuller(const Frustum &f, const float4x4 &mMatrix) {
+  const float3 translation = mMatrix.Row3(3);
+  for (u32 p = 0; p < PlaneCount; ++p) {
+    const Plane &plane = f.*Faces[p];
+    normalX[p] = dot(mMatrix.Row3(0), plane.normal);
+    normalY[p] = dot(mMatrix.Row3(1), plane.normal);
+    normalZ[p] = dot(mMatrix.Row3(2), plane.normal);
+    distance[p] = plane.distance - dot(plane.normal, translation);
+  }
+}
+
+void FrustumCuller::Test(const Boxes &boxes, u32 count, PlaneMask skip,
+                         Visibility *out) const {
+  for (u32 i = 0; i < count; i += f32v::Width)
+    TestBoxes<f32v>(normalX, normalY, normalZ, distance, boxes, i, count,
+                    skip, out);
+}
+
+FrustumCuller::Visibility FrustumCuller::Test(const float3 &center,
+                                              const float3 &extents,
+                                              PlaneMask skip) const {
+  const Boxes box = {&center.x,  &center.y,  &center.z,
+                     &extents.x, &extents.y, &extents.z};
+  Visibility res;
+  TestBoxes<f32x1>(normalX, normalY, normalZ, distance, box, 0, 1, skip,
+                   &res);
+  return res;
+}
+} // namespace Ocean
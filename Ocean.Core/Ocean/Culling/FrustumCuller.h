@@ -0,0 +1,64 @@
+#pragma once
+#include <array>
+#include "Frustum.h"
+
+namespace Ocean {
+// The planes of a Frustum moved into the model space of the boxes to cull
+// once, then tested against blocks of boxes in SoA form.
+//
+// A box is visible when it is on or in front of every plane, as with
+// AABB::isOnFrustum. The signed distances are the same in both spaces and
+// the radius is that of the transformed box, so both agree for rigid
+// transforms up to rounding. The test also reports the planes a box is
+// entirely in front of: everything inside the box is in front of them too,
+// so the children of the box skip them, and a box in front of every plane
+// needs no test at all.
+class FrustumCuller {
+public:
+  static constexpr u32 PlaneCount = 6;
+  // The boxes are read and the results written in whole blocks.
+  static constexpr u32 BlockSize = 8;
+
+  // Bit p for plane p: left, right, top, bottom, near, far.
+  using PlaneMask = u8;
+  static constexpr PlaneMask AllPlanes = (1u << PlaneCount) - 1;
+
+  // Model space centers and half extents, count rounded up to BlockSize
+  // elements each.
+  struct Boxes {
+    const f32 *centerX;
+    const f32 *centerY;
+    const f32 *centerZ;
+    const f32 *extentX;
+    const f32 *extentY;
+    const f32 *extentZ;
+  };
+
+  struct Visibility {
+    bool visible;
+    // Planes the box is entirely in front of, the skipped ones included.
+    PlaneMask inside;
+    // How far the tested planes may move, in world units, before a visible
+    // box is culled or stops being in front of one of them, or a culled box
+    // becomes visible.
+    f32 margin;
+  };
+
+  FrustumCuller() = default;
+  FrustumCuller(const Frustum &f, const float4x4 &mMatrix);
+
+  // Tests count boxes against the planes not in skip, the ones all of them
+  // are known to be in front of. out holds count rounded up to BlockSize.
+  void Test(const Boxes &boxes, u32 count, PlaneMask skip,
+            Visibility *out) const;
+  Visibility Test(const float3 &center, const float3 &extents,
+                  PlaneMask skip = 0) const;
+
+private:
+  // The signed distance of a point is n * p - d in both spaces.
+  std::array<f32, PlaneCount> normalX{};
+  std::array<f32, PlaneCount> normalY{};
+  std::array<f32, PlaneCount> normalZ{};
+  std::array<f32, PlaneCount> distance{};
+};
+} // namespace Ocean
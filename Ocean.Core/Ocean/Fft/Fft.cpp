@@ -0,0 +1,495 @@
+#include "pch.h"
+#include "Fft.h"
+#include "../Simd/Simd.h"
+#include "../Threading/ThreadPool.h"
+
+using namespace Ocean::Simd;
+
+namespace Ocean {
+namespace {
+// A batch of complex sequences: element m of lane l is at
+// re/im[m * stride + l], so the lanes of an element are contiguous.
+struct BatchView {
+  f32 *re;
+  f32 *im;
+  size_t stride;
+};
+
+template <typename V> struct Complex {
+  V re;
+  V im;
+};
+
+template <typename V>
+inline Complex<V> Load(const BatchView &v, size_t m, u32 lane) {
+  return {V::Load(v.re + m * v.stride + lane),
+          V::Load(v.im + m * v.stride + lane)};
+}
+template <typename V>
+inline void Store(const BatchView &v, size_t m, u32 lane, const Complex<V> &c) {
+  c.re.Store(v.re + m * v.stride + lane);
+  c.im.Store(v.im + m * v.stride + lane);
+}
+
+template <typename V>
+inline Complex<V> operator+(const Complex<V> &a, const Complex<V> &b) {
+  return {a.re + b.re, a.im + b.im};
+}
+template <typename V>
+inline Complex<V> operator-(const Complex<V> &a, const Complex<V> &b) {
+  return {a.re - b.re, a.im - b.im};
+}
+// i * a
+template <typename V> inline Complex<V> MulI(const Complex<V> &a) {
+  return {-a.im, a.re};
+}
+template <typename V>
+inline Complex<V> Mul(const Complex<V> &a, f32 wRe, f32 wIm) {
+  const V wr = V::Broadcast(wRe), wi = V::Broadcast(wIm);
+  return {NegMulAdd(a.im, wi, a.re * wr), MulAdd(a.re, wi, a.im * wr)};
+}
+
+// Runs fn.template operator()<V>(lane) over [0, lanes), full vectors first.
+template <typename Fn> inline void ForEachLane(u32 lanes, Fn &&fn) {
+  u32 lane = 0;
+  for (; lane + f32v::Width <= lanes; lane += f32v::Width)
+    fn.template operator()<f32v>(lane);
+  for (; lane < lanes; ++lane)
+    fn.template operator()<f32x1>(lane);
+}
+
+// One Stockham pass: X[R k + t] of the sub-transforms of length n is
+// written from x[p + r n / R], twiddled by w_n^(p t).
+void Radix2(const BatchView &x, const BatchView &y, const Fft2D::Stage &st,
+            const f32 *twRe, const f32 *twIm, u32 lanes) {
+  const u32 s = st.stride, n2 = st.length / 2;
+  for (u32 p = 0; p < n2; ++p) {
+    const f32 wr = twRe[p], wi = twIm[p];
+    for (u32 q = 0; q < s; ++q) {
+      ForEachLane(lanes, [&]<typename V>(u32 lane) {
+        const auto a = Load<V>(x, q + s * p, lane);
+        const auto b = Load<V>(x, q + s * (p + n2), lane);
+        Store(y, q + s * (2 * p), lane, a + b);
+        Store(y, q + s * (2 * p + 1), lane, Mul(a - b, wr, wi));
+      });
+    }
+  }
+}
+
+void Radix4(const BatchView &x, const BatchView &y, const Fft2D::Stage &st,
+            const f32 *twRe, const f32 *twIm, u32 lanes) {
+  const u32 s = st.stride, n4 = st.length / 4;
+  for (u32 p = 0; p < n4; ++p) {
+    const f32 w1r = twRe[p], w1i = twIm[p];
+    const f32 w2r = twRe[n4 + p], w2i = twIm[n4 + p];
+    const f32 w3r = twRe[2 * n4 + p], w3i = twIm[2 * n4 + p];
+    for (u32 q = 0; q < s; ++q) {
+      ForEachLane(lanes, [&]<typename V>(u32 lane) {
+        const auto a = Load<V>(x, q + s * p, lane);
+        const auto b = Load<V>(x, q + s * (p + n4), lane);
+        const auto c = Load<V>(x, q + s * (p + 2 * n4), lane);
+        const auto d = Load<V>(x, q + s * (p + 3 * n4), lane);
+
+        const auto apc = a + c, amc = a - c;
+        const auto bpd = b + d, jbmd = MulI(b - d);
+
+        const size_t out = q + s * (4 * p);
+        Store(y, out, lane, apc + bpd);
+        Store(y, out + s, lane, Mul(amc + jbmd, w1r, w1i));
+        Store(y, out + 2 * s, lane, Mul(apc - bpd, w2r, w2i));
+        Store(y, out + 3 * s, lane, Mul(amc - jbmd, w3r, w3i));
+      });
+    }
+  }
+}
+
+void Radix8(const BatchView &x, const BatchView &y, const Fft2D::Stage &st,
+            const f32 *twRe, const f32 *twIm, u32 lanes) {
+  const u32 s = st.stride, n8 = st.length / 8;
+  const f32 sqrtHalf = 0.70710678118654752f;
+  for (u32 p = 0; p < n8; ++p) {
+    for (u32 q = 0; q < s; ++q) {
+      ForEachLane(lanes, [&]<typename V>(u32 lane) {
+        Complex<V> v[8];
+        for (u32 r = 0; r < 8; ++r)
+          v[r] = Load<V>(x, q + s * (p + r * n8), lane);
+
+        // Two 4 point transforms of the even and odd inputs.
+        const auto e02 = v[0] + v[4], e13 = v[2] + v[6];
+        const auto eA = v[0] - v[4], eB = MulI(v[2] - v[6]);
+        const Complex<V> E[4] = {e02 + e13, eA + eB, e02 - e13, eA - eB};
+        const auto o02 = v[1] + v[5], o13 = v[3] + v[7];
+        const auto oA = v[1] - v[5], oB = MulI(v[3] - v[7]);
+        Complex<V> O[4] = {o02 + o13, oA + oB, o02 - o13, oA - oB};
+
+        // O[t] *= exp(i pi t / 4)
+        const V h = V::Broadcast(sqrtHalf);
+        O[1] = {(O[1].re - O[1].im) * h, (O[1].re + O[1].im) * h};
+        O[2] = MulI(O[2]);
+        O[3] = {-(O[3].re + O[3].im) * h, (O[3].re - O[3].im) * h};
+
+        const size_t out = q + s * (8 * p);
+        Store(y, out, lane, E[0] + O[0]);
+        for (u32 t = 1; t < 8; ++t) {
+          const auto value = t < 4 ? E[t] + O[t] : E[t - 4] - O[t - 4];
+          const u32 tw = (t - 1) * n8 + p;
+          Store(y, out + t * s, lane, Mul(value, twRe[tw], twIm[tw]));
+        }
+      });
+    }
+  }
+}
+
+// Runs the passes of plan from in to out, which must not alias. a and b are
+// scratch batches of the same shape.
+void RunStages(const Fft2D::Plan &plan, const BatchView &in,
+               const BatchView &out, const BatchView &a, const BatchView &b,
+               u32 lanes) {
+  if (plan.stages.empty()) {
+    for (u32 m = 0; m < plan.length; ++m) {
+      std::copy_n(in.re + m * in.stride, lanes, out.re + m * out.stride);
+      std::copy_n(in.im + m * in.stride, lanes, out.im + m * out.stride);
+    }
+    return;
+  }
+
+  BatchView src = in;
+  for (size_t i = 0; i < plan.stages.size(); ++i) {
+    const auto &stage = plan.stages[i];
+    const bool last = i + 1 == plan.stages.size();
+    const BatchView dst = last ? out : (i % 2 == 0 ? a : b);
+
+    const f32 *wr = plan.twiddleRe.data() + stage.twiddleOffset;
+    const f32 *wi = plan.twiddleIm.data() + stage.twiddleOffset;
+    switch (stage.radix) {
+    case 2:
+      Radix2(src, dst, stage, wr, wi, lanes);
+      break;
+    case 4:
+      Radix4(src, dst, stage, wr, wi, lanes);
+      break;
+    default:
+      Radix8(src, dst, stage, wr, wi, lanes);
+      break;
+    }
+    src = dst;
+  }
+}
+
+Fft2D::Plan MakePlan(u32 length) {
+  u32 log2Length = 0;
+  while ((1u << log2Length) < length)
+    ++log2Length;
+
+  Fft2D::Plan plan;
+  plan.length = length;
+  u32 stride = 1;
+  while (length > 1) {
+    u32 radix = 4;
+    if (length == 2)
+      radix = 2;
+    else if (plan.stages.empty() && log2Length % 2 == 1)
+      radix = 8;
+
+    const Fft2D::Stage stage{.radix = radix,
+                             .length = length,
+                             .stride = stride,
+                             .twiddleOffset = (u32)plan.twiddleRe.size()};
+    const u32 count = length / radix;
+    for (u32 t = 1; t < radix; ++t) {
+      for (u32 p = 0; p < count; ++p) {
+        const f64 theta = 2 * std::numbers::pi * (f64)(p * t) / (f64)length;
+        plan.twiddleRe.push_back((f32)std::cos(theta));
+        plan.twiddleIm.push_back((f32)std::sin(theta));
+      }
+    }
+    plan.stages.push_back(stage);
+    length /= radix;
+    stride *= radix;
+  }
+  return plan;
+}
+
+// Four step transform of lanes sequences of length N1 * N2 from in to out,
+// through tmp. in and tmp may alias, out must not alias either. work holds
+// 6 * max(N1, N2) * lanes floats.
+void Transform(const Fft2D::Plan &outer, const Fft2D::Plan &inner,
+               const f32 *splitRe, const f32 *splitIm, const BatchView &in,
+               const BatchView &tmp, const BatchView &out, f32 *work,
+               u32 lanes) {
+  const u32 n1 = outer.length, n2 = inner.length;
+  const size_t size = (size_t)std::max(n1, n2) * lanes;
+  const BatchView x{work, work + size, lanes};
+  const BatchView a{work + 2 * size, work + 3 * size, lanes};
+  const BatchView b{work + 4 * size, work + 5 * size, lanes};
+
+  // N2 transforms of length N1 over the elements i + N2 j, twiddled by
+  // w_N^(i k) back into the same places.
+  const BatchView &dst = n2 == 1 ? out : tmp;
+  for (u32 i = 0; i < n2; ++i) {
+    const BatchView column{in.re + i * in.stride, in.im + i * in.stride,
+                           n2 * in.stride};
+    RunStages(outer, column, x, a, b, lanes);
+
+    const f32 *wr = splitRe + (size_t)i * n1;
+    const f32 *wi = splitIm + (size_t)i * n1;
+    for (u32 k = 0; k < n1; ++k) {
+      ForEachLane(lanes, [&]<typename V>(u32 lane) {
+        Store(dst, i + (size_t)n2 * k, lane,
+              Mul(Load<V>(x, k, lane), wr[k], wi[k]));
+      });
+    }
+  }
+  if (n2 == 1)
+    return;
+
+  // N1 transforms of length N2 over the contiguous elements N2 k + i, the
+  // result of transform k goes to k + N1 j.
+  for (u32 k = 0; k < n1; ++k) {
+    const BatchView row{tmp.re + (size_t)n2 * k * tmp.stride,
+                        tmp.im + (size_t)n2 * k * tmp.stride, tmp.stride};
+    const BatchView result{out.re + k * out.stride, out.im + k * out.stride,
+                           n1 * out.stride};
+    RunStages(inner, row, result, a, b, lanes);
+  }
+}
+
+// dst[c * dstStride + r] = src[r * srcStride + c] for r < rows,
+// c < columns.
+void Transpose(const f32 *src, size_t srcStride, f32 *dst, size_t dstStride,
+               u32 rows, u32 columns) {
+  constexpr u32 W = f32v::Width;
+  u32 r = 0;
+  for (; r + W <= rows; r += W) {
+    u32 c = 0;
+    for (; c + W <= columns; c += W) {
+      f32v v[W];
+      for (u32 i = 0; i < W; ++i)
+        v[i] = f32v::Load(src + (r + i) * srcStride + c);
+      Simd::Transpose(v);
+      for (u32 i = 0; i < W; ++i)
+        v[i].Store(dst + (c + i) * dstStride + r);
+    }
+    for (; c < columns; ++c)
+      for (u32 i = 0; i < W; ++i)
+        dst[c * dstStride + r + i] = src[(r + i) * srcStride + c];
+  }
+  for (; r < rows; ++r)
+    for (u32 c = 0; c < columns; ++c)
+      dst[c * dstStride + r] = src[r * srcStride + c];
+}
+
+// Per thread buffers, Slot 0 for the row blocks and the sub-transforms.
+template <u32 Slot = 0> AlignedVector<f32> &Scratch(size_t size) {
+  thread_local AlignedVector<f32> scratch;
+  if (scratch.size() < size)
+    scratch.resize(size);
+  return scratch;
+}
+} // namespace
+
+Fft2D::Fft2D(u32 N) : N(N) {
+  u32 log2N = 0;
+  while ((1u << log2N) < N)
+    ++log2N;
+
+  // Sizes up to 64 fit the L1 cache in one piece, larger ones are split
+  // with N1 >= N2.
+  const u32 log2N1 = log2N <= 6 ? log2N : (log2N + 1) / 2;
+  outer = MakePlan(1u << log2N1);
+  inner = MakePlan(N >> log2N1);
+
+  const u32 n1 = outer.length, n2 = inner.length;
+  splitTwiddleRe.resize((size_t)n1 * n2);
+  splitTwiddleIm.resize((size_t)n1 * n2);
+  for (u32 i = 0; i < n2; ++i)
+    for (u32 k = 0; k < n1; ++k) {
+      const f64 theta = 2 * std::numbers::pi * (f64)(i * k) / (f64)N;
+      splitTwiddleRe[(size_t)i * n1 + k] = (f32)std::cos(theta);
+      splitTwiddleIm[(size_t)i * n1 + k] = (f32)std::sin(theta);
+    }
+
+  // Keeps the three sub-transform batches (6 * N1 * stripWidth floats)
+  // around 24KB.
+  stripWidth = std::min(N, std::clamp(1024u / n1, 8u, 32u));
+}
+
+f64 Fft2D::FlopCount(u32 N) {
+  return 2.0 * N * 5.0 * N * std::log2((f64)N);
+}
+
+void Fft2D::InverseRows(const Field &field, u32 rowBegin, u32 rowEnd) const {
+  const u32 width = GetBlockWidth();
+  const size_t batch = (size_t)N * width;
+  const size_t work = 6 * (size_t)std::max(outer.length, inner.length) * width;
+  f32 *scratch = Scratch(4 * batch + work).data();
+
+  const size_t rowSize = field.pitch ? field.pitch : N;
+  for (u32 row = rowBegin; row < rowEnd; row += width) {
+    const u32 lanes = std::min(width, rowEnd - row);
+    const BatchView block{scratch, scratch + batch, lanes};
+    const BatchView result{scratch + 2 * batch, scratch + 3 * batch, lanes};
+
+    // Rows become lanes and back.
+    f32 *re = field.re + row * rowSize;
+    f32 *im = field.im + row * rowSize;
+    Transpose(re, rowSize, block.re, lanes, lanes, N);
+    Transpose(im, rowSize, block.im, lanes, lanes, N);
+    Transform(outer, inner, splitTwiddleRe.data(), splitTwiddleIm.data(),
+              block, block, result, scratch + 4 * batch, lanes);
+    Transpose(result.re, lanes, re, rowSize, N, lanes);
+    Transpose(result.im, lanes, im, rowSize, N, lanes);
+  }
+}
+
+void Fft2D::InverseColumns(const Field &field, u32 columnBegin,
+                           u32 columnEnd) const {
+  const u32 width = GetBlockWidth();
+  const size_t batch = (size_t)N * width;
+  const size_t work = 6 * (size_t)std::max(outer.length, inner.length) * width;
+  f32 *scratch = Scratch(2 * batch + work).data();
+
+  for (u32 column = columnBegin; column < columnEnd; column += width) {
+    const u32 lanes = std::min(width, columnEnd - column);
+    const BatchView strip{field.re + column, field.im + column,
+                          field.pitch ? field.pitch : N};
+    const BatchView block{scratch, scratch + batch, lanes};
+    Transform(outer, inner, splitTwiddleRe.data(), splitTwiddleIm.data(),
+              strip, block, strip, scratch + 2 * batch, lanes);
+  }
+}
+
+void Fft2D::Inverse(f32 *re, f32 *im, ThreadPool *pool) const {
+  const Field field{re, im};
+  const u32 width = GetBlockWidth();
+  const u32 blocks = (N + width - 1) / width;
+  const auto pass = [&](bool rows) {
+    const auto run = [&](u32 begin, u32 end) {
+      const u32 first = begin * width, last = std::min(end * width, N);
+      if (rows)
+        InverseRows(field, first, last);
+      else
+        InverseColumns(field, first, last);
+    };
+    if (pool)
+      pool->ParallelFor(blocks, 1, run);
+    else
+      run(0, blocks);
+  };
+  pass(true);
+  pass(false);
+}
+
+RealFft2D::RealFft2D(u32 N)
+    : N(N), columns(N), rows(N / 2), twiddleRe(N / 2), twiddleIm(N / 2) {
+  for (u32 k = 0; k < N / 2; ++k) {
+    const f64 theta = 2 * std::numbers::pi * (f64)k / (f64)N;
+    twiddleRe[k] = (f32)std::cos(theta);
+    twiddleIm[k] = (f32)std::sin(theta);
+  }
+}
+
+void RealFft2D::InverseColumns(const Field &field, u32 columnBegin,
+                               u32 columnEnd) const {
+  columns.InverseColumns({field.re, field.im, GetHalfPitch()}, columnBegin,
+                         columnEnd);
+}
+
+void RealFft2D::InverseRows(const Field &field, u32 rowBegin,
+                            u32 rowEnd) const {
+  const u32 half = N / 2, width = rows.GetBlockWidth();
+  const size_t batch = (size_t)half * width;
+  f32 *scratch = Scratch<1>(2 * batch).data();
+  f32 *zRe = scratch, *zIm = scratch + batch;
+
+  for (u32 row = rowBegin; row < rowEnd; row += width) {
+    const u32 count = std::min(width, rowEnd - row);
+
+    // With X(N - k) = X(k)*, the even outputs are the transform of
+    // E(k) = X(k) + X(N/2 - k)*, the odd ones of
+    // O(k) = (X(k) - X(N/2 - k)*) w_N^k, both real: Z = E + i O.
+    for (u32 r = 0; r < count; ++r) {
+      const f32 *re = field.re + (size_t)(row + r) * GetHalfPitch();
+      const f32 *im = field.im + (size_t)(row + r) * GetHalfPitch();
+      f32 *outRe = zRe + (size_t)r * half;
+      f32 *outIm = zIm + (size_t)r * half;
+      const auto kernel = [&]<typename V>(u32 k) {
+        const u32 mirrored = half - k - V::Width + 1;
+        const V xRe = V::Load(re + k), xIm = V::Load(im + k);
+        const V mRe = Reverse(V::Load(re + mirrored));
+        const V mIm = -Reverse(V::Load(im + mirrored));
+        const V eRe = xRe + mRe, eIm = xIm + mIm;
+        const V dRe = xRe - mRe, dIm = xIm - mIm;
+        const V wr = V::Load(twiddleRe.data() + k);
+        const V wi = V::Load(twiddleIm.data() + k);
+        const V oRe = NegMulAdd(dIm, wi, dRe * wr);
+        const V oIm = MulAdd(dRe, wi, dIm * wr);
+        (eRe - oIm).Store(outRe + k);
+        (eIm + oRe).Store(outIm + k);
+      };
+      u32 k = 0;
+      for (; k + f32v::Width <= half; k += f32v::Width)
+        kernel.template operator()<f32v>(k);
+      for (; k < half; ++k)
+        kernel.template operator()<f32x1>(k);
+    }
+
+    rows.InverseRows({zRe, zIm, half}, 0, count);
+
+    for (u32 r = 0; r < count; ++r) {
+      const f32 *inRe = zRe + (size_t)r * half;
+      const f32 *inIm = zIm + (size_t)r * half;
+      f32 *out = field.out + (size_t)(row + r) * N;
+      const auto kernel = [&]<typename V>(u32 n) {
+        V lo, hi;
+        Interleave(V::Load(inRe + n), V::Load(inIm + n), lo, hi);
+        lo.Store(out + 2 * n);
+        hi.Store(out + 2 * n + V::Width);
+      };
+      u32 n = 0;
+      for (; n + f32v::Width <= half; n += f32v::Width)
+        kernel.template operator()<f32v>(n);
+      for (; n < half; ++n)
+        kernel.template operator()<f32x1>(n);
+    }
+  }
+}
+
+void RealFft2D::Inverse(std::span<const Field> fields,
+                        ThreadPool *pool) const {
+  // Blocks of [start, extent) of every field, those of field f are
+  // [firstBlock[f], firstBlock[f + 1]).
+  std::vector<u32> firstBlock(fields.size() + 1, 0);
+  const auto pass = [&](u32 extent, u32 width, auto &&startOf, auto &&fn) {
+    for (size_t f = 0; f < fields.size(); ++f)
+      firstBlock[f + 1] =
+          firstBlock[f] + (extent - startOf(fields[f]) + width - 1) / width;
+    const auto run = [&](u32 begin, u32 end) {
+      size_t f = std::upper_bound(firstBlock.begin(), firstBlock.end(), begin) -
+                 firstBlock.begin() - 1;
+      for (u32 i = begin; i < end; ++i) {
+        while (i >= firstBlock[f + 1])
+          ++f;
+        const u32 first = startOf(fields[f]) + (i - firstBlock[f]) * width;
+        fn(fields[f], first, std::min(first + width, extent));
+      }
+    };
+    if (pool)
+      pool->ParallelFor(firstBlock.back(), 1, run);
+    else
+      run(0, firstBlock.back());
+  };
+
+  pass(
+      GetHalfPitch(), columns.GetBlockWidth(),
+      [](const Field &field) { return field.firstColumn; },
+      [&](const Field &field, u32 begin, u32 end) {
+        InverseColumns(field, begin, end);
+      });
+  pass(
+      N, rows.GetBlockWidth(), [](const Field &) { return 0u; },
+      [&](const Field &field, u32 begin, u32 end) {
+        InverseRows(field, begin, end);
+      });
+}
+} // namespace Ocean
@@ -0,0 +1,133 @@
+#pragma once
+#include <span>
+#include <vector>
+#include "../Typedefs.h"
+#include "../Memory/AlignedVector.h"
+
+namespace Ocean {
+class ThreadPool;
+
+// In place 2D inverse FFT of an N x N complex field stored as two row major
+// planes (real and imaginary parts). Same convention as FFT.hlsl: positive
+// exponent, no normalization. N must be a power of two, up to 4096.
+//
+// Every butterfly works on a strip of neighbouring rows or columns at once so
+// the SIMD lanes always run along contiguous memory: the column pass reads
+// the planes directly, the row pass transposes a block of rows first.
+//
+// A length N transform is split into N1 x N2 (four step): N2 transforms of
+// length N1 over the elements N2 apart, a twiddle, then N1 transforms of
+// length N2. The sub-transforms are Stockham radix-4 passes (plus one radix-8
+// pass for odd powers of two) on a small buffer that stays in the L1 cache,
+// so the whole strip is only read and written twice per 1D transform.
+class Fft2D {
+public:
+  explicit Fft2D(u32 N);
+
+  u32 GetSize() const { return N; }
+
+  // A complex field: element (x, y) is at re/im[y * pitch + x].
+  struct Field {
+    f32 *re;
+    f32 *im;
+    // Elements between the starts of two rows, N if 0.
+    u32 pitch = 0;
+  };
+
+  // Number of rows or columns transformed together by one block.
+  u32 GetBlockWidth() const { return stripWidth; }
+
+  // 1D transforms of the rows [rowBegin, rowEnd).
+  void InverseRows(const Field &field, u32 rowBegin, u32 rowEnd) const;
+  // 1D transforms of the columns [columnBegin, columnEnd).
+  void InverseColumns(const Field &field, u32 columnBegin,
+                      u32 columnEnd) const;
+
+  // Full 2D transform, the row blocks over the pool (if given), then the
+  // column blocks.
+  //
+  // Fields known to have real results (Hermitian spectra, X(-k) = X(k)*)
+  // should be transformed in pairs: the transform of a + i b returns the
+  // result of a in re and the one of b in im.
+  void Inverse(f32 *re, f32 *im, ThreadPool *pool = nullptr) const;
+
+  // Floating point operations of one 2D transform, the usual 5 N log2(N)
+  // estimate per 1D transform.
+  static f64 FlopCount(u32 N);
+
+  struct Stage {
+    u32 radix;
+    // Length of the sub-transforms and their count (stride) at this stage.
+    u32 length;
+    u32 stride;
+    // Offset of the (radix - 1) * length / radix twiddles of this stage.
+    u32 twiddleOffset;
+  };
+
+  // Stockham passes of one transform length.
+  struct Plan {
+    u32 length = 1;
+    std::vector<Stage> stages;
+    AlignedVector<f32> twiddleRe;
+    AlignedVector<f32> twiddleIm;
+  };
+
+private:
+  u32 N;
+  u32 stripWidth;
+  // N1 and N2 point transforms, N2 is 1 for small N.
+  Plan outer;
+  Plan inner;
+  // w_N^(i k) for i < N2, k < N1, at i * N1 + k.
+  AlignedVector<f32> splitTwiddleRe;
+  AlignedVector<f32> splitTwiddleIm;
+};
+
+// Inverse 2D FFT of a Hermitian spectrum (X(-k) = X(k)*) to a real N x N
+// field, same convention as Fft2D. Only the half spectrum x in [0, N / 2] is
+// stored and transformed: about half the work of the complex transform.
+//
+// The columns of the half spectrum are complex transforms. Every row is then
+// Hermitian again, and becomes one complex transform of length N / 2 whose
+// real and imaginary parts are the even and odd outputs.
+class RealFft2D {
+public:
+  explicit RealFft2D(u32 N);
+
+  u32 GetSize() const { return N; }
+  // Elements per row of the half spectrum.
+  u32 GetHalfPitch() const { return N / 2 + 1; }
+
+  struct Field {
+    // Half spectrum, N rows of GetHalfPitch() values, destroyed.
+    f32 *re;
+    f32 *im;
+    // N x N row major result.
+    f32 *out;
+    // The columns before it are zero, and are left out of the column pass
+    // (pruned): they stay zero.
+    u32 firstColumn = 0;
+  };
+
+  // Column transforms [columnBegin, columnEnd) of the half spectrum, in
+  // place. The columns go up to N / 2 included.
+  void InverseColumns(const Field &field, u32 columnBegin,
+                      u32 columnEnd) const;
+  // Row transforms [rowBegin, rowEnd) from the half spectrum to out, after
+  // all the columns.
+  void InverseRows(const Field &field, u32 rowBegin, u32 rowEnd) const;
+
+  // Full transforms of a batch of fields, the columns of all of them in one
+  // pass over the pool (if given), then the rows.
+  void Inverse(std::span<const Field> fields, ThreadPool *pool = nullptr) const;
+
+private:
+  u32 N;
+  Fft2D columns;
+  // Length N / 2 row transforms.
+  Fft2D rows;
+  // w_N^k for k < N / 2.
+  AlignedVector<f32> twiddleRe;
+  AlignedVector<f32> twiddleIm;
+};
+} // namespace Ocean
@@ -0,0 +1,154 @@
+#pragma once
+#include <cmath>
+#include "../Typedefs.h"
+
+// Minimal, platform neutral replacement for the subset of
+// Windows::Foundation::Numerics and DirectXMath the ocean code relies on.
+// Layouts match float2/float3/float4 and XMFLOAT4X4 so values can be copied
+// over with a plain memcpy on the application side.
+namespace Ocean {
+struct float2 {
+  f32 x = 0;
+  f32 y = 0;
+
+  constexpr float2() = default;
+  constexpr float2(f32 _x, f32 _y) : x(_x), y(_y) {}
+  constexpr explicit float2(f32 v) : x(v), y(v) {}
+
+  constexpr float2 &operator+=(const float2 &o) {
+    x += o.x;
+    y += o.y;
+    return *this;
+  }
+  constexpr float2 &operator-=(const float2 &o) {
+    x -= o.x;
+    y -= o.y;
+    return *this;
+  }
+  constexpr float2 &operator*=(f32 s) {
+    x *= s;
+    y *= s;
+    return *this;
+  }
+  constexpr bool operator==(const float2 &) const = default;
+};
+
+constexpr float2 operator+(float2 a, const float2 &b) { return a += b; }
+constexpr float2 operator-(float2 a, const float2 &b) { return a -= b; }
+constexpr float2 operator-(const float2 &a) { return {-a.x, -a.y}; }
+constexpr float2 operator*(const float2 &a, const float2 &b) {
+  return {a.x * b.x, a.y * b.y};
+}
+constexpr float2 operator*(float2 a, f32 s) { return a *= s; }
+constexpr float2 operator*(f32 s, float2 a) { return a *= s; }
+constexpr float2 operator/(const float2 &a, f32 s) { return {a.x / s, a.y / s}; }
+constexpr float2 operator/(const float2 &a, const float2 &b) {
+  return {a.x / b.x, a.y / b.y};
+}
+
+constexpr f32 dot(const float2 &a, const float2 &b) {
+  return a.x * b.x + a.y * b.y;
+}
+inline f32 length(const float2 &a) { return std::sqrt(dot(a, a)); }
+inline float2 normalize(const float2 &a) { return a / length(a); }
+
+struct float3 {
+  f32 x = 0;
+  f32 y = 0;
+  f32 z = 0;
+
+  constexpr float3() = default;
+  constexpr float3(f32 _x, f32 _y, f32 _z) : x(_x), y(_y), z(_z) {}
+  constexpr explicit float3(f32 v) : x(v), y(v), z(v) {}
+
+  constexpr float3 &operator+=(const float3 &o) {
+    x += o.x;
+    y += o.y;
+    z += o.z;
+    return *this;
+  }
+  constexpr float3 &operator-=(const float3 &o) {
+    x -= o.x;
+    y -= o.y;
+    z -= o.z;
+    return *this;
+  }
+  constexpr float3 &operator*=(f32 s) {
+    x *= s;
+    y *= s;
+    z *= s;
+    return *this;
+  }
+  constexpr bool operator==(const float3 &) const = default;
+};
+
+constexpr float3 operator+(float3 a, const float3 &b) { return a += b; }
+constexpr float3 operator-(float3 a, const float3 &b) { return a -= b; }
+constexpr float3 operator-(const float3 &a) { return {-a.x, -a.y, -a.z}; }
+constexpr float3 operator*(const float3 &a, const float3 &b) {
+  return {a.x * b.x, a.y * b.y, a.z * b.z};
+}
+constexpr float3 operator*(float3 a, f32 s) { return a *= s; }
+constexpr float3 operator*(f32 s, float3 a) { return a *= s; }
+constexpr float3 operator/(const float3 &a, f32 s) {
+  return {a.x / s, a.y / s, a.z / s};
+}
+
+constexpr f32 dot(const float3 &a, const float3 &b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+constexpr float3 cross(const float3 &a, const float3 &b) {
+  return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z,
+          a.x * b.y - a.y * b.x};
+}
+inline f32 length(const float3 &a) { return std::sqrt(dot(a, a)); }
+inline float3 normalize(const float3 &a) { return a / length(a); }
+
+struct float4 {
+  f32 x = 0;
+  f32 y = 0;
+  f32 z = 0;
+  f32 w = 0;
+
+  constexpr float4() = default;
+  constexpr float4(f32 _x, f32 _y, f32 _z, f32 _w)
+      : x(_x), y(_y), z(_z), w(_w) {}
+  constexpr float4(const float3 &v, f32 _w) : x(v.x), y(v.y), z(v.z), w(_w) {}
+
+  constexpr float3 xyz() const { return {x, y, z}; }
+  constexpr bool operator==(const float4 &) const = default;
+};
+
+constexpr float4 operator+(const float4 &a, const float4 &b) {
+  return {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+}
+constexpr float4 operator-(const float4 &a, const float4 &b) {
+  return {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w};
+}
+
+// Row major, row vector convention (v' = v * M), identical to XMMATRIX.
+struct float4x4 {
+  f32 m[4][4] = {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}};
+
+  static constexpr float4x4 Identity() { return {}; }
+  static constexpr float4x4 Translation(const float3 &t) {
+    float4x4 res;
+    res.m[3][0] = t.x;
+    res.m[3][1] = t.y;
+    res.m[3][2] = t.z;
+    return res;
+  }
+
+  constexpr float3 Row3(u32 i) const { return {m[i][0], m[i][1], m[i][2]}; }
+  constexpr bool operator==(const float4x4 &) const = default;
+};
+
+// Equivalent of XMVector3TransformCoord.
+constexpr float3 TransformCoord(const float3 &p, const float4x4 &M) {
+  const f32 x = p.x * M.m[0][0] + p.y * M.m[1][0] + p.z * M.m[2][0] + M.m[3][0];
+  const f32 y = p.x * M.m[0][1] + p.y * M.m[1][1] + p.z * M.m[2][1] + M.m[3][1];
+  const f32 z = p.x * M.m[0][2] + p.y * M.m[1][2] + p.z * M.m[2][2] + M.m[3][2];
+  const f32 w = p.x * M.m[0][3] + p.y * M.m[1][3] + p.z * M.m[2][3] + M.m[3][3];
+  return {x / w, y / w, z / w};
+}
+} // namespace Ocean
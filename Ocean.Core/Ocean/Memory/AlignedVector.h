@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace Ocean {
+// Allocator handing out cache line aligned storage, so SIMD kernels can
+// stream over planes without splitting cache lines at the start.
+template <typename T, std::size_t Alignment = 64> struct AlignedAllocator {
+  using value_type = T;
+
+  template <typename U> struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+  template <typename U>
+  constexpr AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+  T *allocate(std::size_t n) {
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+  }
+  void deallocate(T *p, std::size_t) noexcept {
+    ::operator delete(p, std::align_val_t{Alignment});
+  }
+
+  template <typename U>
+  constexpr bool operator==(const AlignedAllocator<U, Alignment> &) const {
+    return true;
+  }
+};
+
+template <typename T> using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+} // namespace Ocean
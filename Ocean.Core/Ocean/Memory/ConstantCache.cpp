@@ -0,0 +1,100 @@
+#include "pch.h"
+#include "ConstantCache.h"
+
+namespace Ocean {
+namespace {
+// FNV-1a over words, the payloads are at most a few hundred bytes.
+u64 Hash(std::span<const u8> bytes) {
+  constexpr u64 Prime = 1099511628211ull;
+  u64 res = 14695981039346656037ull ^ bytes.size();
+  size_t i = 0;
+  for (; i + sizeof(u64) <= bytes.size(); i += sizeof(u64)) {
+    u64 word;
+    std::memcpy(&word, bytes.data() + i, sizeof(word));
+    res = (res ^ word) * Prime;
+    res ^= res >> 29;
+  }
+  for (; i < bytes.size(); ++i)
+    res = (res ^ bytes[i]) * Prime;
+  return res;
+}
+} // namespace
+
+ConstantCache::ConstantCache(UploadMemoryFactory factory, u64 pageSize)
+    : factory(std::move(factory)),
+      pageSize((pageSize + Alignment - 1) & ~(Alignment - 1)) {}
+
+u64 ConstantCache::Write(std::span<const u8> bytes) {
+  const u64 hash = Hash(bytes);
+  const auto [first, last] = lookup.equal_range(hash);
+  for (auto it = first; it != last; ++it) {
+    Entry &entry = entries[it->second];
+    if (!std::ranges::equal(entry.content, bytes))
+      continue;
+    if (entry.fence != Open) {
+      entry.fence = Open;
+      used.push_back(it->second);
+    }
+    ++stats.hits;
+    stats.savedBytes += bytes.size();
+    return entry.gpuAddress;
+  }
+
+  const u32 index =
+      Reserve((bytes.size() + Alignment - 1) & ~(Alignment - 1));
+  Entry &entry = entries[index];
+  entry.hash = hash;
+  entry.content.assign(bytes.begin(), bytes.end());
+  entry.fence = Open;
+  std::memcpy(entry.data, bytes.data(), bytes.size());
+  lookup.emplace(hash, index);
+  used.push_back(index);
+  ++stats.misses;
+  return entry.gpuAddress;
+}
+
+void ConstantCache::EndFrame(u64 fence) {
+  for (u32 index : used)
+    entries[index].fence = fence;
+  used.clear();
+}
+
+void ConstantCache::Retire(u64 completed) { this->completed = completed; }
+
+u32 ConstantCache::Reserve(u64 capacity) {
+  // The least recently used retired entry of the size. A frame writes only
+  // a handful of constants, so a scan is cheaper than keeping lists.
+  u32 victim = ~0u;
+  for (u32 i = 0; i < entries.size(); ++i) {
+    const Entry &entry = entries[i];
+    if (entry.capacity == capacity && entry.fence <= completed &&
+        (victim == ~0u || entry.fence < entries[victim].fence))
+      victim = i;
+  }
+  if (victim != ~0u) {
+    const auto [first, last] = lookup.equal_range(entries[victim].hash);
+    for (auto it = first; it != last; ++it)
+      if (it->second == victim) {
+        lookup.erase(it);
+        break;
+      }
+    ++stats.reuses;
+    return victim;
+  }
+
+  if (pages.empty() || pagePosition + capacity > pageCapacity) {
+    pageCapacity = std::max(pageSize, capacity);
+    pages.push_back(factory(pageCapacity));
+    pagePosition = 0;
+    stats.reservedBytes += pageCapacity;
+  }
+  UploadMemory &page = *pages.back();
+  Entry &entry = entries.emplace_back();
+  entry.data = page.GetData() + pagePosition;
+  entry.gpuAddress = page.GetGpuAddress() + pagePosition;
+  entry.capacity = capacity;
+  pagePosition += capacity;
+  stats.entries = (u32)entries.size();
+  return (u32)entries.size() - 1;
+}
+} // namespace Ocean
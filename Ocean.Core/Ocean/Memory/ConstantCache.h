@@ -0,0 +1,67 @@
+#pragma once
+#include <unordered_map>
+#include "UploadRing.h"
+
+namespace Ocean {
+// Uploads the constants of a frame once for as long as they do not
+// change. A payload already in the cache returns its address again, even
+// if the frame that wrote it is still in flight. Each entry is kept until
+// the last frame that used it is retired, then its space is reused by a
+// payload of the same size. The fences are those of UploadRing.
+class ConstantCache {
+public:
+  static constexpr u64 Alignment = UploadRing::DefaultAlignment;
+
+  struct Statistics {
+    u32 hits = 0;
+    u32 misses = 0;
+    // Misses that reused the space of a retired entry.
+    u32 reuses = 0;
+    u32 entries = 0;
+    u64 reservedBytes = 0;
+    // Not written again thanks to the hits.
+    u64 savedBytes = 0;
+  };
+
+  explicit ConstantCache(UploadMemoryFactory factory, u64 pageSize = 1 << 16);
+
+  // The address of a copy of bytes.
+  u64 Write(std::span<const u8> bytes);
+
+  // Closes the frame. The fences must increase from frame to frame.
+  void EndFrame(u64 fence);
+  // The entries used last by a frame whose fence is not above completed
+  // may be replaced.
+  void Retire(u64 completed);
+
+  const Statistics &GetStatistics() const { return stats; }
+
+private:
+  // Fence of the entries used by the open frame.
+  static constexpr u64 Open = ~u64(0);
+
+  struct Entry {
+    u64 hash = 0;
+    // The payload, compared on hits rather than the upload memory, which
+    // may be slow to read.
+    std::vector<u8> content;
+    u8 *data = nullptr;
+    u64 gpuAddress = 0;
+    u64 capacity = 0;
+    u64 fence = 0;
+  };
+
+  u32 Reserve(u64 capacity);
+
+  UploadMemoryFactory factory;
+  u64 pageSize;
+  std::vector<std::unique_ptr<UploadMemory>> pages;
+  u64 pageCapacity = 0;
+  u64 pagePosition = 0;
+  std::vector<Entry> entries;
+  std::unordered_multimap<u64, u32> lookup;
+  std::vector<u32> used;
+  u64 completed = 0;
+  Statistics stats;
+};
+} // namespace Ocean
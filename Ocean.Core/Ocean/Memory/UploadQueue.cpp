@@ -0,0 +1,199 @@
+#include "pch.h"
+#include "UploadQueue.h"
+
+namespace Ocean {
+namespace {
+u64 AlignUp(u64 value, u64 alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+UploadQueue::UploadQueue(UploadMemoryFactory factory, u64 pageSize,
+                         u64 capacity)
+    : factory(std::move(factory)), pageSize(pageSize), capacity(capacity) {}
+
+std::future<void> UploadQueue::Enqueue(Task task) {
+  auto entry = std::make_unique<Entry>();
+  entry->task = std::move(task);
+  std::future<void> res = entry->done.get_future();
+  const u32 priority = (u32)entry->task.priority;
+  {
+    std::unique_lock lock(mutex);
+    // Behind the ones of its priority already waiting
+    const bool staged = waiting[priority].empty() && Stage(*entry, false);
+    if (!staged) {
+      const u64 size = GetPageSize(entry->task.size);
+      if (!waiting[priority].empty() || !Reserve(size)) {
+        waiting[priority].push_back(std::move(entry));
+        ++stats.waiting;
+        ++stats.deferred;
+        return res;
+      }
+      // Other producers go on while the page is created
+      lock.unlock();
+      auto memory = factory(size);
+      lock.lock();
+      Take(*entry, AddPage(std::move(memory), size), 0);
+    }
+  }
+
+  entry->task.write(entry->staging);
+  std::lock_guard lock(mutex);
+  ready[priority].push_back(std::move(entry));
+  ++stats.ready;
+  return res;
+}
+
+u64 UploadQueue::Drain(u64 budget, const std::any &context) {
+  std::vector<std::unique_ptr<Entry>> *batch;
+  u64 id;
+  {
+    std::lock_guard lock(mutex);
+    std::vector<std::unique_ptr<Entry>> taken;
+    u64 bytes = 0;
+    for (auto &queue : ready)
+      while (!queue.empty() && (budget == 0 || bytes < budget)) {
+        bytes += queue.front()->task.size;
+        taken.push_back(std::move(queue.front()));
+        queue.pop_front();
+      }
+    if (taken.empty())
+      return 0;
+
+    id = nextBatch++;
+    stats.ready -= (u32)taken.size();
+    stats.drainedBytes += bytes;
+    ++stats.batches;
+    batch = &(batches[id] = std::move(taken));
+  }
+
+  // The batch is not completed before it is returned
+  for (const auto &entry : *batch)
+    entry->task.record(entry->staging, context);
+  return id;
+}
+
+void UploadQueue::Complete(u64 batch) {
+  std::vector<std::unique_ptr<Entry>> done, staged;
+  {
+    std::lock_guard lock(mutex);
+    const auto it = batches.find(batch);
+    if (it == batches.end())
+      return;
+    done = std::move(it->second);
+    batches.erase(it);
+    for (const auto &entry : done)
+      Release(*entry);
+
+    // The most urgent first, in order within each priority
+    for (auto &queue : waiting)
+      while (!queue.empty() && Stage(*queue.front(), true)) {
+        staged.push_back(std::move(queue.front()));
+        queue.pop_front();
+        --stats.waiting;
+      }
+  }
+
+  for (const auto &entry : done)
+    entry->done.set_value();
+  if (staged.empty())
+    return;
+
+  for (const auto &entry : staged)
+    entry->task.write(entry->staging);
+  std::lock_guard lock(mutex);
+  for (auto &entry : staged)
+    ready[(u32)entry->task.priority].push_back(std::move(entry));
+  stats.ready += (u32)staged.size();
+}
+
+UploadQueue::Statistics UploadQueue::GetStatistics() const {
+  std::lock_guard lock(mutex);
+  return stats;
+}
+
+bool UploadQueue::Stage(Entry &entry, bool addPage) {
+  const u64 size = entry.task.size;
+  for (const auto &page : pages) {
+    const u64 offset = AlignUp(page->position, entry.task.alignment);
+    if (offset + size <= page->size) {
+      Take(entry, *page, offset);
+      return true;
+    }
+  }
+
+  const u64 newSize = GetPageSize(size);
+  if (!addPage || !Reserve(newSize))
+    return false;
+  Take(entry, AddPage(factory(newSize), newSize), 0);
+  return true;
+}
+
+u64 UploadQueue::GetPageSize(u64 size) const {
+  // Pages of their own for the uploads larger than a page
+  return std::max(pageSize, AlignUp(size, pageSize));
+}
+
+bool UploadQueue::Reserve(u64 size) {
+  if (stats.reservedBytes + size > capacity) {
+    // The spare pages are given up first
+    std::erase_if(pages, [this](const std::unique_ptr<Page> &spare) {
+      if (spare->live > 0)
+        return false;
+      stats.reservedBytes -= spare->size;
+      return true;
+    });
+    stats.pages = (u32)pages.size();
+    // A single upload larger than the capacity still gets its page
+    if (stats.reservedBytes > 0 && stats.reservedBytes + size > capacity)
+      return false;
+  }
+  stats.reservedBytes += size;
+  stats.peakReservedBytes =
+      std::max(stats.peakReservedBytes, stats.reservedBytes);
+  return true;
+}
+
+UploadQueue::Page &UploadQueue::AddPage(std::unique_ptr<UploadMemory> memory,
+                                        u64 size) {
+  pages.push_back(std::make_unique<Page>(std::move(memory), size));
+  stats.pages = (u32)pages.size();
+  return *pages.back();
+}
+
+void UploadQueue::Take(Entry &entry, Page &page, u64 offset) {
+  const u64 size = entry.task.size;
+  stats.consumedBytes += offset + size - page.position;
+  stats.liveBytes += size;
+  page.position = offset + size;
+  ++page.live;
+  entry.page = &page;
+  entry.staging = {page.memory->GetData() + offset,
+                   page.memory->GetGpuAddress() + offset, page.memory.get(),
+                   offset};
+}
+
+void UploadQueue::Release(Entry &entry) {
+  Page &page = *entry.page;
+  stats.liveBytes -= entry.task.size;
+  if (--page.live > 0)
+    return;
+
+  stats.consumedBytes -= page.position;
+  page.position = 0;
+  // One empty page is kept for the next uploads, the oversized ones and
+  // the rest are freed.
+  const bool spare =
+      page.size == pageSize &&
+      std::ranges::none_of(pages, [&page](const std::unique_ptr<Page> &other) {
+        return other.get() != &page && other->live == 0;
+      });
+  if (!spare) {
+    stats.reservedBytes -= page.size;
+    std::erase_if(pages, [&page](const std::unique_ptr<Page> &other) {
+      return other.get() == &page;
+    });
+    stats.pages = (u32)pages.size();
+  }
+}
+} // namespace Ocean
@@ -0,0 +1,110 @@
+#pragma once
+#include <any>
+#include <array>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include "UploadRing.h"
+
+namespace Ocean {
+enum class UploadPriority : u8 { High, Normal, Low };
+
+// Uploads of resources through shared staging pages. Each upload takes a
+// slice of a page instead of memory of its own, and a page is reused once
+// every upload in it is copied. Enqueue never blocks: when the staging
+// memory is full the upload waits in the queue, and its future tells when
+// it is done. Drain records the staged uploads, the most urgent first, up
+// to a byte budget.
+class UploadQueue {
+public:
+  static constexpr u32 PriorityCount = 3;
+
+  struct Staging {
+    u8 *data;
+    u64 gpuAddress;
+    // Of the slice in its page, for APIs copying from a page resource.
+    const UploadMemory *page;
+    u64 offset;
+  };
+
+  struct Task {
+    u64 size = 0;
+    u64 alignment = UploadRing::DefaultAlignment;
+    UploadPriority priority = UploadPriority::Normal;
+    // Fills the staging memory, on the thread calling Enqueue, or on the
+    // one calling Complete when the staging memory was full.
+    std::function<void(const Staging &)> write;
+    // Records the copy out of the staging memory, in Drain, which passes
+    // on its context, such as the command list.
+    std::function<void(const Staging &, const std::any &context)> record;
+  };
+
+  struct Statistics {
+    u64 reservedBytes = 0;
+    u64 peakReservedBytes = 0;
+    // Staged and not yet completed.
+    u64 liveBytes = 0;
+    // Of the pages, the bytes in front of the position of each, which are
+    // not reused before the page is empty.
+    u64 consumedBytes = 0;
+    u32 pages = 0;
+    u32 waiting = 0;
+    u32 ready = 0;
+    u32 deferred = 0;
+    u32 batches = 0;
+    u64 drainedBytes = 0;
+  };
+
+  explicit UploadQueue(UploadMemoryFactory factory, u64 pageSize = 4 << 20,
+                       u64 capacity = u64(640) << 20);
+
+  std::future<void> Enqueue(Task task);
+
+  // Records the staged tasks until budget bytes are taken, at least one, or
+  // all of them for a budget of 0. Returns the batch to complete once the
+  // copies are done, 0 if nothing was recorded.
+  u64 Drain(u64 budget = 0, const std::any &context = {});
+  // The copies of the batch are done: their staging memory is released,
+  // their futures are set and the waiting tasks which fit are staged.
+  void Complete(u64 batch);
+
+  Statistics GetStatistics() const;
+
+private:
+  struct Page {
+    std::unique_ptr<UploadMemory> memory;
+    u64 size;
+    u64 position = 0;
+    u32 live = 0;
+  };
+
+  struct Entry {
+    Task task;
+    std::promise<void> done;
+    Staging staging = {};
+    Page *page = nullptr;
+  };
+
+  // Into the first page with room, or a new one if addPage.
+  bool Stage(Entry &entry, bool addPage);
+  u64 GetPageSize(u64 size) const;
+  // Of the capacity for a new page.
+  bool Reserve(u64 size);
+  Page &AddPage(std::unique_ptr<UploadMemory> memory, u64 size);
+  void Take(Entry &entry, Page &page, u64 offset);
+  void Release(Entry &entry);
+
+  UploadMemoryFactory factory;
+  u64 pageSize;
+  u64 capacity;
+
+  mutable std::mutex mutex;
+  std::deque<std::unique_ptr<Page>> pages;
+  std::array<std::deque<std::unique_ptr<Entry>>, PriorityCount> waiting;
+  std::array<std::deque<std::unique_ptr<Entry>>, PriorityCount> ready;
+  std::map<u64, std::vector<std::unique_ptr<Entry>>> batches;
+  u64 nextBatch = 1;
+  Statistics stats;
+};
+} // namespace Ocean
@@ -0,0 +1,82 @@
+#include "pch.h"
+#include "UploadRing.h"
+#include <bit>
+#include <cassert>
+
+namespace Ocean {
+namespace {
+// The capacity is a power of two of at least a page, so any alignment up
+// to a page divides it and a wrapped position stays aligned.
+constexpr u64 PageSize = 4096;
+
+u64 AlignUp(u64 value, u64 alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+} // namespace
+
+UploadRing::UploadRing(UploadMemoryFactory factory, u64 initialSize)
+    : factory(std::move(factory)) {
+  capacity = std::bit_ceil(std::max(initialSize, PageSize));
+  memory = this->factory(capacity);
+  stats.capacity = capacity;
+}
+
+UploadRing::Allocation UploadRing::Allocate(u64 size, u64 alignment) {
+  assert(std::has_single_bit(alignment) && alignment <= PageSize);
+  u64 position = AlignUp(head, alignment);
+  // Allocations do not wrap, the end of the ring is skipped instead.
+  const u64 offset = position & (capacity - 1);
+  if (offset + size > capacity)
+    position += capacity - offset;
+  if (position + size - tail > capacity) {
+    Grow(size);
+    position = 0;
+  }
+
+  head = position + size;
+  stats.inFlight = head - tail;
+  stats.peakInFlight = std::max(stats.peakInFlight, stats.inFlight);
+  stats.allocatedBytes += size;
+  ++stats.allocations;
+  const u64 ringOffset = position & (capacity - 1);
+  return {memory->GetData() + ringOffset,
+          memory->GetGpuAddress() + ringOffset};
+}
+
+u64 UploadRing::Write(std::span<const u8> bytes, u64 alignment) {
+  const Allocation allocation = Allocate(bytes.size(), alignment);
+  std::memcpy(allocation.data, bytes.data(), bytes.size());
+  return allocation.gpuAddress;
+}
+
+void UploadRing::EndFrame(u64 fence) {
+  assert(frames.empty() || frames.back().fence < fence);
+  frames.push_back({fence, head});
+  for (Replaced &old : replaced)
+    if (old.fence == 0)
+      old.fence = fence;
+}
+
+void UploadRing::Retire(u64 completed) {
+  while (!frames.empty() && frames.front().fence <= completed) {
+    tail = frames.front().end;
+    frames.pop_front();
+  }
+  std::erase_if(replaced, [completed](const Replaced &old) {
+    return old.fence != 0 && old.fence <= completed;
+  });
+  stats.inFlight = head - tail;
+}
+
+void UploadRing::Grow(u64 size) {
+  // The frames in flight keep reading the old ring until the frame open
+  // now is done, which is after every one of them.
+  replaced.push_back({std::move(memory), 0});
+  frames.clear();
+  capacity = std::bit_ceil(std::max(capacity * 2, size));
+  memory = factory(capacity);
+  head = tail = 0;
+  stats.capacity = capacity;
+  ++stats.grows;
+}
+} // namespace Ocean
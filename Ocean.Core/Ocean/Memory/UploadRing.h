@@ -0,0 +1,106 @@
+#pragma once
+#include <deque>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+#include "AlignedVector.h"
+#include "../Typedefs.h"
+
+namespace Ocean {
+// Memory the CPU writes and the GPU reads in place, such as a persistently
+// mapped upload heap.
+class UploadMemory {
+public:
+  virtual ~UploadMemory() = default;
+
+  virtual u8 *GetData() = 0;
+  virtual u64 GetGpuAddress() const = 0;
+};
+
+// Creates the memory of the ring, size bytes.
+using UploadMemoryFactory =
+    std::function<std::unique_ptr<UploadMemory>(u64 size)>;
+
+// Host memory standing in for the GPU, its addresses start at gpuAddress.
+class HostUploadMemory final : public UploadMemory {
+public:
+  HostUploadMemory(u64 size, u64 gpuAddress)
+      : data(size), gpuAddress(gpuAddress) {}
+
+  u8 *GetData() override { return data.data(); }
+  u64 GetGpuAddress() const override { return gpuAddress; }
+
+private:
+  AlignedVector<u8> data;
+  u64 gpuAddress;
+};
+
+// Hands out the per frame data of the GPU from one ring of upload memory.
+// The data is written in place and read by the GPU from there, without a
+// copy. Everything allocated before EndFrame(fence) is kept until
+// Retire is called with that fence completed, then its space is reused.
+// When the ring is full, a twice larger one replaces it and the old one is
+// released with the current frame.
+class UploadRing {
+public:
+  // Alignment of constant buffers.
+  static constexpr u64 DefaultAlignment = 256;
+
+  struct Allocation {
+    u8 *data;
+    u64 gpuAddress;
+  };
+
+  struct Statistics {
+    u64 capacity = 0;
+    // Allocated and not yet retired, including the alignment and the end
+    // of the ring skipped at the wrap.
+    u64 inFlight = 0;
+    u64 peakInFlight = 0;
+    u64 allocatedBytes = 0;
+    u32 allocations = 0;
+    u32 grows = 0;
+  };
+
+  explicit UploadRing(UploadMemoryFactory factory, u64 initialSize = 1 << 20);
+
+  // size bytes at an alignment that is a power of two, not more than 4096.
+  Allocation Allocate(u64 size, u64 alignment = DefaultAlignment);
+  // A copy of bytes.
+  u64 Write(std::span<const u8> bytes, u64 alignment = DefaultAlignment);
+
+  // Closes the frame. The fences must increase from frame to frame.
+  void EndFrame(u64 fence);
+  // Frees the frames whose fence is not above completed.
+  void Retire(u64 completed);
+
+  const Statistics &GetStatistics() const { return stats; }
+
+private:
+  // The first position past a closed frame.
+  struct Frame {
+    u64 fence;
+    u64 end;
+  };
+  // A ring replaced by a larger one, released with the fence of the frame
+  // it was replaced in, 0 while that frame is open.
+  struct Replaced {
+    std::unique_ptr<UploadMemory> memory;
+    u64 fence;
+  };
+
+  void Grow(u64 size);
+
+  UploadMemoryFactory factory;
+  std::unique_ptr<UploadMemory> memory;
+  u64 capacity = 0;
+  // Positions grow without wrapping, the ring offset is modulo capacity,
+  // a power of two.
+  u64 head = 0;
+  u64 tail = 0;
+  std::deque<Frame> frames;
+  std::vector<Replaced> replaced;
+  Statistics stats;
+};
+} // namespace Ocean
@@ -0,0 +1,218 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <vector>
+#include "QuadTree.h"
+#include "../Threading/ThreadPool.h"
+
+namespace Ocean {
+// Everything the quadtree needs to know about the viewer and the ocean plane.
+struct QuadCollectionDescription {
+  float3 center = {0, 0, 0};
+  float2 fullSizeXZ = {1000.f, 1000.f};
+  float3 camEye;
+  float3 camForward;
+  Frustum frustum;
+  float4x4 modelMatrix;
+  f32 distanceThreshold = QuadTree::Defaults::DistanceThreshold;
+  Depth maxDepth = QuadTree::Defaults::maxDepth;
+  // Tessellation ratios are only needed by the tessellated draw path.
+  bool calculateTessellation = true;
+  // Update the tree of the previous call instead of building a new one.
+  bool incremental = false;
+  // When not 0, the leaf count the tree is refined to instead of the
+  // distance threshold, see QuadTree::BuildBudgeted. Such a tree is always
+  // built from scratch.
+  u32 leafBudget = 0;
+  // Range of the displacement of the vertices, see QuadTree::SetDisplacement
+  // and DisplacementBounds.
+  float3 displacementLow = {0, 0, 0};
+  float3 displacementHigh = {0, 0, 0};
+};
+
+struct QuadCollectionStatistics {
+  u32 qtNodes = 0;
+  u32 drawnNodes = 0;
+  u32 touchedNodes = 0;
+  std::chrono::nanoseconds QuadTreeBuildTime{0};
+  std::chrono::nanoseconds NavigatingTheQuadTree{0};
+};
+
+// One drawn patch of the ocean.
+struct OceanQuad {
+  float2 scaling;
+  float2 offset;
+  // zneg, xneg, zpos, xpos
+  float4 tessellation = {1, 1, 1, 1};
+};
+
+// The same patch in 8 bytes, as the shaders read it from the instance
+// buffer. The place and size are relative to the bounds of the ocean,
+// given by the cell of the leaf on each axis with a 1 bit set above the
+// digits of its level: the highest bit set is the level.
+struct PackedOceanQuad {
+  u16 x;
+  u16 z;
+  // zneg, xneg, zpos, xpos, clamped to 255.
+  std::array<u8, 4> tessellation = {1, 1, 1, 1};
+};
+static_assert(sizeof(PackedOceanQuad) == 8);
+static_assert(QuadTree::MaxLevel < 16);
+
+// The patch a packed one stands for in the ocean of the given bounds.
+inline OceanQuad UnpackOceanQuad(const PackedOceanQuad &packed,
+                                 const float3 &center,
+                                 const float2 &fullSizeXZ) {
+  const Depth level = (Depth)std::bit_width(packed.x) - 1;
+  const u32 shift = QuadTree::MaxLevel - level;
+  const f32 cells = (f32)(1u << QuadTree::MaxLevel);
+  const float2 cell((f32)((packed.x ^ (1u << level)) << shift),
+                    (f32)((packed.z ^ (1u << level)) << shift));
+  const float2 size = fullSizeXZ / (f32)(1u << level);
+  const float2 corner = float2(center.x, center.z) - fullSizeXZ / 2;
+  return {.scaling = size,
+          .offset = corner + cell / cells * fullSizeXZ + size / 2,
+          .tessellation = {(f32)packed.tessellation[0],
+                           (f32)packed.tessellation[1],
+                           (f32)packed.tessellation[2],
+                           (f32)packed.tessellation[3]}};
+}
+
+namespace Detail {
+inline void BuildQuadTree(QuadTree &qt, const QuadCollectionDescription &desc,
+                          ThreadPool *pool, QuadCollectionStatistics *stats) {
+  using clock = std::chrono::high_resolution_clock;
+  const auto start = clock::now();
+
+  qt.SetDisplacement(desc.displacementLow, desc.displacementHigh);
+  if (desc.leafBudget != 0)
+    qt.BuildBudgeted(desc.center, desc.fullSizeXZ, desc.camEye,
+                     desc.camForward, desc.frustum, desc.modelMatrix,
+                     desc.leafBudget, desc.maxDepth, pool);
+  else if (desc.incremental)
+    qt.Update(desc.center, desc.fullSizeXZ, desc.camEye, desc.camForward,
+              desc.frustum, desc.modelMatrix, desc.distanceThreshold,
+              desc.maxDepth, pool);
+  else
+    qt.Build(desc.center, desc.fullSizeXZ, desc.camEye, desc.camForward,
+             desc.frustum, desc.modelMatrix, desc.distanceThreshold,
+             desc.maxDepth, pool);
+
+  if (stats) {
+    stats->QuadTreeBuildTime += clock::now() - start;
+    stats->qtNodes += qt.GetSize();
+    stats->touchedNodes += qt.GetTouched();
+  }
+}
+
+// The neighbour ratios are resolved by the build, this is a plain copy.
+inline OceanQuad MakeOceanQuad(const QuadTree &qt, const QuadTree::Leaf &leaf,
+                               bool calculateTessellation) {
+  // A missing neighbour (edge of the ocean) is treated as same sized.
+  static constexpr auto l = [](const float x) -> float {
+    if (x == 0)
+      return 1;
+    else
+      return x;
+  };
+
+  const Node node = qt.GetNode(leaf);
+  OceanQuad quad{.scaling = node.size, .offset = node.center};
+  if (calculateTessellation) {
+    const auto &res = leaf.neighbors;
+    quad.tessellation = {l(res.zneg), l(res.xneg), l(res.zpos), l(res.xpos)};
+  }
+  return quad;
+}
+
+inline PackedOceanQuad PackOceanQuad(const QuadTree::Leaf &leaf,
+                                     bool calculateTessellation) {
+  static constexpr auto ratio = [](const float x) -> u8 {
+    return x == 0 ? 1 : (u8)std::min(x, 255.f);
+  };
+
+  const u32 shift = QuadTree::MaxLevel - leaf.level;
+  const u32 bit = 1u << leaf.level;
+  PackedOceanQuad quad{.x = (u16)(bit | Morton::DecodeX(leaf.code) >> shift),
+                       .z = (u16)(bit | Morton::DecodeZ(leaf.code) >> shift)};
+  if (calculateTessellation) {
+    const auto &res = leaf.neighbors;
+    quad.tessellation = {ratio(res.zneg), ratio(res.xneg), ratio(res.zpos),
+                         ratio(res.xpos)};
+  }
+  return quad;
+}
+} // namespace Detail
+
+// Builds the quadtree for the given view, then calls sink(const OceanQuad &)
+// for every leaf in front to back order.
+template <typename Sink>
+void CollectOceanQuads(QuadTree &qt, const QuadCollectionDescription &desc,
+                       Sink &&sink,
+                       QuadCollectionStatistics *stats = nullptr) {
+  using clock = std::chrono::high_resolution_clock;
+  Detail::BuildQuadTree(qt, desc, nullptr, stats);
+
+  const auto start = clock::now();
+  const auto leaves = qt.GetLeaves();
+  for (const QuadTree::Leaf &leaf : leaves)
+    sink(Detail::MakeOceanQuad(qt, leaf, desc.calculateTessellation));
+
+  if (stats) {
+    stats->NavigatingTheQuadTree += clock::now() - start;
+    stats->drawnNodes += (u32)leaves.size();
+  }
+}
+
+// Same as above on the threads of the pool: reserve(u32 count) is called
+// once with the number of leaves, then sink(u32 index, const OceanQuad &)
+// concurrently for every leaf, index being its place in front to back order.
+// The output is the same as that of the serial version. Below
+// QuadTree::ParallelLeaves leaves everything runs on the calling thread.
+template <typename Reserve, typename Sink>
+void CollectOceanQuads(QuadTree &qt, const QuadCollectionDescription &desc,
+                       ThreadPool &pool, Reserve &&reserve, Sink &&sink,
+                       QuadCollectionStatistics *stats = nullptr) {
+  using clock = std::chrono::high_resolution_clock;
+  Detail::BuildQuadTree(qt, desc, &pool, stats);
+
+  const auto start = clock::now();
+  const auto leaves = qt.GetLeaves();
+  reserve((u32)leaves.size());
+  const auto run = [&](u32 begin, u32 end) {
+    for (u32 i = begin; i < end; ++i)
+      sink(i, Detail::MakeOceanQuad(qt, leaves[i], desc.calculateTessellation));
+  };
+  pool.ParallelFor((u32)leaves.size(), QuadTree::ParallelLeaves, run);
+
+  if (stats) {
+    stats->NavigatingTheQuadTree += clock::now() - start;
+    stats->drawnNodes += (u32)leaves.size();
+  }
+}
+
+// Same as above, packing the leaves into out on the threads of the pool.
+inline void CollectOceanQuads(QuadTree &qt,
+                              const QuadCollectionDescription &desc,
+                              ThreadPool &pool,
+                              std::vector<PackedOceanQuad> &out,
+                              QuadCollectionStatistics *stats = nullptr) {
+  using clock = std::chrono::high_resolution_clock;
+  Detail::BuildQuadTree(qt, desc, &pool, stats);
+
+  const auto start = clock::now();
+  const auto leaves = qt.GetLeaves();
+  out.resize(leaves.size());
+  const auto run = [&](u32 begin, u32 end) {
+    for (u32 i = begin; i < end; ++i)
+      out[i] = Detail::PackOceanQuad(leaves[i], desc.calculateTessellation);
+  };
+  pool.ParallelFor((u32)leaves.size(), QuadTree::ParallelLeaves, run);
+
+  if (stats) {
+    stats->NavigatingTheQuadTree += clock::now() - start;
+    stats->drawnNodes += (u32)leaves.size();
+  }
+}
+} // namespace Ocean
@@ -0,0 +1,616 @@
+#include "pch.h"
+#include "QuadTree.h"
+#include <limits>
+#include "../Threading/ThreadPool.h"
+
+namespace Ocean {
+namespace {
+constexpr f64 Never = std::numeric_limits<f64>::infinity();
+// Slack for the rounding of the margins, in world units.
+constexpr f32 MarginEpsilon = 1e-3f;
+// Of its distance to the eye, the eye travel a node tested against the
+// frustum allows. The planes move the more the farther the eye may go, so
+// this keeps their limits from shrinking with the distance threshold.
+constexpr f32 TravelShare = 0.25f;
+
+constexpr std::array<Plane Frustum::*, 6> FrustumFaces = {
+    &Frustum::leftFace,  &Frustum::rightFace, &Frustum::topFace,
+    &Frustum::bottomFace, &Frustum::nearFace, &Frustum::farFace};
+} // namespace
+
+void QuadTree::SetParameters(const float3 &center, const float2 &fullSizeXZ,
+                             const float3 &camDir, const Frustum &f,
+                             const float4x4 &mMatrix,
+                             const float &quadTreeDistanceThreshold,
+                             Depth MaxDepth) {
+  corner = {center.x - fullSizeXZ.x / 2, center.z - fullSizeXZ.y / 2};
+  fullSize = fullSizeXZ;
+  yCoordinate = center.y;
+  modelMatrix = mMatrix;
+  axisScale = {length(mMatrix.Row3(0)), length(mMatrix.Row3(1)),
+               length(mMatrix.Row3(2))};
+  culler = FrustumCuller(f, mMatrix);
+  distanceThreshold = quadTreeDistanceThreshold;
+  maxDepth = std::min(MaxDepth, MaxLevel - 1);
+  order = TravelOrder(camDir, mMatrix);
+  for (u32 byte = 0; byte < 256; ++byte) {
+    u32 digits = 0;
+    for (u32 shift = 0; shift < 8; shift += 2)
+      digits |= order.ranks[(byte >> shift) & 3] << shift;
+    keyDigits[byte] = (u8)digits;
+  }
+}
+
+void QuadTree::Build(const float3 &center, const float2 &fullSizeXZ,
+                     const float3 &camEye, const float3 &camDir,
+                     const Frustum &f, const float4x4 &mMatrix,
+                     const float &quadTreeDistanceThreshold, Depth MaxDepth,
+                     ThreadPool *pool) {
+  SetParameters(center, fullSizeXZ, camDir, f, mMatrix,
+                quadTreeDistanceThreshold, MaxDepth);
+  leafBudget = 0;
+  Reset(camEye, f);
+  Refresh(camEye, pool);
+  EmitLeaves(pool);
+}
+
+void QuadTree::BuildBudgeted(const float3 &center, const float2 &fullSizeXZ,
+                             const float3 &camEye, const float3 &camDir,
+                             const Frustum &f, const float4x4 &mMatrix,
+                             u32 LeafBudget, Depth MaxDepth, ThreadPool *pool) {
+  SetParameters(center, fullSizeXZ, camDir, f, mMatrix,
+                Defaults::DistanceThreshold, MaxDepth);
+  leafBudget = std::max(LeafBudget, 1u);
+  Reset(camEye, f);
+  Refine(camEye);
+  EmitLeaves(pool);
+}
+
+void QuadTree::SetDisplacement(const float3 &low, const float3 &high) {
+  const float3 center = (low + high) * 0.5f;
+  const float3 extent = (high - low) * 0.5f;
+  if (center == displacementCenter && extent == displacementExtent)
+    return;
+  displacementCenter = center;
+  displacementExtent = extent;
+  displacementChanged = true;
+}
+
+// A tree of the root alone.
+void QuadTree::Reset(const float3 &camEye, const Frustum &f) {
+  for (Pool &nodePool : pools) {
+    nodePool.nodes.clear();
+    nodePool.freeBlocks.clear();
+    nodePool.touched = 0;
+  }
+  pools[0].nodes.push_back({.code = 0,
+                            .firstChild = 0,
+                            .leafCount = 1,
+                            .level = 0,
+                            .inside = 0,
+                            .cornerLevels = {},
+                            .expiry = {-Never, -Never, -Never}});
+  trunkLimits.assign(1, {-Never, -Never, -Never});
+  displacementChanged = false;
+  motion = {};
+  lastEye = camEye;
+  lastFrustum = f;
+}
+
+void QuadTree::Update(const float3 &center, const float2 &fullSizeXZ,
+                      const float3 &camEye, const float3 &camDir,
+                      const Frustum &f, const float4x4 &mMatrix,
+                      const float &quadTreeDistanceThreshold, Depth MaxDepth,
+                      ThreadPool *pool) {
+  const float2 newCorner = {center.x - fullSizeXZ.x / 2,
+                            center.z - fullSizeXZ.y / 2};
+  if (pools[0].nodes.empty() || leafBudget != 0 || displacementChanged ||
+      !(newCorner == corner && fullSizeXZ == fullSize &&
+        center.y == yCoordinate && mMatrix == modelMatrix &&
+        quadTreeDistanceThreshold == distanceThreshold &&
+        std::min(MaxDepth, MaxLevel - 1) == maxDepth)) {
+    Build(center, fullSizeXZ, camEye, camDir, f, mMatrix,
+          quadTreeDistanceThreshold, MaxDepth, pool);
+    return;
+  }
+  SetParameters(center, fullSizeXZ, camDir, f, mMatrix,
+                quadTreeDistanceThreshold, MaxDepth);
+
+  // The signed distance of a point p changes by dn * (p - eye) + dn * eye - dd
+  // when a plane moves, see Evaluate.
+  f32 turn = 0, shift = 0;
+  for (const auto face : FrustumFaces) {
+    const Plane &now = f.*face;
+    const Plane &before = lastFrustum.*face;
+    const float3 dn = now.normal - before.normal;
+    turn = std::max(turn, length(dn));
+    shift = std::max(
+        shift, std::abs(dot(dn, camEye) - (now.distance - before.distance)));
+  }
+  motion[EyeTravel] += length(camEye - lastEye);
+  motion[NormalTurn] += turn;
+  motion[PlaneShift] += shift;
+  lastEye = camEye;
+  lastFrustum = f;
+
+  for (Pool &nodePool : pools)
+    nodePool.touched = 0;
+  if (IsExpired(At(0).expiry))
+    Refresh(camEye, pool);
+  EmitLeaves(pool);
+}
+
+u32 QuadTree::GetSize() const {
+  u32 size = 0;
+  for (const Pool &nodePool : pools)
+    size += (u32)(nodePool.nodes.size() - 4 * nodePool.freeBlocks.size());
+  return size;
+}
+
+u32 QuadTree::GetTouched() const {
+  u32 touched = 0;
+  for (const Pool &nodePool : pools)
+    touched += nodePool.touched;
+  return touched;
+}
+
+bool QuadTree::IsExpired(const MotionLimits &limits) const {
+  return motion[EyeTravel] > limits[EyeTravel] ||
+         motion[NormalTurn] > limits[NormalTurn] ||
+         motion[PlaneShift] > limits[PlaneShift];
+}
+
+// The levels up to SubtreeLevel on the calling thread, the subtrees below
+// them on the pool, each in its own node pool, then the levels up to
+// SubtreeLevel again, bottom up.
+void QuadTree::Refresh(const float3 &camEye, ThreadPool *pool) {
+  pending.clear();
+  ++pools[0].touched;
+  Decision root;
+  Evaluate(&At(0).code, 1, 0, 0, camEye, &root);
+  Settle(0, root, camEye);
+
+  const auto run = [&](u32 begin, u32 end) {
+    for (u32 i = begin; i < end; ++i)
+      RefreshChildren(pending[i], camEye);
+  };
+  if (pool && leaves.size() >= ParallelLeaves)
+    pool->ParallelFor((u32)pending.size(), 1, run);
+  else
+    run(0, (u32)pending.size());
+  GatherTrunk(0);
+}
+
+// Applies a fresh decision to a node, splits or merges it, and refreshes
+// the children whose limits passed. Those of all four pass when the planes
+// they skip changed.
+void QuadTree::Settle(u32 handle, const Decision &decision,
+                      const float3 &camEye) {
+  TreeNode &node = At(handle);
+  const Depth level = node.level;
+  const bool skipChanged = node.inside != decision.inside;
+  node.inside = decision.inside;
+  u32 first = node.firstChild;
+  if (decision.split && first == 0) {
+    // The children may go to the pool of the node.
+    first = AllocateChildren(handle);
+    At(handle).firstChild = first;
+  } else if (!decision.split && first != 0) {
+    ReleaseChildren(first);
+    node.firstChild = first = 0;
+  }
+
+  for (ChildrenID c = 0; c < 4 && first != 0 && skipChanged; ++c)
+    At(first + c).expiry = {-Never, -Never, -Never};
+  bool descend = false;
+  for (ChildrenID c = 0; c < 4 && first != 0 && !descend; ++c)
+    descend = IsExpired(At(first + c).expiry);
+  if (first != 0 && descend) {
+    if (level == SubtreeLevel)
+      pending.push_back(handle);
+    else
+      RefreshChildren(handle, camEye);
+  }
+  // The levels up to SubtreeLevel are gathered once the subtrees are done.
+  if (level > SubtreeLevel)
+    Gather(handle, decision.limits);
+  else
+    trunkLimits[handle] = decision.limits;
+}
+
+// The others keep their decisions and their subtrees.
+void QuadTree::RefreshChildren(u32 parent, const float3 &camEye) {
+  const TreeNode &node = At(parent);
+  const u32 first = node.firstChild;
+  std::array<u32, 4> handles, codes;
+  u32 count = 0;
+  for (ChildrenID c = 0; c < 4; ++c)
+    if (IsExpired(At(first + c).expiry)) {
+      handles[count] = first + c;
+      codes[count++] = At(first + c).code;
+    }
+  pools[first >> IndexBits].touched += count;
+  std::array<Decision, 4> decisions;
+  Evaluate(codes.data(), count, node.level + 1, node.inside, camEye,
+           decisions.data());
+  for (u32 k = 0; k < count; ++k)
+    Settle(handles[k], decisions[k], camEye);
+}
+
+// Corner levels, leaf count and expiry of a node from its children.
+void QuadTree::Gather(u32 handle, const MotionLimits &limits) {
+  TreeNode &node = At(handle);
+  const u32 first = node.firstChild;
+  node.leafCount = first != 0 ? 0 : 1;
+  node.expiry = limits;
+  const TreeNode *children = first != 0 ? &At(first) : nullptr;
+  for (ChildrenID c = 0; c < 4; ++c) {
+    if (first == 0) {
+      node.cornerLevels[c] = node.level;
+      continue;
+    }
+    const TreeNode &child = children[c];
+    node.cornerLevels[c] = child.cornerLevels[c];
+    node.leafCount += child.leafCount;
+    for (u32 m = 0; m < MotionCount; ++m)
+      node.expiry[m] = std::min(node.expiry[m], child.expiry[m]);
+  }
+}
+
+// The budgeted tree is not kept, it expires right away.
+void QuadTree::GatherAll(u32 handle) {
+  const TreeNode &node = At(handle);
+  if (node.firstChild != 0)
+    for (ChildrenID c = 0; c < 4; ++c)
+      GatherAll(node.firstChild + c);
+  Gather(handle, {-Never, -Never, -Never});
+}
+
+void QuadTree::GatherTrunk(u32 handle) {
+  const TreeNode &node = At(handle);
+  if (node.level < SubtreeLevel && node.firstChild != 0)
+    for (ChildrenID c = 0; c < 4; ++c)
+      GatherTrunk(node.firstChild + c);
+  Gather(handle, trunkLimits[handle]);
+}
+
+// New children are past every limit, they are evaluated right away. Below
+// SubtreeLevel they go to the pool of their ancestor of SubtreeLevel.
+u32 QuadTree::AllocateChildren(u32 parent) {
+  const u32 code = At(parent).code;
+  const Depth level = At(parent).level;
+  const u32 poolIndex =
+      level < SubtreeLevel ? 0 : 1 + (code >> 2 * (MaxLevel - SubtreeLevel));
+  Pool &nodePool = pools[poolIndex];
+  u32 first;
+  if (!nodePool.freeBlocks.empty()) {
+    first = nodePool.freeBlocks.back();
+    nodePool.freeBlocks.pop_back();
+  } else {
+    first = poolIndex << IndexBits | (u32)nodePool.nodes.size();
+    nodePool.nodes.resize(nodePool.nodes.size() + 4);
+    if (poolIndex == 0)
+      trunkLimits.resize(nodePool.nodes.size());
+  }
+  const u32 shift = 2 * (MaxLevel - level - 1);
+  for (ChildrenID c = 0; c < 4; ++c)
+    At(first + c) = {.code = code | (c << shift),
+                     .firstChild = 0,
+                     .leafCount = 1,
+                     .level = (u8)(level + 1),
+                     .inside = 0,
+                     .cornerLevels = {},
+                     .expiry = {-Never, -Never, -Never}};
+  return first;
+}
+
+void QuadTree::ReleaseChildren(u32 firstChild) {
+  Pool &nodePool = pools[firstChild >> IndexBits];
+  nodePool.touched += 4;
+  for (ChildrenID c = 0; c < 4; ++c)
+    if (At(firstChild + c).firstChild != 0)
+      ReleaseChildren(At(firstChild + c).firstChild);
+  nodePool.freeBlocks.push_back(firstChild);
+}
+
+// The neighbour of a child across an edge of its parent: the child of the
+// parent's neighbour if that one was split, else a bigger leaf.
+u32 QuadTree::Across(u32 neighbor, ChildrenID child) const {
+  if (neighbor >= BiggerNeighbor)
+    return neighbor;
+  const u32 first = At(neighbor).firstChild;
+  return first != 0 ? first + child : BiggerNeighbor;
+}
+
+std::array<u32, 4>
+QuadTree::ChildNeighbors(u32 firstChild, ChildrenID child,
+                         const std::array<u32, 4> &parent) const {
+  const bool x = child & 2;
+  const bool z = child & 1;
+  return {x ? Across(parent[XPos], child & ~2u) : firstChild + (child | 2),
+          x ? firstChild + (child & ~2u) : Across(parent[XNeg], child | 2),
+          z ? firstChild + (child & ~1u) : Across(parent[ZNeg], child | 1),
+          z ? Across(parent[ZPos], child & ~1u) : firstChild + (child | 1)};
+}
+
+// Best first: every split turns a leaf into four, the leaf of the largest
+// projected size goes first. The priority is area / distance^2, the measure
+// the distance threshold bounds, so a budget met by the threshold build
+// gives the same tree. Leaves below minDepth go before all others.
+void QuadTree::Refine(const float3 &camEye) {
+  candidates.clear();
+  Offer(0, 1, 0, camEye);
+  u32 leafCount = 1;
+  while (!candidates.empty() && leafCount + 3 <= leafBudget) {
+    std::pop_heap(candidates.begin(), candidates.end());
+    const u32 handle = candidates.back().node;
+    candidates.pop_back();
+    const u32 first = AllocateChildren(handle);
+    At(handle).firstChild = first;
+    leafCount += 3;
+    if (At(handle).level < maxDepth)
+      Offer(first, 4, At(handle).inside, camEye);
+  }
+  GatherAll(0);
+}
+
+// Culls up to four new leaves of one level and queues the visible ones.
+void QuadTree::Offer(u32 first, u32 count, FrustumCuller::PlaneMask skip,
+                     const float3 &camEye) {
+  std::array<f32, 4> centerX{}, centerY{}, centerZ{};
+  std::array<f32, 4> extentX{}, extentY{}, extentZ{};
+  std::array<f32, 4> priorities{};
+  pools[first >> IndexBits].touched += count;
+  for (u32 k = 0; k < count; ++k) {
+    const TreeNode &node = At(first + k);
+    const Node cell = GetCell(node.code, node.level);
+    const float3 diff = {cell.center.x - camEye.x, yCoordinate - camEye.y,
+                         cell.center.y - camEye.z};
+    priorities[k] = node.level < minDepth
+                        ? std::numeric_limits<f32>::infinity()
+                        : cell.size.x * cell.size.y / dot(diff, diff);
+    float3 center, extents;
+    GetBounds(cell, center, extents);
+    centerX[k] = center.x;
+    centerY[k] = center.y;
+    centerZ[k] = center.z;
+    extentX[k] = extents.x;
+    extentY[k] = extents.y;
+    extentZ[k] = extents.z;
+  }
+
+  std::array<FrustumCuller::Visibility, FrustumCuller::BlockSize> visibility;
+  culler.Test({centerX.data(), centerY.data(), centerZ.data(), extentX.data(),
+               extentY.data(), extentZ.data()},
+              count, skip, visibility.data());
+  for (u32 k = 0; k < count; ++k) {
+    At(first + k).inside = visibility[k].inside;
+    if (!visibility[k].visible)
+      continue;
+    candidates.push_back({priorities[k], first + k});
+    std::push_heap(candidates.begin(), candidates.end());
+  }
+}
+
+// The levels up to SubtreeLevel in travel order, cut into subtrees whose
+// leaves start after the leaves of the ones before, then the subtrees.
+void QuadTree::EmitLeaves(ThreadPool *pool) {
+  subtrees.clear();
+  u32 leafCount = 0;
+  std::array<Subtree, 3 * SubtreeLevel + 1> stack;
+  u32 size = 0;
+  stack[size++] = {0, {NoNeighbor, NoNeighbor, NoNeighbor, NoNeighbor}, 0};
+  while (size > 0) {
+    const Subtree entry = stack[--size];
+    const TreeNode &node = At(entry.node);
+    if (node.level < SubtreeLevel && node.firstChild != 0) {
+      for (u32 r = 4; r-- > 0;) {
+        const ChildrenID c = order.children[r];
+        stack[size++] = {node.firstChild + c,
+                         ChildNeighbors(node.firstChild, c, entry.neighbors),
+                         0};
+      }
+      continue;
+    }
+    subtrees.push_back({entry.node, entry.neighbors, leafCount});
+    leafCount += node.leafCount;
+  }
+
+  leaves.resize(leafCount);
+  keys.resize(leafCount);
+  subtreeHeights.resize(subtrees.size());
+  const auto run = [&](u32 begin, u32 end) {
+    for (u32 i = begin; i < end; ++i)
+      subtreeHeights[i] = EmitSubtree(subtrees[i]);
+  };
+  if (pool && leafCount >= ParallelLeaves)
+    pool->ParallelFor((u32)subtrees.size(), 1, run);
+  else
+    run(0, (u32)subtrees.size());
+  height = *std::ranges::max_element(subtreeHeights);
+}
+
+// Depth first in travel order, the children are pushed in reverse with their
+// neighbours. Every level leaves at most 3 siblings on the stack. Returns
+// the deepest level.
+Depth QuadTree::EmitSubtree(const Subtree &subtree) {
+  struct Entry {
+    u32 node;
+    // Node of the same level across each edge, or a marker.
+    std::array<u32, 4> neighbors;
+  };
+
+  Depth deepest = 0;
+  u32 out = subtree.firstLeaf;
+  std::array<Entry, 3 * MaxLevel + 1> stack;
+  u32 size = 0;
+  stack[size++] = {subtree.node, subtree.neighbors};
+  while (size > 0) {
+    const Entry entry = stack[--size];
+    const TreeNode &node = At(entry.node);
+    const auto &parent = entry.neighbors;
+    if (const u32 first = node.firstChild; first != 0) {
+      for (u32 r = 4; r-- > 0;) {
+        const ChildrenID c = order.children[r];
+        stack[size++] = {first + c, ChildNeighbors(first, c, parent)};
+      }
+      continue;
+    }
+
+    // The neighbour leaf next to the first corner of the edge is at the
+    // corner of the neighbour node facing it.
+    const auto ratio = [&](Edge edge, ChildrenID facing) {
+      const u32 neighbor = parent[edge];
+      if (neighbor == NoNeighbor)
+        return 0.f;
+      if (neighbor == BiggerNeighbor)
+        return 1.f;
+      return (f32)(1u << (At(neighbor).cornerLevels[facing] - node.level));
+    };
+    leaves[out] = {node.code,
+                   node.level,
+                   {ratio(XPos, 0), ratio(XNeg, 2), ratio(ZNeg, 1),
+                    ratio(ZPos, 0)}};
+    // The first key of the cell, the digits below its level are 0.
+    const u32 low = 2 * (MaxLevel - node.level);
+    keys[out++] = GetKey(node.code) & ~((1u << low) - 1);
+    deepest = std::max<Depth>(deepest, node.level);
+  }
+  return deepest;
+}
+
+Node QuadTree::GetNode(const Leaf &leaf) const {
+  return GetCell(leaf.code, leaf.level);
+}
+
+Node QuadTree::GetCell(u32 code, Depth level) const {
+  const f32 cells = (f32)(1u << MaxLevel);
+  const float2 cell((f32)Morton::DecodeX(code), (f32)Morton::DecodeZ(code));
+  const float2 size = fullSize / (f32)(1u << level);
+  return {corner + cell / cells * fullSize + size / 2, size};
+}
+
+void QuadTree::GetBounds(const Node &cell, float3 &center,
+                         float3 &extents) const {
+  center = float3(cell.center.x, yCoordinate, cell.center.y) +
+           displacementCenter;
+  extents = float3(cell.size.x / 2, 0.f, cell.size.y / 2) + displacementExtent;
+}
+
+u32 QuadTree::GetKey(u32 code) const {
+  return keyDigits[code & 0xFF] | (keyDigits[(code >> 8) & 0xFF] << 8) |
+         (keyDigits[(code >> 16) & 0xFF] << 16) |
+         (keyDigits[code >> 24] << 24);
+}
+
+u32 QuadTree::FindLeaf(u32 x, u32 z) const {
+  // The leaves cover the plane, the last one starting at or before the cell
+  // covers it. The first key is always 0. Branch free binary search.
+  const u32 key = GetKey(Morton::Encode(x, z));
+  const u32 *base = keys.data();
+  u32 n = (u32)keys.size();
+  while (n > 1) {
+    const u32 half = n / 2;
+    base = base[half] <= key ? base + half : base;
+    n -= half;
+  }
+  return (u32)(base - keys.data());
+}
+
+// Split decisions of up to four cells of one level, with the motion after
+// which they may change. The distance to the eye changes at most by the eye
+// travel. The margin of a box against a plane changes at most by
+// |dn| * (|center - eye| + radius) + |dn * eye - dd| when the plane moves,
+// and the distance to the eye is bounded while the eye travel is: the
+// nodes tested against the frustum allow TravelShare of it at most.
+void QuadTree::Evaluate(const u32 *codes, u32 count, Depth level,
+                        FrustumCuller::PlaneMask skip, const float3 &camEye,
+                        Decision *out) const {
+  constexpr u32 Block = FrustumCuller::BlockSize;
+  std::array<f32, Block> centerX{}, centerY{}, centerZ{};
+  std::array<f32, Block> extentX{}, extentY{}, extentZ{};
+  std::array<f32, Block> eyeMargins{};
+  std::array<bool, Block> tested{};
+  bool anyTested = false;
+  for (u32 k = 0; k < count; ++k) {
+    out[k] = {false, skip, {Never, Never, Never}};
+    if (level > maxDepth)
+      continue;
+    const Node node = GetCell(codes[k], level);
+    const float3 diff = {node.center.x - camEye.x, yCoordinate - camEye.y,
+                         node.center.y - camEye.z};
+    const f32 area = node.size.x * node.size.y;
+    const bool cont = dot(diff, diff) / area < distanceThreshold;
+    eyeMargins[k] = std::max(
+        0.f, std::abs(length(diff) - std::sqrt(distanceThreshold * area)) -
+                 MarginEpsilon);
+    out[k].limits[EyeTravel] = motion[EyeTravel] + eyeMargins[k];
+
+    tested[k] = cont || level < minDepth;
+    anyTested = anyTested || tested[k];
+    float3 center, extents;
+    GetBounds(node, center, extents);
+    centerX[k] = center.x;
+    centerY[k] = center.y;
+    centerZ[k] = center.z;
+    extentX[k] = extents.x;
+    extentY[k] = extents.y;
+    extentZ[k] = extents.z;
+  }
+  if (!anyTested)
+    return;
+
+  std::array<FrustumCuller::Visibility, Block> visibility;
+  culler.Test({centerX.data(), centerY.data(), centerZ.data(), extentX.data(),
+               extentY.data(), extentZ.data()},
+              count, skip, visibility.data());
+  for (u32 k = 0; k < count; ++k) {
+    if (!tested[k])
+      continue;
+    const auto &vis = visibility[k];
+    const f32 margin = std::max(0.f, vis.margin - MarginEpsilon);
+    const float3 center =
+        TransformCoord({centerX[k], centerY[k], centerZ[k]}, modelMatrix);
+    const f32 distance =
+        length(center - camEye) +
+        length(float3(extentX[k] * axisScale.x, extentY[k] * axisScale.y,
+                      extentZ[k] * axisScale.z));
+    const f32 travel = std::min(eyeMargins[k], distance * TravelShare);
+    const f32 reach = distance + travel;
+    out[k].split = vis.visible;
+    out[k].inside = vis.inside;
+    out[k].limits[EyeTravel] = motion[EyeTravel] + travel;
+    out[k].limits[NormalTurn] = motion[NormalTurn] + margin / 2 / reach;
+    out[k].limits[PlaneShift] = motion[PlaneShift] + margin / 2;
+  }
+}
+
+TravelOrder::TravelOrder(const float3 &camForward, const float4x4 &mMatrix) {
+  const float3 forwardXZ =
+      normalize(float3(camForward.x, 0.0f, camForward.z));
+
+  const float3 camBasedOffset = {camForward.x >= 0 ? 1.f : -1.f, 0.f,
+                                 camForward.z >= 0 ? 1.f : -1.f};
+  std::array<float, 4> values;
+  for (int i = 0; i < 4; ++i) {
+    // World space coordinates of the plane centers
+    float3 curr = TransformCoord(float3(Node::childDirections[i].x / 2.f, 0.0f,
+                                        Node::childDirections[i].y / 2.f),
+                                 mMatrix);
+    curr += camBasedOffset;
+    // Cam is at 0,0,0
+
+    // we want high dot and low length
+    // we could play around with dot^n and length^(-m)
+    float len = length(curr);
+    float d = dot(curr, forwardXZ);
+
+    values[i] = 1.0f / (d * len * len);
+  }
+
+  std::ranges::sort(children,
+                    [&values](u32 a, u32 b) { return values[a] > values[b]; });
+  for (u32 i = 0; i < 4; ++i)
+    ranks[children[i]] = i;
+}
+} // namespace Ocean
@@ -0,0 +1,339 @@
+#pragma once
+#include <array>
+#include <span>
+#include <vector>
+#include "../Math/Vector.h"
+#include "../Culling/Frustum.h"
+#include "../Culling/FrustumCuller.h"
+
+namespace Ocean {
+class ThreadPool;
+
+using NodeCenter = float2;
+using NodeSize = float2;
+// Index of a child in its parent, see Node::childDirections.
+using ChildrenID = u32;
+using Depth = u32;
+
+struct Node {
+  NodeCenter center = {0, 0};
+  NodeSize size = {0, 0};
+
+  constexpr static std::array<NodeSize, 4> childDirections = {
+      {{-1.f, -1.f}, {-1.f, 1.f}, {1.f, -1.f}, {1.f, 1.f}}};
+
+  /*
+
+     ^   2 3
+     |   0 1
+    xpos
+     0 zpos ->
+
+  */
+
+  const float3 GetCenter(const float height) const {
+    return float3(center.x, height, center.y);
+  }
+};
+
+// Morton codes of the cells of a 2^n x 2^n grid: the bits of x and z
+// interleaved, x in the odd bits. A 2 bit digit of the code is the child
+// index of Node::childDirections, 2 * (x > center) + (z > center).
+namespace Morton {
+constexpr u32 Spread(u32 v) {
+  v &= 0xFFFF;
+  v = (v | (v << 8)) & 0x00FF00FF;
+  v = (v | (v << 4)) & 0x0F0F0F0F;
+  v = (v | (v << 2)) & 0x33333333;
+  v = (v | (v << 1)) & 0x55555555;
+  return v;
+}
+
+constexpr u32 Compact(u32 v) {
+  v &= 0x55555555;
+  v = (v | (v >> 1)) & 0x33333333;
+  v = (v | (v >> 2)) & 0x0F0F0F0F;
+  v = (v | (v >> 4)) & 0x00FF00FF;
+  v = (v | (v >> 8)) & 0x0000FFFF;
+  return v;
+}
+
+constexpr u32 Encode(u32 x, u32 z) { return (Spread(x) << 1) | Spread(z); }
+constexpr u32 DecodeX(u32 code) { return Compact(code >> 1); }
+constexpr u32 DecodeZ(u32 code) { return Compact(code); }
+} // namespace Morton
+
+// Order of the children at every level, front to back from the camera.
+struct TravelOrder {
+  TravelOrder() = default;
+  TravelOrder(const float3 &camDir, const float4x4 &mMatrix);
+
+  // The children in travel order, and the position of each child in it.
+  std::array<ChildrenID, 4> children = {0, 1, 2, 3};
+  std::array<u32, 4> ranks = {0, 1, 2, 3};
+};
+
+// The plane must be perpendicular to the Y-axis.
+//
+// The tree is stored as nodes linking to their children: each node holds
+// the handle of its first child, and the four children of a node are one
+// block of a node pool. Released blocks go to a free list of their pool and
+// are reused by the next splits. A node is a cell of the 2^level x 2^level
+// grid over the plane, identified by its level and its location code, the
+// Morton code of its corner cell on the finest grid (MaxLevel).
+//
+// The leaves are not kept in the tree: every build or update emits them into
+// one array in travel order, with their keys, the location codes with every
+// digit replaced by its rank in the travel order, in a second one. The keys
+// are sorted, so the leaf covering any cell of the finest grid is one binary
+// search away.
+//
+// The split decisions are made top down, for the four children of a node
+// at once. The frustum
+// planes are moved into model space once per build, and a node passes the
+// planes it is entirely in front of down to its children. Bottom up, every
+// node learns the level of the leaf at each of its corners, so the neighbour
+// ratios of the leaves are resolved while they are emitted and stored with
+// them.
+//
+// Update keeps the tree of the previous call. Every node knows how far the
+// camera may move before its split decision can change, the subtrees keep
+// the closest of these limits, and only the subtrees past it are visited.
+// Nothing is cleared between builds, the arrays keep their capacity.
+//
+// The subtrees below the nodes of SubtreeLevel have a pool each, so they are
+// refreshed and emitted in parallel when a pool of threads is given and the
+// tree has at least ParallelLeaves leaves. Their leaf counts give the offset
+// of their leaves, the output does not depend on the scheduling.
+class QuadTree {
+public:
+  struct Defaults {
+    static constexpr Depth maxDepth = 5;
+    static constexpr Depth minDepth = 0;
+    static constexpr float DistanceThreshold = 2e+2f;
+  };
+
+  // Finest level of the location codes, 2 bits per level. The leaves are
+  // at most one level below maxDepth, so maxDepth is clamped to
+  // MaxLevel - 1.
+  static constexpr Depth MaxLevel = 15;
+  // The descendants of each node of this level are refreshed and emitted as
+  // one task.
+  static constexpr Depth SubtreeLevel = 2;
+  static constexpr u32 SubtreeCount = 1u << (2 * SubtreeLevel);
+  // Smaller trees take a few microseconds, less than waking the threads of
+  // a pool, and are refreshed and emitted on the calling thread. Refresh
+  // goes by the leaves of the previous build.
+  static constexpr u32 ParallelLeaves = 4096;
+
+  // Level of the neighbours across the four edges of a leaf, from the
+  // neighbour leaf next to the first corner of each edge.
+  // If the neighbor is bigger or same size, its 1
+  // No neighbor = 0
+  // Else ratio from that to this <==> if it is half the size of this, its 2
+  struct SmallerNeighborRatio {
+    float xpos;
+    float xneg;
+    float zneg;
+    float zpos;
+  };
+
+  struct Leaf {
+    u32 code;
+    Depth level;
+    SmallerNeighborRatio neighbors;
+  };
+
+  void
+  Build(const float3 &center, const float2 &fullSizeXZ, const float3 &camEye,
+        const float3 &camDir, const Frustum &f, const float4x4 &mMatrix,
+        const float &quadTreeDistanceThreshold = Defaults::DistanceThreshold,
+        Depth MaxDepth = Defaults::maxDepth, ThreadPool *pool = nullptr);
+
+  // Builds the tree of at most leafBudget leaves that resolves the plane
+  // best: the visible leaf of the largest projected size is split until one
+  // more split would pass the budget. The tree has leafBudget, leafBudget - 1
+  // or leafBudget - 2 leaves unless every visible leaf is at maxDepth + 1.
+  void BuildBudgeted(const float3 &center, const float2 &fullSizeXZ,
+                     const float3 &camEye, const float3 &camDir,
+                     const Frustum &f, const float4x4 &mMatrix, u32 leafBudget,
+                     Depth MaxDepth = Defaults::maxDepth,
+                     ThreadPool *pool = nullptr);
+
+  // Same as Build, reusing the tree of the previous call. Falls back to
+  // Build on the first call, after BuildBudgeted, or when anything but the
+  // camera changed.
+  void
+  Update(const float3 &center, const float2 &fullSizeXZ, const float3 &camEye,
+         const float3 &camDir, const Frustum &f, const float4x4 &mMatrix,
+         const float &quadTreeDistanceThreshold = Defaults::DistanceThreshold,
+         Depth MaxDepth = Defaults::maxDepth, ThreadPool *pool = nullptr);
+
+  // Offsets the vertices of the plane may be moved by, in model space: a
+  // point p of the plane ends up within [p + low, p + high]. The boxes
+  // culled against the frustum are grown by these, the split distances are
+  // measured to the plane at rest. The next Update rebuilds the tree if
+  // they changed.
+  void SetDisplacement(const float3 &low, const float3 &high);
+
+  // The leaves in travel order.
+  std::span<const Leaf> GetLeaves() const { return leaves; }
+  u32 GetLeafCount() const { return (u32)leaves.size(); }
+  Node GetNode(const Leaf &leaf) const;
+  // Number of nodes of the tree, the leaves and all their ancestors.
+  u32 GetSize() const;
+  // Nodes evaluated, created or released by the last Build or Update.
+  u32 GetTouched() const;
+  Depth GetHeight() const { return height; }
+  const TravelOrder &GetOrder() const { return order; }
+
+  // Index of the leaf covering the cell (x, z) of the finest grid.
+  u32 FindLeaf(u32 x, u32 z) const;
+
+  const SmallerNeighborRatio &GetSmallerNeighbor(u32 leafIndex) const {
+    return leaves[leafIndex].neighbors;
+  }
+
+private:
+  // Edges, in the order of SmallerNeighborRatio.
+  enum Edge : u32 { XPos, XNeg, ZNeg, ZPos };
+  // Nodes are referred to by their pool in the high bits and their index in
+  // it. Pool 0 holds the levels up to SubtreeLevel, pool 1 + s the
+  // descendants of the node s of SubtreeLevel, in Morton order.
+  static constexpr u32 IndexBits = 24;
+  static constexpr u32 IndexMask = (1u << IndexBits) - 1;
+  // Neighbour handles past the nodes: the edge of the plane, and a bigger
+  // leaf.
+  static constexpr u32 NoNeighbor = ~0u;
+  static constexpr u32 BiggerNeighbor = ~0u - 1;
+
+  // How far the camera moved since the last Build: the distance travelled
+  // by the eye, and the sums of the largest change of the frustum plane
+  // normals and of their offsets from the eye.
+  enum Motion : u32 { EyeTravel, NormalTurn, PlaneShift, MotionCount };
+  using MotionLimits = std::array<f64, MotionCount>;
+
+  // The four children of a node are contiguous, in the same pool.
+  struct TreeNode {
+    u32 code;
+    // Handle of child 0, 0 for leaves.
+    u32 firstChild;
+    // Leaves of the subtree.
+    u32 leafCount;
+    u8 level;
+    // Planes the node is entirely in front of, its children skip them.
+    FrustumCuller::PlaneMask inside;
+    // Level of the leaf at the corner of child c, following child c down.
+    std::array<u8, 4> cornerLevels;
+    // The split decision of no node of the subtree changes while the motion
+    // stays within these.
+    MotionLimits expiry;
+  };
+
+  struct Pool {
+    std::vector<TreeNode> nodes;
+    // First nodes of the released blocks of children.
+    std::vector<u32> freeBlocks;
+    u32 touched = 0;
+  };
+
+  // A node of at most SubtreeLevel emitted as one task, with its neighbours.
+  struct Subtree {
+    u32 node;
+    std::array<u32, 4> neighbors;
+    u32 firstLeaf;
+  };
+
+  struct Decision {
+    bool split;
+    FrustumCuller::PlaneMask inside;
+    MotionLimits limits;
+  };
+
+  // A visible leaf BuildBudgeted may split. Ties go to the first node.
+  struct Candidate {
+    f32 priority;
+    u32 node;
+    bool operator<(const Candidate &other) const {
+      return priority < other.priority ||
+             (priority == other.priority && node > other.node);
+    }
+  };
+
+  Node GetCell(u32 code, Depth level) const;
+  // The box a cell may occupy, displaced, in model space.
+  void GetBounds(const Node &cell, float3 &center, float3 &extents) const;
+  void SetParameters(const float3 &center, const float2 &fullSizeXZ,
+                     const float3 &camDir, const Frustum &f,
+                     const float4x4 &mMatrix,
+                     const float &quadTreeDistanceThreshold, Depth MaxDepth);
+  bool IsExpired(const MotionLimits &limits) const;
+  void Evaluate(const u32 *codes, u32 count, Depth level,
+                FrustumCuller::PlaneMask skip, const float3 &camEye,
+                Decision *out) const;
+  void Reset(const float3 &camEye, const Frustum &f);
+  void Refresh(const float3 &camEye, ThreadPool *pool);
+  void Refine(const float3 &camEye);
+  void Offer(u32 first, u32 count, FrustumCuller::PlaneMask skip,
+             const float3 &camEye);
+  void Settle(u32 handle, const Decision &decision, const float3 &camEye);
+  void RefreshChildren(u32 parent, const float3 &camEye);
+  void Gather(u32 handle, const MotionLimits &limits);
+  void GatherTrunk(u32 handle);
+  void GatherAll(u32 handle);
+  u32 AllocateChildren(u32 parent);
+  void ReleaseChildren(u32 firstChild);
+  u32 Across(u32 neighbor, ChildrenID child) const;
+  std::array<u32, 4> ChildNeighbors(u32 firstChild, ChildrenID child,
+                                    const std::array<u32, 4> &parent) const;
+  void EmitLeaves(ThreadPool *pool);
+  Depth EmitSubtree(const Subtree &subtree);
+  u32 GetKey(u32 code) const;
+
+  TreeNode &At(u32 handle) {
+    return pools[handle >> IndexBits].nodes[handle & IndexMask];
+  }
+  const TreeNode &At(u32 handle) const {
+    return pools[handle >> IndexBits].nodes[handle & IndexMask];
+  }
+
+  std::array<Pool, SubtreeCount + 1> pools;
+  // Limits of the decisions of the nodes of pool 0 alone, they are gathered
+  // after the subtrees.
+  std::vector<MotionLimits> trunkLimits;
+  // Nodes of SubtreeLevel whose children are to be refreshed.
+  std::vector<u32> pending;
+  // Max heap of the leaves of BuildBudgeted.
+  std::vector<Candidate> candidates;
+  std::vector<Subtree> subtrees;
+  std::vector<Depth> subtreeHeights;
+  std::vector<Leaf> leaves;
+  std::vector<u32> keys;
+  // Digits of the key of each byte of a location code.
+  std::array<u8, 256> keyDigits{};
+
+  MotionLimits motion{};
+  float3 lastEye = {0, 0, 0};
+  Frustum lastFrustum;
+  // The tree was built with other displacement bounds.
+  bool displacementChanged = false;
+
+  float2 corner = {0, 0};
+  float2 fullSize = {0, 0};
+  float yCoordinate = 0;
+  float4x4 modelMatrix;
+  // Lengths of the model axes in world space.
+  float3 axisScale = {1, 1, 1};
+  // Center and half size of the displacement range.
+  float3 displacementCenter = {0, 0, 0};
+  float3 displacementExtent = {0, 0, 0};
+  FrustumCuller culler;
+  float distanceThreshold = Defaults::DistanceThreshold;
+  // 0 when the tree was refined by the distance threshold.
+  u32 leafBudget = 0;
+  Depth height = 0;
+  Depth maxDepth = Defaults::maxDepth;
+  Depth minDepth = Defaults::minDepth;
+  TravelOrder order;
+};
+} // namespace Ocean
@@ -0,0 +1,511 @@
+#pragma once
+#include <cmath>
+#include "../Typedefs.h"
+
+// Portable SIMD layer for the CPU simulation kernels.
+//
+// f32v is the widest vector the target supports (AVX2: 8 lanes, SSE2 and
+// NEON: 4 lanes), f32x1 is a single lane with the exact same interface. The
+// kernels are written once as templates over the vector type, the f32x1
+// instantiation handles the tails and the edges.
+//
+// Only include this from translation units of Ocean.Core: the selected
+// backend depends on the compile flags of the including file.
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#define OCEAN_SIMD_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCEAN_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define OCEAN_SIMD_NEON 1
+#include <arm_neon.h>
+#else
+#define OCEAN_SIMD_SCALAR 1
+#endif
+
+namespace Ocean::Simd {
+struct f32x1 {
+  static constexpr u32 Width = 1;
+  f32 v;
+
+  static f32x1 Load(const f32 *p) { return {*p}; }
+  static f32x1 Broadcast(f32 x) { return {x}; }
+  static f32x1 Zero() { return {0.f}; }
+  // {start, start + 1, ...}
+  static f32x1 Iota(f32 start) { return {start}; }
+  void Store(f32 *p) const { *p = v; }
+
+  struct mask {
+    bool m;
+  };
+};
+
+inline f32x1 operator+(f32x1 a, f32x1 b) { return {a.v + b.v}; }
+inline f32x1 operator-(f32x1 a, f32x1 b) { return {a.v - b.v}; }
+inline f32x1 operator*(f32x1 a, f32x1 b) { return {a.v * b.v}; }
+inline f32x1 operator/(f32x1 a, f32x1 b) { return {a.v / b.v}; }
+inline f32x1 operator-(f32x1 a) { return {-a.v}; }
+// a * b + c
+inline f32x1 MulAdd(f32x1 a, f32x1 b, f32x1 c) { return {a.v * b.v + c.v}; }
+// c - a * b
+inline f32x1 NegMulAdd(f32x1 a, f32x1 b, f32x1 c) { return {c.v - a.v * b.v}; }
+inline f32x1 Min(f32x1 a, f32x1 b) { return {a.v < b.v ? a.v : b.v}; }
+inline f32x1 Max(f32x1 a, f32x1 b) { return {a.v > b.v ? a.v : b.v}; }
+inline f32x1 Sqrt(f32x1 a) { return {std::sqrt(a.v)}; }
+inline f32x1 Floor(f32x1 a) { return {std::floor(a.v)}; }
+// x * 2^n for integral n in [-126, 127].
+inline f32x1 Ldexp(f32x1 x, f32x1 n) { return {std::ldexp(x.v, (int)n.v)}; }
+// Mantissa in [0.5, 1) and exponent of a positive normal x.
+inline f32x1 Frexp(f32x1 x, f32x1 &exponent) {
+  int e;
+  const f32 m = std::frexp(x.v, &e);
+  exponent.v = (f32)e;
+  return {m};
+}
+inline f32x1::mask CmpGt(f32x1 a, f32x1 b) { return {a.v > b.v}; }
+inline f32x1::mask CmpGe(f32x1 a, f32x1 b) { return {a.v >= b.v}; }
+inline f32x1::mask CmpEq(f32x1 a, f32x1 b) { return {a.v == b.v}; }
+inline f32x1::mask operator|(f32x1::mask a, f32x1::mask b) {
+  return {a.m || b.m};
+}
+inline f32x1 Select(f32x1::mask m, f32x1 a, f32x1 b) { return m.m ? a : b; }
+// Transposes a Width x Width block held as Width row vectors.
+inline void Transpose(f32x1 (&)[1]) {}
+// Lanes in reverse order.
+inline f32x1 Reverse(f32x1 a) { return a; }
+// a0 b0 a1 b1 ... in lo, then hi.
+inline void Interleave(f32x1 a, f32x1 b, f32x1 &lo, f32x1 &hi) {
+  lo = a;
+  hi = b;
+}
+
+// 32 bit integer lanes, as many as f32x1 and f32v, for the random number
+// generators.
+struct u32x1 {
+  static constexpr u32 Width = 1;
+  u32 v;
+
+  static u32x1 Broadcast(u32 x) { return {x}; }
+  static u32x1 Iota(u32 start) { return {start}; }
+};
+
+inline u32x1 operator^(u32x1 a, u32x1 b) { return {a.v ^ b.v}; }
+// The high and the low half of the 64 bit products.
+inline void MulWide(u32x1 a, u32x1 b, u32x1 &hi, u32x1 &lo) {
+  const u64 p = (u64)a.v * b.v;
+  hi.v = (u32)(p >> 32);
+  lo.v = (u32)p;
+}
+// The upper 24 bits of each lane, exact as a float.
+inline f32x1 Top24(u32x1 a) { return {(f32)(a.v >> 8)}; }
+
+#if OCEAN_SIMD_AVX2
+struct f32v {
+  static constexpr u32 Width = 8;
+  __m256 v;
+
+  static f32v Load(const f32 *p) { return {_mm256_loadu_ps(p)}; }
+  static f32v Broadcast(f32 x) { return {_mm256_set1_ps(x)}; }
+  static f32v Zero() { return {_mm256_setzero_ps()}; }
+  static f32v Iota(f32 start) {
+    return {_mm256_add_ps(_mm256_set1_ps(start),
+                          _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7))};
+  }
+  void Store(f32 *p) const { _mm256_storeu_ps(p, v); }
+
+  struct mask {
+    __m256 m;
+  };
+};
+
+inline f32v operator+(f32v a, f32v b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline f32v operator-(f32v a, f32v b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline f32v operator*(f32v a, f32v b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline f32v operator/(f32v a, f32v b) { return {_mm256_div_ps(a.v, b.v)}; }
+inline f32v operator-(f32v a) {
+  return {_mm256_xor_ps(a.v, _mm256_set1_ps(-0.f))};
+}
+inline f32v MulAdd(f32v a, f32v b, f32v c) {
+  return {_mm256_fmadd_ps(a.v, b.v, c.v)};
+}
+inline f32v NegMulAdd(f32v a, f32v b, f32v c) {
+  return {_mm256_fnmadd_ps(a.v, b.v, c.v)};
+}
+inline f32v Min(f32v a, f32v b) { return {_mm256_min_ps(a.v, b.v)}; }
+inline f32v Max(f32v a, f32v b) { return {_mm256_max_ps(a.v, b.v)}; }
+inline f32v Sqrt(f32v a) { return {_mm256_sqrt_ps(a.v)}; }
+inline f32v Floor(f32v a) { return {_mm256_floor_ps(a.v)}; }
+inline f32v Ldexp(f32v x, f32v n) {
+  const __m256i e = _mm256_slli_epi32(
+      _mm256_add_epi32(_mm256_cvtps_epi32(n.v), _mm256_set1_epi32(127)), 23);
+  return {_mm256_mul_ps(x.v, _mm256_castsi256_ps(e))};
+}
+inline f32v Frexp(f32v x, f32v &exponent) {
+  const __m256i bits = _mm256_castps_si256(x.v);
+  exponent.v = _mm256_cvtepi32_ps(
+      _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+  const __m256 mantissa =
+      _mm256_and_ps(x.v, _mm256_castsi256_ps(_mm256_set1_epi32(0x807FFFFF)));
+  return {_mm256_or_ps(mantissa, _mm256_set1_ps(0.5f))};
+}
+inline f32v::mask CmpGt(f32v a, f32v b) {
+  return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)};
+}
+inline f32v::mask CmpGe(f32v a, f32v b) {
+  return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)};
+}
+inline f32v::mask CmpEq(f32v a, f32v b) {
+  return {_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ)};
+}
+inline f32v::mask operator|(f32v::mask a, f32v::mask b) {
+  return {_mm256_or_ps(a.m, b.m)};
+}
+inline f32v Select(f32v::mask m, f32v a, f32v b) {
+  return {_mm256_blendv_ps(b.v, a.v, m.m)};
+}
+inline void Transpose(f32v (&r)[8]) {
+  const __m256 t0 = _mm256_unpacklo_ps(r[0].v, r[1].v);
+  const __m256 t1 = _mm256_unpackhi_ps(r[0].v, r[1].v);
+  const __m256 t2 = _mm256_unpacklo_ps(r[2].v, r[3].v);
+  const __m256 t3 = _mm256_unpackhi_ps(r[2].v, r[3].v);
+  const __m256 t4 = _mm256_unpacklo_ps(r[4].v, r[5].v);
+  const __m256 t5 = _mm256_unpackhi_ps(r[4].v, r[5].v);
+  const __m256 t6 = _mm256_unpacklo_ps(r[6].v, r[7].v);
+  const __m256 t7 = _mm256_unpackhi_ps(r[6].v, r[7].v);
+  const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+  r[0].v = _mm256_permute2f128_ps(u0, u4, 0x20);
+  r[1].v = _mm256_permute2f128_ps(u1, u5, 0x20);
+  r[2].v = _mm256_permute2f128_ps(u2, u6, 0x20);
+  r[3].v = _mm256_permute2f128_ps(u3, u7, 0x20);
+  r[4].v = _mm256_permute2f128_ps(u0, u4, 0x31);
+  r[5].v = _mm256_permute2f128_ps(u1, u5, 0x31);
+  r[6].v = _mm256_permute2f128_ps(u2, u6, 0x31);
+  r[7].v = _mm256_permute2f128_ps(u3, u7, 0x31);
+}
+inline f32v Reverse(f32v a) {
+  return {
+      _mm256_permutevar8x32_ps(a.v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0))};
+}
+inline void Interleave(f32v a, f32v b, f32v &lo, f32v &hi) {
+  const __m256 t0 = _mm256_unpacklo_ps(a.v, b.v);
+  const __m256 t1 = _mm256_unpackhi_ps(a.v, b.v);
+  lo.v = _mm256_permute2f128_ps(t0, t1, 0x20);
+  hi.v = _mm256_permute2f128_ps(t0, t1, 0x31);
+}
+struct u32v {
+  static constexpr u32 Width = 8;
+  __m256i v;
+
+  static u32v Broadcast(u32 x) { return {_mm256_set1_epi32((int)x)}; }
+  static u32v Iota(u32 start) {
+    return {_mm256_add_epi32(_mm256_set1_epi32((int)start),
+                             _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7))};
+  }
+};
+
+inline u32v operator^(u32v a, u32v b) { return {_mm256_xor_si256(a.v, b.v)}; }
+inline void MulWide(u32v a, u32v b, u32v &hi, u32v &lo) {
+  const __m256i even = _mm256_mul_epu32(a.v, b.v);
+  const __m256i odd =
+      _mm256_mul_epu32(_mm256_srli_epi64(a.v, 32), _mm256_srli_epi64(b.v, 32));
+  lo.v = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+  hi.v = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+inline f32v Top24(u32v a) {
+  return {_mm256_cvtepi32_ps(_mm256_srli_epi32(a.v, 8))};
+}
+#elif OCEAN_SIMD_SSE2
+struct f32v {
+  static constexpr u32 Width = 4;
+  __m128 v;
+
+  static f32v Load(const f32 *p) { return {_mm_loadu_ps(p)}; }
+  static f32v Broadcast(f32 x) { return {_mm_set1_ps(x)}; }
+  static f32v Zero() { return {_mm_setzero_ps()}; }
+  static f32v Iota(f32 start) {
+    return {_mm_add_ps(_mm_set1_ps(start), _mm_setr_ps(0, 1, 2, 3))};
+  }
+  void Store(f32 *p) const { _mm_storeu_ps(p, v); }
+
+  struct mask {
+    __m128 m;
+  };
+};
+
+inline f32v operator+(f32v a, f32v b) { return {_mm_add_ps(a.v, b.v)}; }
+inline f32v operator-(f32v a, f32v b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline f32v operator*(f32v a, f32v b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline f32v operator/(f32v a, f32v b) { return {_mm_div_ps(a.v, b.v)}; }
+inline f32v operator-(f32v a) { return {_mm_xor_ps(a.v, _mm_set1_ps(-0.f))}; }
+inline f32v MulAdd(f32v a, f32v b, f32v c) { return a * b + c; }
+inline f32v NegMulAdd(f32v a, f32v b, f32v c) { return c - a * b; }
+inline f32v Min(f32v a, f32v b) { return {_mm_min_ps(a.v, b.v)}; }
+inline f32v Max(f32v a, f32v b) { return {_mm_max_ps(a.v, b.v)}; }
+inline f32v Sqrt(f32v a) { return {_mm_sqrt_ps(a.v)}; }
+inline f32v::mask CmpGt(f32v a, f32v b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+inline f32v::mask CmpGe(f32v a, f32v b) { return {_mm_cmpge_ps(a.v, b.v)}; }
+inline f32v::mask CmpEq(f32v a, f32v b) { return {_mm_cmpeq_ps(a.v, b.v)}; }
+inline f32v::mask operator|(f32v::mask a, f32v::mask b) {
+  return {_mm_or_ps(a.m, b.m)};
+}
+inline f32v Select(f32v::mask m, f32v a, f32v b) {
+  return {_mm_or_ps(_mm_and_ps(m.m, a.v), _mm_andnot_ps(m.m, b.v))};
+}
+inline void Transpose(f32v (&r)[4]) {
+  _MM_TRANSPOSE4_PS(r[0].v, r[1].v, r[2].v, r[3].v);
+}
+inline f32v Reverse(f32v a) {
+  return {_mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(0, 1, 2, 3))};
+}
+inline void Interleave(f32v a, f32v b, f32v &lo, f32v &hi) {
+  lo.v = _mm_unpacklo_ps(a.v, b.v);
+  hi.v = _mm_unpackhi_ps(a.v, b.v);
+}
+// SSE2 has no rounding instruction, truncate and fix up negative values.
+// Only valid within the int32 range, which the kernels never leave.
+inline f32v Floor(f32v a) {
+  const f32v t = {_mm_cvtepi32_ps(_mm_cvttps_epi32(a.v))};
+  return Select(CmpGt(t, a), t - f32v::Broadcast(1.f), t);
+}
+inline f32v Ldexp(f32v x, f32v n) {
+  const __m128i e = _mm_slli_epi32(
+      _mm_add_epi32(_mm_cvtps_epi32(n.v), _mm_set1_epi32(127)), 23);
+  return {_mm_mul_ps(x.v, _mm_castsi128_ps(e))};
+}
+inline f32v Frexp(f32v x, f32v &exponent) {
+  const __m128i bits = _mm_castps_si128(x.v);
+  exponent.v = _mm_cvtepi32_ps(
+      _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+  const __m128 mantissa =
+      _mm_and_ps(x.v, _mm_castsi128_ps(_mm_set1_epi32(0x807FFFFF)));
+  return {_mm_or_ps(mantissa, _mm_set1_ps(0.5f))};
+}
+struct u32v {
+  static constexpr u32 Width = 4;
+  __m128i v;
+
+  static u32v Broadcast(u32 x) { return {_mm_set1_epi32((int)x)}; }
+  static u32v Iota(u32 start) {
+    return {_mm_add_epi32(_mm_set1_epi32((int)start),
+                          _mm_setr_epi32(0, 1, 2, 3))};
+  }
+};
+
+inline u32v operator^(u32v a, u32v b) { return {_mm_xor_si128(a.v, b.v)}; }
+inline void MulWide(u32v a, u32v b, u32v &hi, u32v &lo) {
+  const __m128i even = _mm_mul_epu32(a.v, b.v);
+  const __m128i odd =
+      _mm_mul_epu32(_mm_srli_epi64(a.v, 32), _mm_srli_epi64(b.v, 32));
+  const __m128i oddLanes = _mm_setr_epi32(0, -1, 0, -1);
+  lo.v = _mm_or_si128(_mm_andnot_si128(oddLanes, even),
+                      _mm_slli_epi64(odd, 32));
+  hi.v = _mm_or_si128(_mm_srli_epi64(even, 32), _mm_and_si128(oddLanes, odd));
+}
+inline f32v Top24(u32v a) { return {_mm_cvtepi32_ps(_mm_srli_epi32(a.v, 8))}; }
+#elif OCEAN_SIMD_NEON
+struct f32v {
+  static constexpr u32 Width = 4;
+  float32x4_t v;
+
+  static f32v Load(const f32 *p) { return {vld1q_f32(p)}; }
+  static f32v Broadcast(f32 x) { return {vdupq_n_f32(x)}; }
+  static f32v Zero() { return {vdupq_n_f32(0.f)}; }
+  static f32v Iota(f32 start) {
+    static const f32 offsets[4] = {0, 1, 2, 3};
+    return {vaddq_f32(vdupq_n_f32(start), vld1q_f32(offsets))};
+  }
+  void Store(f32 *p) const { vst1q_f32(p, v); }
+
+  struct mask {
+    uint32x4_t m;
+  };
+};
+
+inline f32v operator+(f32v a, f32v b) { return {vaddq_f32(a.v, b.v)}; }
+inline f32v operator-(f32v a, f32v b) { return {vsubq_f32(a.v, b.v)}; }
+inline f32v operator*(f32v a, f32v b) { return {vmulq_f32(a.v, b.v)}; }
+inline f32v operator/(f32v a, f32v b) { return {vdivq_f32(a.v, b.v)}; }
+inline f32v operator-(f32v a) { return {vnegq_f32(a.v)}; }
+inline f32v MulAdd(f32v a, f32v b, f32v c) { return {vfmaq_f32(c.v, a.v, b.v)}; }
+inline f32v NegMulAdd(f32v a, f32v b, f32v c) {
+  return {vfmsq_f32(c.v, a.v, b.v)};
+}
+inline f32v Min(f32v a, f32v b) { return {vminq_f32(a.v, b.v)}; }
+inline f32v Max(f32v a, f32v b) { return {vmaxq_f32(a.v, b.v)}; }
+inline f32v Sqrt(f32v a) { return {vsqrtq_f32(a.v)}; }
+inline f32v Floor(f32v a) { return {vrndmq_f32(a.v)}; }
+inline f32v Ldexp(f32v x, f32v n) {
+  const int32x4_t e =
+      vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n.v), vdupq_n_s32(127)), 23);
+  return {vmulq_f32(x.v, vreinterpretq_f32_s32(e))};
+}
+inline f32v Frexp(f32v x, f32v &exponent) {
+  const uint32x4_t bits = vreinterpretq_u32_f32(x.v);
+  exponent.v = vcvtq_f32_s32(vsubq_s32(
+      vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(126)));
+  const uint32x4_t mantissa = vandq_u32(bits, vdupq_n_u32(0x807FFFFF));
+  return {vreinterpretq_f32_u32(
+      vorrq_u32(mantissa, vreinterpretq_u32_f32(vdupq_n_f32(0.5f))))};
+}
+inline f32v::mask CmpGt(f32v a, f32v b) { return {vcgtq_f32(a.v, b.v)}; }
+inline f32v::mask CmpGe(f32v a, f32v b) { return {vcgeq_f32(a.v, b.v)}; }
+inline f32v::mask CmpEq(f32v a, f32v b) { return {vceqq_f32(a.v, b.v)}; }
+inline f32v::mask operator|(f32v::mask a, f32v::mask b) {
+  return {vorrq_u32(a.m, b.m)};
+}
+inline f32v Select(f32v::mask m, f32v a, f32v b) {
+  return {vbslq_f32(m.m, a.v, b.v)};
+}
+inline void Transpose(f32v (&r)[4]) {
+  const float32x4x2_t t01 = vtrnq_f32(r[0].v, r[1].v);
+  const float32x4x2_t t23 = vtrnq_f32(r[2].v, r[3].v);
+  r[0].v = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+  r[1].v = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+  r[2].v = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+  r[3].v = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+inline f32v Reverse(f32v a) {
+  const float32x4_t r = vrev64q_f32(a.v);
+  return {vcombine_f32(vget_high_f32(r), vget_low_f32(r))};
+}
+inline void Interleave(f32v a, f32v b, f32v &lo, f32v &hi) {
+  const float32x4x2_t z = vzipq_f32(a.v, b.v);
+  lo.v = z.val[0];
+  hi.v = z.val[1];
+}
+struct u32v {
+  static constexpr u32 Width = 4;
+  uint32x4_t v;
+
+  static u32v Broadcast(u32 x) { return {vdupq_n_u32(x)}; }
+  static u32v Iota(u32 start) {
+    static const u32 offsets[4] = {0, 1, 2, 3};
+    return {vaddq_u32(vdupq_n_u32(start), vld1q_u32(offsets))};
+  }
+};
+
+inline u32v operator^(u32v a, u32v b) { return {veorq_u32(a.v, b.v)}; }
+inline void MulWide(u32v a, u32v b, u32v &hi, u32v &lo) {
+  const uint64x2_t low = vmull_u32(vget_low_u32(a.v), vget_low_u32(b.v));
+  const uint64x2_t high = vmull_u32(vget_high_u32(a.v), vget_high_u32(b.v));
+  const uint32x4x2_t halves =
+      vuzpq_u32(vreinterpretq_u32_u64(low), vreinterpretq_u32_u64(high));
+  lo.v = halves.val[0];
+  hi.v = halves.val[1];
+}
+inline f32v Top24(u32v a) { return {vcvtq_f32_u32(vshrq_n_u32(a.v, 8))}; }
+#else
+using f32v = f32x1;
+using u32v = u32x1;
+#endif
+
+template <typename V> inline V Abs(V a) { return Max(a, -a); }
+
+// sin and cos of x at once. Cephes style: reduce by pi/2 in three parts,
+// then minimax polynomials on [-pi/4, pi/4]. Accurate to a few ulp for
+// |x| < 8192, the error grows slowly beyond that.
+template <typename V> inline void SinCos(V x, V &s, V &c) {
+  const V quadrant = Floor(MulAdd(x, V::Broadcast(0.63661977236f),
+                                  V::Broadcast(0.5f)));
+  V r = NegMulAdd(quadrant, V::Broadcast(1.5703125f), x);
+  r = NegMulAdd(quadrant, V::Broadcast(4.837512969970703125e-4f), r);
+  r = NegMulAdd(quadrant, V::Broadcast(7.54978995489188216e-8f), r);
+
+  const V r2 = r * r;
+  V ps = MulAdd(V::Broadcast(-1.9515295891e-4f), r2,
+                V::Broadcast(8.3321608736e-3f));
+  ps = MulAdd(ps, r2, V::Broadcast(-1.6666654611e-1f));
+  ps = MulAdd(ps * r2, r, r);
+
+  V pc = MulAdd(V::Broadcast(2.443315711809948e-5f), r2,
+                V::Broadcast(-1.388731625493765e-3f));
+  pc = MulAdd(pc, r2, V::Broadcast(4.166664568298827e-2f));
+  pc = MulAdd(pc * r2, r2, NegMulAdd(V::Broadcast(0.5f), r2, V::Broadcast(1.f)));
+
+  // quadrant mod 4
+  const V q = NegMulAdd(Floor(quadrant * V::Broadcast(0.25f)),
+                        V::Broadcast(4.f), quadrant);
+  const auto odd = CmpEq(q, V::Broadcast(1.f)) | CmpEq(q, V::Broadcast(3.f));
+  const V sinAbs = Select(odd, pc, ps);
+  const V cosAbs = Select(odd, ps, pc);
+  s = Select(CmpGe(q, V::Broadcast(2.f)), -sinAbs, sinAbs);
+  c = Select(CmpEq(q, V::Broadcast(1.f)) | CmpEq(q, V::Broadcast(2.f)),
+             -cosAbs, cosAbs);
+}
+
+// e^x, Cephes style: x = n ln(2) + r with |r| <= ln(2) / 2, a polynomial for
+// e^r, then the exponent. Inputs are clamped to the normal range, e^x is
+// 0 below about -87.3.
+template <typename V> inline V Exp(V x) {
+  x = Min(Max(x, V::Broadcast(-87.3f)), V::Broadcast(88.3f));
+  const V n = Floor(MulAdd(x, V::Broadcast(1.44269504088896341f),
+                           V::Broadcast(0.5f)));
+  V r = NegMulAdd(n, V::Broadcast(0.693359375f), x);
+  r = NegMulAdd(n, V::Broadcast(-2.12194440e-4f), r);
+
+  V p = MulAdd(V::Broadcast(1.9875691500e-4f), r,
+               V::Broadcast(1.3981999507e-3f));
+  p = MulAdd(p, r, V::Broadcast(8.3334519073e-3f));
+  p = MulAdd(p, r, V::Broadcast(4.1665795894e-2f));
+  p = MulAdd(p, r, V::Broadcast(1.6666665459e-1f));
+  p = MulAdd(p, r, V::Broadcast(5.0000001201e-1f));
+  p = MulAdd(p, r * r, r + V::Broadcast(1.f));
+  const V res = Ldexp(p, n);
+  return Select(CmpGt(x, V::Broadcast(-87.3f)), res, V::Zero());
+}
+
+// Natural logarithm of a positive normal x, Cephes style: x = m 2^e with m
+// in [sqrt(0.5), sqrt(2)), then a polynomial in m - 1.
+template <typename V> inline V Log(V x) {
+  V e;
+  V m = Frexp(x, e);
+  const auto small = CmpGt(V::Broadcast(0.707106781186547524f), m);
+  e = Select(small, e - V::Broadcast(1.f), e);
+  m = Select(small, m + m, m) - V::Broadcast(1.f);
+
+  const V z = m * m;
+  V p = MulAdd(V::Broadcast(7.0376836292e-2f), m,
+               V::Broadcast(-1.1514610310e-1f));
+  p = MulAdd(p, m, V::Broadcast(1.1676998740e-1f));
+  p = MulAdd(p, m, V::Broadcast(-1.2420140846e-1f));
+  p = MulAdd(p, m, V::Broadcast(1.4249322787e-1f));
+  p = MulAdd(p, m, V::Broadcast(-1.6668057665e-1f));
+  p = MulAdd(p, m, V::Broadcast(2.0000714765e-1f));
+  p = MulAdd(p, m, V::Broadcast(-2.4999993993e-1f));
+  p = MulAdd(p, m, V::Broadcast(3.3333331174e-1f));
+  V y = p * m * z;
+  y = MulAdd(e, V::Broadcast(-2.12194440e-4f), y);
+  y = NegMulAdd(V::Broadcast(0.5f), z, y);
+  return MulAdd(e, V::Broadcast(0.693359375f), m + y);
+}
+
+// atan2(y, x) in [-pi, pi], Cephes style: reduce to a ratio in [0, 1], then
+// to [-tan(pi / 8), tan(pi / 8)] and a polynomial.
+template <typename V> inline V Atan2(V y, V x) {
+  const V ax = Abs(x);
+  const V ay = Abs(y);
+  const V t = Min(ax, ay) / Max(Max(ax, ay), V::Broadcast(1e-30f));
+  const auto reduce = CmpGt(t, V::Broadcast(0.414213562373095f));
+  const V u = Select(reduce,
+                     (t - V::Broadcast(1.f)) / (t + V::Broadcast(1.f)), t);
+  const V z = u * u;
+  V p = MulAdd(V::Broadcast(8.05374449538e-2f), z,
+               V::Broadcast(-1.38776856032e-1f));
+  p = MulAdd(p, z, V::Broadcast(1.99777106478e-1f));
+  p = MulAdd(p, z, V::Broadcast(-3.33329491539e-1f));
+  V r = MulAdd(p * z, u, u) +
+        Select(reduce, V::Broadcast(0.785398163397448f), V::Zero());
+  r = Select(CmpGt(ay, ax), V::Broadcast(1.57079632679490f) - r, r);
+  r = Select(CmpGt(V::Zero(), x), V::Broadcast(3.14159265358979f) - r, r);
+  return Select(CmpGt(V::Zero(), y), -r, r);
+}
+} // namespace Ocean::Simd
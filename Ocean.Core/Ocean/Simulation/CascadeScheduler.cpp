@@ -0,0 +1,115 @@
+#include "pch.h"
+#include "CascadeScheduler.h"
+
+namespace Ocean {
+namespace {
+// Of the N^2 passes besides the FFTs: the spectrum, the displacement, the
+// gradients and the foam.
+constexpr f64 OtherPasses = 4;
+// Of the moving averages.
+constexpr f64 CostSmoothing = 0.2;
+constexpr f32 IntervalSmoothing = 0.2f;
+} // namespace
+
+CascadeScheduler::CascadeScheduler(std::span<const Cascade> cascades) {
+  for (u32 i = 0; i < cascades.size(); ++i)
+    SetCascade(i, cascades[i]);
+}
+
+void CascadeScheduler::SetCascade(u32 index, const Cascade &cascade) {
+  if (index >= cascades.size())
+    cascades.resize(index + 1);
+  State &state = cascades[index];
+  if (state.cascade.N != cascade.N ||
+      (cascade.enabled && !state.cascade.enabled))
+    state.valid = false;
+  state.cascade = cascade;
+  state.cascade.maxInterval = std::max(cascade.maxInterval, 1u);
+}
+
+void CascadeScheduler::Invalidate(u32 index) { cascades[index].valid = false; }
+
+f64 CascadeScheduler::Weight(u32 N) {
+  return (f64)N * N * (std::log2((f64)N) + OtherPasses);
+}
+
+const CascadeScheduler::Plan &
+CascadeScheduler::Schedule(f32 time, f32 deltaTime, f64 budgetMs) {
+  ++frame;
+  plan.cascades.assign(cascades.size(), {});
+  plan.estimatedMs = 0;
+  const bool unlimited = budgetMs <= 0 || stats.measurements == 0;
+
+  // The ones due are simulated whatever the budget.
+  std::vector<u32> candidates;
+  for (u32 i = 0; i < cascades.size(); ++i) {
+    const State &state = cascades[i];
+    Decision &decision = plan.cascades[i];
+    decision.N = state.cascade.N;
+    decision.age = state.valid ? (u32)(frame - state.lastFrame) : 0;
+    decision.interval = state.interval;
+    decision.estimatedMs = stats.msPerWeight * Weight(state.cascade.N);
+    if (!state.cascade.enabled)
+      continue;
+    if (unlimited || !state.valid ||
+        decision.age >= state.cascade.maxInterval) {
+      decision.simulate = true;
+      plan.estimatedMs += decision.estimatedMs;
+    } else
+      candidates.push_back(i);
+  }
+
+  // Then the most out of date for what they are allowed, while they fit.
+  std::ranges::sort(candidates, [&](u32 a, u32 b) {
+    return plan.cascades[a].age * cascades[b].cascade.maxInterval >
+           plan.cascades[b].age * cascades[a].cascade.maxInterval;
+  });
+  for (u32 i : candidates) {
+    Decision &decision = plan.cascades[i];
+    if (plan.estimatedMs + decision.estimatedMs > budgetMs)
+      continue;
+    decision.simulate = true;
+    plan.estimatedMs += decision.estimatedMs;
+  }
+
+  for (u32 i = 0; i < cascades.size(); ++i) {
+    State &state = cascades[i];
+    Decision &decision = plan.cascades[i];
+    if (!decision.simulate)
+      continue;
+    if (state.valid)
+      state.interval += IntervalSmoothing * ((f32)decision.age - state.interval);
+    // A paused clock keeps the offset, so the result does not step back.
+    if (deltaTime > 0)
+      state.lastOffset = 0.5f * (state.interval + 1) * deltaTime;
+    decision.interval = state.interval;
+    decision.timeOffset = state.lastOffset;
+    decision.time = time + decision.timeOffset;
+    decision.deltaTime =
+        state.valid ? std::max(decision.time - state.lastTime, 0.f)
+                    : deltaTime;
+
+    state.valid = true;
+    state.lastFrame = frame;
+    state.lastTime = decision.time;
+  }
+  return plan;
+}
+
+void CascadeScheduler::Measured(const Plan &measured, f64 ms) {
+  f64 weight = 0;
+  for (const Decision &decision : measured.cascades)
+    if (decision.simulate)
+      weight += Weight(decision.N);
+  if (weight == 0)
+    return;
+
+  const f64 msPerWeight = ms / weight;
+  stats.msPerWeight =
+      stats.measurements == 0
+          ? msPerWeight
+          : stats.msPerWeight + CostSmoothing * (msPerWeight - stats.msPerWeight);
+  stats.measuredMs = ms;
+  ++stats.measurements;
+}
+} // namespace Ocean
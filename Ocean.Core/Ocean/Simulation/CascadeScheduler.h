@@ -0,0 +1,96 @@
+#pragma once
+#include <span>
+#include <vector>
+#include "../Typedefs.h"
+
+namespace Ocean {
+// Spreads the simulation of the cascades over the frames, to keep it within
+// a budget of compute time per frame. A cascade left out keeps showing its
+// last result, the far ones change slowly enough for that. Each cascade is
+// simulated at least every maxInterval frames however long it takes, then
+// the most out of date ones while they fit the budget.
+//
+// The cost of a cascade is estimated from its size: the FFTs take N^2
+// log2 N, the other passes N^2 each. The time of a frame is spread over the
+// cascades it simulated by this, and followed by a moving average.
+//
+// A result is shown from the next frame on, until the cascade is simulated
+// again. It is simulated for the time in the middle of those frames, its
+// timeOffset ahead, so it is off by half its interval at most both ways.
+class CascadeScheduler {
+public:
+  struct Cascade {
+    u32 N = 256;
+    // 1 for a cascade to be simulated every frame.
+    u32 maxInterval = 1;
+    // Disabled ones are not simulated, nor counted.
+    bool enabled = true;
+  };
+
+  struct Decision {
+    bool simulate = false;
+    // Of the cascade when planned.
+    u32 N = 0;
+    // Of the simulation, when simulated: the one of the frame and the offset.
+    f32 time = 0;
+    // Since the previous simulation of the cascade.
+    f32 deltaTime = 0;
+    f32 timeOffset = 0;
+    // Frames since the cascade was simulated last.
+    u32 age = 0;
+    // Between the simulations, a moving average.
+    f32 interval = 1;
+    f64 estimatedMs = 0;
+  };
+
+  struct Plan {
+    std::vector<Decision> cascades;
+    // Of the ones simulated.
+    f64 estimatedMs = 0;
+  };
+
+  struct Statistics {
+    // Of the last measured plan.
+    f64 measuredMs = 0;
+    f64 msPerWeight = 0;
+    u32 measurements = 0;
+  };
+
+  CascadeScheduler() = default;
+  explicit CascadeScheduler(std::span<const Cascade> cascades);
+
+  // A cascade whose size changes, or which is enabled again, is invalidated.
+  void SetCascade(u32 index, const Cascade &cascade);
+  u32 GetCount() const { return (u32)cascades.size(); }
+  // Simulated on the next frame however long it takes, as when its
+  // spectrum or its buffers changed.
+  void Invalidate(u32 index);
+
+  // For a frame of the time, deltaTime after the previous one. A budget of
+  // 0 simulates every cascade every frame, as does one before the first
+  // measurement.
+  const Plan &Schedule(f32 time, f32 deltaTime, f64 budgetMs);
+  // The GPU time of a plan, once known.
+  void Measured(const Plan &plan, f64 ms);
+
+  const Plan &GetPlan() const { return plan; }
+  const Statistics &GetStatistics() const { return stats; }
+
+private:
+  struct State {
+    Cascade cascade;
+    bool valid = false;
+    u64 lastFrame = 0;
+    f32 lastTime = 0;
+    f32 lastOffset = 0;
+    f32 interval = 1;
+  };
+
+  static f64 Weight(u32 N);
+
+  std::vector<State> cascades;
+  Plan plan;
+  Statistics stats;
+  u64 frame = 0;
+};
+} // namespace Ocean
@@ -0,0 +1,556 @@
+#include "pch.h"
+#include "CpuSimulation.h"
+#include "../Simd/Simd.h"
+
+using namespace Ocean::Simd;
+
+namespace Ocean {
+namespace {
+// Each kernel processes V::Width consecutive elements of a row starting at x.
+
+template <typename V>
+inline void SpektrumKernel(const f32 *const (&terms)[3][4],
+                           f32 *const (&spectra)[3][2], u32 x, V s, V c) {
+  for (u32 field = 0; field < 3; ++field) {
+    const auto &[sumRe, sumIm, diffRe, diffIm] = terms[field];
+    NegMulAdd(V::Load(sumIm + x), s, V::Load(sumRe + x) * c)
+        .Store(spectra[field][0] + x);
+    MulAdd(V::Load(diffRe + x), s, V::Load(diffIm + x) * c)
+        .Store(spectra[field][1] + x);
+  }
+}
+
+// e^(iwt) from sin and cos of w t.
+template <typename V>
+inline void DirectSpektrumKernel(const f32 *const (&terms)[3][4],
+                                 f32 *const (&spectra)[3][2],
+                                 const f32 *frequencies, u32 x, f32 time) {
+  V s, c;
+  SinCos(V::Load(frequencies + x) * V::Broadcast(time), s, c);
+  SpektrumKernel<V>(terms, spectra, x, s, c);
+}
+
+// e^(iwt) from the phasors of a PhaseEvolution.
+template <typename V>
+inline void IncrementalSpektrumKernel(const f32 *const (&terms)[3][4],
+                                      f32 *const (&spectra)[3][2],
+                                      const f32 *c, const f32 *s, u32 x) {
+  SpektrumKernel<V>(terms, spectra, x, V::Load(s + x), V::Load(c + x));
+}
+
+// From the transformed Dx, height and Dz of row y in src to dst, which may
+// be the same.
+template <typename V>
+inline void DisplacementKernel(const f32 *const (&src)[3],
+                               f32 *const (&dst)[3], u32 x, u32 y,
+                               const float3 &lambda) {
+  // Required due to interval change: (-1)^(x + y)
+  const V parity = V::Iota((f32)(x + y));
+  const V sign = Select(CmpEq(Floor(parity * V::Broadcast(0.5f)) *
+                                  V::Broadcast(2.f),
+                              parity),
+                        V::Broadcast(1.f), V::Broadcast(-1.f));
+
+  const V h = MulAdd(sign, V::Load(src[1] + x), V::Broadcast(2.f)) *
+              V::Broadcast(1.f / 5.f);
+  (sign * V::Load(src[0] + x) * V::Broadcast(lambda.x)).Store(dst[0] + x);
+  (h * V::Broadcast(lambda.y)).Store(dst[1] + x);
+  (sign * V::Load(src[2] + x) * V::Broadcast(lambda.z)).Store(dst[2] + x);
+}
+
+// Central differences of the displacement rows below, at and above the
+// row, left and right are the columns of the neighbours (wrapped at the
+// edges). Writes the normal and the Jacobian to out.
+template <typename V>
+inline void GradientKernel(const f32 *const (&rows)[3][3],
+                           f32 *const (&out)[4], u32 x, u32 left, u32 right,
+                           f32 tileSize, f32 invTileSize) {
+  const auto &[bottom, center, top] = rows;
+
+  const V dvx = V::Load(center[0] + right) - V::Load(center[0] + left) +
+                V::Broadcast(tileSize);
+  const V dvy = V::Load(center[1] + right) - V::Load(center[1] + left);
+  const V dvz = V::Load(center[2] + right) - V::Load(center[2] + left);
+
+  const V dux = V::Load(top[0] + x) - V::Load(bottom[0] + x);
+  const V duy = V::Load(top[1] + x) - V::Load(bottom[1] + x);
+  const V duz = V::Load(top[2] + x) - V::Load(bottom[2] + x) +
+                V::Broadcast(tileSize);
+
+  // cross(du, dv)
+  const V gx = NegMulAdd(duz, dvy, duy * dvz);
+  const V gy = NegMulAdd(dux, dvz, duz * dvx);
+  const V gz = NegMulAdd(duy, dvx, dux * dvy);
+  const V invLen =
+      V::Broadcast(1.f) / Sqrt(MulAdd(gx, gx, MulAdd(gy, gy, gz * gz)));
+
+  const V inv2 = V::Broadcast(invTileSize * invTileSize);
+  const V J = NegMulAdd(dvz, dux, dvx * duz) * inv2;
+
+  (gx * invLen).Store(out[0] + x);
+  (gy * invLen).Store(out[1] + x);
+  (gz * invLen).Store(out[2] + x);
+  J.Store(out[3] + x);
+}
+
+template <typename V>
+inline void FoamDecayKernel(LodFields &fields, size_t i, f32 decay,
+                            f32 step, const LodParameters &params) {
+  const V old = V::Load(fields.foam.data() + i);
+  const V decayed = NegMulAdd(V::Broadcast(decay), old, old);
+
+  V newval = MulAdd(-V::Load(fields.jacobian.data() + i),
+                    V::Broadcast(params.foamMult),
+                    V::Broadcast(params.foamBias));
+  newval = Max(V::Zero(), newval) * V::Broadcast(step);
+
+  const V res = decayed + Select(CmpGt(newval, V::Broadcast(params.foamMinValue)),
+                                 newval, V::Zero());
+  res.Store(fields.foam.data() + i);
+  res.Store(fields.gradientW.data() + i);
+}
+
+// Index of the range holding i, first has the start of each range and the
+// end of the last one.
+u32 RangeOf(std::span<const u32> first, u32 i) {
+  return (u32)(std::ranges::upper_bound(first, i) - first.begin()) - 1;
+}
+} // namespace
+
+CpuSimulation::CpuSimulation(ThreadPool &pool) : pool(pool) {}
+
+const RealFft2D &CpuSimulation::GetFft(u32 N) {
+  for (const auto &fft : ffts)
+    if (fft->GetSize() == N)
+      return *fft;
+  return *ffts.emplace_back(std::make_unique<RealFft2D>(N));
+}
+
+template <typename H0, typename W>
+u32 CpuSimulation::AddLodFrom(u32 N, H0 &&tildeh0At, W &&frequencyAt,
+                              const LodParameters &parameters) {
+  using c32 = std::complex<f32>;
+  const u32 halfPitch = N / 2 + 1;
+  const size_t size = (size_t)N * N;
+  const size_t halfSize = (size_t)N * halfPitch;
+  auto lod = std::make_unique<Lod>();
+  lod->N = N;
+  lod->halfPitch = halfPitch;
+  lod->fft = &GetFft(N);
+  lod->parameters = parameters;
+
+  for (auto &terms : lod->terms)
+    for (auto *plane :
+         {&terms.sumRe, &terms.sumIm, &terms.diffRe, &terms.diffIm})
+      plane->assign(halfSize, 0.f);
+  lod->frequencies.assign(halfSize, 0.f);
+  for (u32 field = 0; field < 3; ++field) {
+    lod->spectrumRe[field].assign(halfSize, 0.f);
+    lod->spectrumIm[field].assign(halfSize, 0.f);
+  }
+  for (auto *plane :
+       {&lod->fields.displacementX, &lod->fields.displacementY,
+        &lod->fields.displacementZ, &lod->fields.gradientX,
+        &lod->fields.gradientY, &lod->fields.gradientZ, &lod->fields.gradientW,
+        &lod->fields.foam, &lod->fields.jacobian})
+    plane->assign(size, 0.f);
+
+  // Spektrums.hlsl: h(k) = e h0(k) + e* h0(m(k))*, where m mirrors the index
+  // around N - 1 - loc, not N - loc, and tilde_D(k) = c(k) h(k) with
+  // c = nky - i nkx. So h is not Hermitian: the shaders use the real part of
+  // its transform, and the real and imaginary parts of the one of tilde_D.
+  // These are the transforms of the Hermitian part (F(k) + F(-k)*) / 2 of h
+  // and tilde_D, and of -i times the anti-Hermitian part of tilde_D. With
+  // the FFT index -k = (N - x, N - y), w(-k) = w(k), A = h0(k),
+  // B = h0(m(k)), A' = h0(-k), B' = h0(m(-k)) and c' = c(-k) all of them
+  // are e P + e* Q*:
+  //   height: P = (A + B') / 2,             Q = (B + A') / 2
+  //   Dx:     P = (c A + c'* B') / 2,       Q = (c* B + c' A') / 2
+  //   Dz:     P = -i (c A - c'* B') / 2,    Q = i (c* B - c' A') / 2
+  const u32 mask = N - 1;
+  const auto choppy = [&](u32 x, u32 y) {
+    const f32 kx = (f32)(N / 2) - (f32)x, ky = (f32)(N / 2) - (f32)y;
+    const f32 len2 = kx * kx + ky * ky;
+    const f32 invLen = len2 > 1e-12f ? 1.f / std::sqrt(len2) : 0.f;
+    return c32(ky * invLen, -kx * invLen);
+  };
+  const c32 i(0.f, 1.f);
+  lod->columnEnergy.assign(halfPitch, 0.0);
+  lod->rowEnergy.assign(N, 0.0);
+  for (u32 y = 0; y < N; ++y) {
+    for (u32 x = 0; x < halfPitch; ++x) {
+      const u32 nx = (N - x) & mask, ny = (N - y) & mask;
+      const c32 A = tildeh0At(x, y), B = tildeh0At(N - 1 - x, N - 1 - y);
+      const c32 Am = tildeh0At(nx, ny), Bm = tildeh0At(N - 1 - nx, N - 1 - ny);
+      const c32 c = choppy(x, y), cm = choppy(nx, ny);
+
+      const c32 P[3] = {(c * A + std::conj(cm) * Bm) * 0.5f, (A + Bm) * 0.5f,
+                        -i * (c * A - std::conj(cm) * Bm) * 0.5f};
+      const c32 Q[3] = {(std::conj(c) * B + cm * Am) * 0.5f, (B + Am) * 0.5f,
+                        i * (std::conj(c) * B - cm * Am) * 0.5f};
+
+      const size_t index = (size_t)y * halfPitch + x;
+      f64 energy = 0;
+      for (u32 field = 0; field < 3; ++field) {
+        auto &terms = lod->terms[field];
+        terms.sumRe[index] = P[field].real() + Q[field].real();
+        terms.sumIm[index] = P[field].imag() + Q[field].imag();
+        terms.diffRe[index] = P[field].real() - Q[field].real();
+        terms.diffIm[index] = P[field].imag() - Q[field].imag();
+        // 2 (|P|^2 + |Q|^2), at least |S|^2 whatever the phase
+        energy +=
+            std::norm(P[field] + Q[field]) + std::norm(P[field] - Q[field]);
+      }
+      energy *= x == 0 || x == N / 2 ? 1 : 2;
+      lod->columnEnergy[x] += energy;
+      lod->rowEnergy[y] += energy;
+      lod->frequencies[index] = frequencyAt(x, y);
+    }
+  }
+
+  if (evolution == TimeEvolution::Incremental)
+    lod->phases = std::make_unique<PhaseEvolution>(lod->frequencies);
+  Prune(*lod);
+  lods.push_back(std::move(lod));
+  return (u32)lods.size() - 1;
+}
+
+u32 CpuSimulation::AddLod(u32 N, std::span<const std::complex<f32>> tildeh0,
+                          std::span<const f32> frequencies,
+                          const LodParameters &parameters) {
+  return AddLodFrom(
+      N, [&](u32 x, u32 y) { return tildeh0[(size_t)y * N + x]; },
+      [&](u32 x, u32 y) { return frequencies[(size_t)y * N + x]; },
+      parameters);
+}
+
+u32 CpuSimulation::AddLod(const HalfSpectrum &spectrum,
+                          const LodParameters &parameters) {
+  return AddLodFrom(
+      spectrum.N, [&](u32 x, u32 y) { return spectrum.Tildeh0At(y, x); },
+      [&](u32 x, u32 y) { return spectrum.FrequencyAt(y, x); }, parameters);
+}
+
+void CpuSimulation::SetLodParameters(u32 lod, const LodParameters &parameters) {
+  lods[lod]->parameters = parameters;
+}
+
+void CpuSimulation::SetPostFft(PostFft newPostFft) { postFft = newPostFft; }
+
+void CpuSimulation::SetFftPruning(f64 relativeEnergy) {
+  pruning = relativeEnergy;
+  for (auto &lod : lods)
+    Prune(*lod);
+}
+
+void CpuSimulation::Prune(Lod &lod) const {
+  const u32 N = lod.N;
+  f64 energy = 0;
+  for (f64 column : lod.columnEnergy)
+    energy += column;
+  // Half for the columns and half for the rows, the elements in both are
+  // counted twice.
+  const f64 budget = 0.5 * pruning * energy;
+
+  // From kx = N / 2 on, the column x = N / 2 of kx = 0 is always kept.
+  u32 firstColumn = 0;
+  for (f64 dropped = 0; firstColumn < N / 2 &&
+                        dropped + lod.columnEnergy[firstColumn] <= budget;)
+    dropped += lod.columnEnergy[firstColumn++];
+  // Whole vectors of the rows, and of the FFT blocks.
+  firstColumn -= firstColumn % f32v::Width;
+
+  // From ky = N / 2 on, the rows y and N - y of the same |ky| together.
+  u32 firstRow = 0;
+  for (f64 dropped = 0; firstRow < N / 2;) {
+    const f64 row = lod.rowEnergy[firstRow] +
+                    (firstRow == 0 ? 0 : lod.rowEnergy[N - firstRow]);
+    if (dropped + row > budget)
+      break;
+    dropped += row;
+    ++firstRow;
+  }
+  // The phasors of the elements left out were not advanced.
+  const bool grown =
+      firstColumn < lod.band.firstColumn || firstRow < lod.band.firstRow;
+  if (grown && lod.phases)
+    lod.phases->Invalidate();
+  lod.band = {firstColumn, firstRow, std::min(N, N + 1 - firstRow)};
+
+  // The columns left out stay zero through the FFTs.
+  for (u32 field = 0; field < 3; ++field) {
+    std::ranges::fill(lod.spectrumRe[field], 0.f);
+    std::ranges::fill(lod.spectrumIm[field], 0.f);
+  }
+}
+
+void CpuSimulation::SetTimeEvolution(TimeEvolution newEvolution) {
+  evolution = newEvolution;
+  for (auto &lod : lods)
+    lod->phases = evolution == TimeEvolution::Incremental
+                      ? std::make_unique<PhaseEvolution>(lod->frequencies)
+                      : nullptr;
+}
+
+template <typename Fn>
+void CpuSimulation::ForEachRow(std::span<Lod *const> active, u32 grain,
+                               Fn &&fn) {
+  // The rows of all of them one after the other.
+  std::vector<u32> first(active.size() + 1, 0);
+  for (size_t i = 0; i < active.size(); ++i)
+    first[i + 1] = first[i] + active[i]->N;
+  pool.ParallelFor(first.back(), grain, [&](u32 begin, u32 end) {
+    for (u32 i = begin, lod = RangeOf(first, begin); i < end; ++i) {
+      if (i == first[lod + 1])
+        ++lod;
+      fn(*active[lod], i - first[lod]);
+    }
+  });
+}
+
+void CpuSimulation::Update(const TimeConstants &time,
+                           std::span<const bool> useLod) {
+  std::vector<Lod *> active;
+  for (u32 i = 0; i < lods.size(); ++i)
+    if (useLod.empty() || (i < useLod.size() && useLod[i]))
+      active.push_back(lods[i].get());
+  if (active.empty())
+    return;
+
+  using clock = std::chrono::high_resolution_clock;
+  const auto start = clock::now();
+  for (Lod *lod : active)
+    if (lod->phases)
+      lod->phases->Begin(time.timeSinceLaunch, time.deltaTime);
+
+  const u32 rowGrain = 8;
+  ForEachRow(active, rowGrain, [&](Lod &lod, u32 y) {
+    Spektrum(lod, y, time.timeSinceLaunch);
+  });
+  const auto spektrumDone = clock::now();
+  stageTimes.spektrum = spektrumDone - start;
+
+  // Every LOD has three real fields, each one about half a complex
+  // transform. The ones of the same size in one batch.
+  std::vector<RealFft2D::Field> fields;
+  for (const auto &fft : ffts) {
+    fields.clear();
+    for (Lod *lod : active) {
+      if (lod->fft != fft.get())
+        continue;
+      f32 *outputs[3] = {lod->fields.displacementX.data(),
+                         lod->fields.displacementY.data(),
+                         lod->fields.displacementZ.data()};
+      for (u32 field = 0; field < 3; ++field)
+        fields.push_back({lod->spectrumRe[field].data(),
+                          lod->spectrumIm[field].data(), outputs[field],
+                          lod->band.firstColumn});
+    }
+    if (!fields.empty())
+      fft->Inverse(fields, &pool);
+  }
+  const auto fftDone = clock::now();
+  stageTimes.fft = fftDone - spektrumDone;
+
+  if (postFft == PostFft::Fused) {
+    FusedPostFft(active, time.deltaTime);
+  } else {
+    ForEachRow(active, rowGrain,
+               [&](Lod &lod, u32 y) { Displacement(lod, y); });
+    ForEachRow(active, rowGrain, [&](Lod &lod, u32 y) { Gradient(lod, y); });
+    ForEachRow(active, rowGrain,
+               [&](Lod &lod, u32 y) { FoamDecay(lod, y, time.deltaTime); });
+  }
+  stageTimes.postFft = clock::now() - fftDone;
+}
+
+void CpuSimulation::FusedPostFft(std::span<Lod *const> active,
+                                 f32 deltaTime) {
+  // The strips of all of them one after the other, a job each.
+  std::vector<u32> first(active.size() + 1, 0);
+  u32 maxN = 0;
+  for (size_t i = 0; i < active.size(); ++i) {
+    const u32 N = active[i]->N;
+    first[i + 1] = first[i] + N / std::min(N, FusedStripRows);
+    maxN = std::max(maxN, N);
+  }
+  const u32 jobs = first.back();
+  struct Strip {
+    Lod &lod;
+    u32 y0;
+    u32 y1;
+    // The rows below and above the strip, transformed, for each field.
+    std::array<std::array<f32 *, 3>, 2> edges;
+  };
+  halo.resize((size_t)jobs * 6 * maxN);
+  const auto stripOf = [&](u32 job) {
+    const u32 i = RangeOf(first, job);
+    Lod &lod = *active[i];
+    const u32 N = lod.N, rows = std::min(N, FusedStripRows);
+    const u32 y0 = (job - first[i]) * rows;
+    f32 *data = halo.data() + (size_t)job * 6 * maxN;
+    return Strip{lod,
+                 y0,
+                 y0 + rows,
+                 {{{data, data + N, data + 2 * N},
+                   {data + 3 * N, data + 4 * N, data + 5 * N}}}};
+  };
+
+  // Every halo is taken before any strip transforms its rows in place.
+  pool.ParallelFor(jobs, 1, [&](u32 begin, u32 end) {
+    for (u32 job = begin; job < end; ++job) {
+      const auto [lod, y0, y1, rows] = stripOf(job);
+      const u32 mask = lod.N - 1;
+      for (u32 side = 0; side < 2; ++side) {
+        const u32 y = (side == 0 ? y0 - 1 : y1) & mask;
+        const auto planes = PlaneRows(lod, y);
+        const f32 *const src[3] = {planes[0], planes[1], planes[2]};
+        f32 *const dst[3] = {rows[side][0], rows[side][1], rows[side][2]};
+        Displacement(lod, y, src, dst);
+      }
+    }
+  });
+
+  pool.ParallelFor(jobs, 1, [&](u32 begin, u32 end) {
+    for (u32 job = begin; job < end; ++job) {
+      const auto [lod, y0, y1, rows] = stripOf(job);
+      Displacement(lod, y0);
+      for (u32 y = y0; y < y1; ++y) {
+        if (y + 1 < y1)
+          Displacement(lod, y + 1);
+        const auto below = y == y0 ? rows[0] : PlaneRows(lod, y - 1);
+        const auto above = y + 1 == y1 ? rows[1] : PlaneRows(lod, y + 1);
+        const auto at = PlaneRows(lod, y);
+        const f32 *const neighbours[3][3] = {
+            {below[0], below[1], below[2]},
+            {at[0], at[1], at[2]},
+            {above[0], above[1], above[2]}};
+        Gradient(lod, y, neighbours);
+        FoamDecay(lod, y, deltaTime);
+      }
+    }
+  });
+}
+
+std::array<f32 *, 3> CpuSimulation::PlaneRows(Lod &lod, u32 y) const {
+  const size_t row = (size_t)y * lod.N;
+  return {lod.fields.displacementX.data() + row,
+          lod.fields.displacementY.data() + row,
+          lod.fields.displacementZ.data() + row};
+}
+
+void CpuSimulation::Spektrum(Lod &lod, u32 y, f32 time) const {
+  const u32 halfPitch = lod.halfPitch, x0 = lod.band.firstColumn;
+  const size_t row = (size_t)y * halfPitch;
+  // The rows left out are transformed by the columns, as zeros.
+  if (y < lod.band.firstRow || y >= lod.band.endRow) {
+    for (u32 field = 0; field < 3; ++field) {
+      std::fill_n(lod.spectrumRe[field].data() + row + x0, halfPitch - x0, 0.f);
+      std::fill_n(lod.spectrumIm[field].data() + row + x0, halfPitch - x0, 0.f);
+    }
+    return;
+  }
+
+  const f32 *terms[3][4];
+  f32 *spectra[3][2];
+  for (u32 field = 0; field < 3; ++field) {
+    const auto &t = lod.terms[field];
+    terms[field][0] = t.sumRe.data() + row;
+    terms[field][1] = t.sumIm.data() + row;
+    terms[field][2] = t.diffRe.data() + row;
+    terms[field][3] = t.diffIm.data() + row;
+    spectra[field][0] = lod.spectrumRe[field].data() + row;
+    spectra[field][1] = lod.spectrumIm[field].data() + row;
+  }
+
+  if (lod.phases) {
+    lod.phases->Apply((u32)row + x0, (u32)row + halfPitch);
+    const f32 *c = lod.phases->GetCos() + row;
+    const f32 *s = lod.phases->GetSin() + row;
+    u32 x = x0;
+    for (; x + f32v::Width <= halfPitch; x += f32v::Width)
+      IncrementalSpektrumKernel<f32v>(terms, spectra, c, s, x);
+    for (; x < halfPitch; ++x)
+      IncrementalSpektrumKernel<f32x1>(terms, spectra, c, s, x);
+    return;
+  }
+
+  const f32 *frequencies = lod.frequencies.data() + row;
+  u32 x = x0;
+  for (; x + f32v::Width <= halfPitch; x += f32v::Width)
+    DirectSpektrumKernel<f32v>(terms, spectra, frequencies, x, time);
+  for (; x < halfPitch; ++x)
+    DirectSpektrumKernel<f32x1>(terms, spectra, frequencies, x, time);
+}
+
+void CpuSimulation::Displacement(Lod &lod, u32 y) const {
+  const auto rows = PlaneRows(lod, y);
+  f32 *const planes[3] = {rows[0], rows[1], rows[2]};
+  Displacement(lod, y, planes, planes);
+}
+
+void CpuSimulation::Displacement(Lod &lod, u32 y, const f32 *const (&src)[3],
+                                 f32 *const (&dst)[3]) const {
+  const auto &lambda = lod.parameters.displacementLambda;
+  const u32 N = lod.N;
+  u32 x = 0;
+  for (; x + f32v::Width <= N; x += f32v::Width)
+    DisplacementKernel<f32v>(src, dst, x, y, lambda);
+  for (; x < N; ++x)
+    DisplacementKernel<f32x1>(src, dst, x, y, lambda);
+}
+
+void CpuSimulation::Gradient(Lod &lod, u32 y) const {
+  const u32 mask = lod.N - 1;
+  const auto below = PlaneRows(lod, (y - 1) & mask);
+  const auto at = PlaneRows(lod, y);
+  const auto above = PlaneRows(lod, (y + 1) & mask);
+  const f32 *const rows[3][3] = {{below[0], below[1], below[2]},
+                                 {at[0], at[1], at[2]},
+                                 {above[0], above[1], above[2]}};
+  Gradient(lod, y, rows);
+}
+
+void CpuSimulation::Gradient(Lod &lod, u32 y,
+                             const f32 *const (&rows)[3][3]) const {
+  const u32 N = lod.N;
+  // Why the div by 2? (see gradient.hlsl)
+  const f32 tileSize = lod.parameters.patchSize * 2.f / (f32)N / 2.f;
+  const f32 invTileSize = (f32)N / lod.parameters.patchSize;
+
+  const u32 mask = N - 1;
+  const size_t row = (size_t)y * N;
+  f32 *const out[4] = {lod.fields.gradientX.data() + row,
+                       lod.fields.gradientY.data() + row,
+                       lod.fields.gradientZ.data() + row,
+                       lod.fields.jacobian.data() + row};
+
+  const auto edge = [&](u32 x) {
+    GradientKernel<f32x1>(rows, out, x, (x - 1) & mask, (x + 1) & mask,
+                          tileSize, invTileSize);
+  };
+
+  edge(0);
+  u32 x = 1;
+  for (; x + f32v::Width + 1 <= N; x += f32v::Width)
+    GradientKernel<f32v>(rows, out, x, x - 1, x + 1, tileSize, invTileSize);
+  for (; x < N; ++x)
+    edge(x);
+}
+
+void CpuSimulation::FoamDecay(Lod &lod, u32 y, f32 deltaTime) const {
+  const auto &params = lod.parameters;
+  const f32 decayRate = params.foamExponentialDecay * 60;
+  const f32 minEPS = 0.0001f;
+  const f32 decay = decayRate * deltaTime;
+  const f32 step = deltaTime >= minEPS ? 1.f : 0.f;
+
+  const u32 N = lod.N;
+  const size_t row = (size_t)y * N;
+  u32 x = 0;
+  for (; x + f32v::Width <= N; x += f32v::Width)
+    FoamDecayKernel<f32v>(lod.fields, row + x, decay, step, params);
+  for (; x < N; ++x)
+    FoamDecayKernel<f32x1>(lod.fields, row + x, decay, step, params);
+}
+} // namespace Ocean
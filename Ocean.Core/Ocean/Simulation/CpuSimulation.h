@@ -0,0 +1,205 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <complex>
+#include <memory>
+#include <span>
+#include <vector>
+#include "../Math/Vector.h"
+#include "../Memory/AlignedVector.h"
+#include "../Fft/Fft.h"
+#include "../Spectrum/Spectrum.h"
+#include "PhaseEvolution.h"
+#include "../Threading/ThreadPool.h"
+
+namespace Ocean {
+// Mirrors TimeConstants in common.hlsli.
+struct TimeConstants {
+  f32 deltaTime = 0;
+  f32 timeSinceLaunch = 0;
+};
+
+// Per LOD constants of the post FFT passes, mirrors LODComputeBuffer.
+struct LodParameters {
+  float3 displacementLambda = {1.f, 1.f, 1.f};
+  // World space size of the patch (PatchData::patchExtent).
+  f32 patchSize = 1.f;
+  f32 foamExponentialDecay = 0.f;
+  f32 foamMinValue = 0.f;
+  f32 foamBias = 0.f;
+  f32 foamMult = 1.f;
+};
+
+// Results of one LOD as N*N row major planes, element (x, y) at y * N + x.
+struct LodFields {
+  // displacement.hlsl, .w is always 0.
+  AlignedVector<f32> displacementX;
+  AlignedVector<f32> displacementY;
+  AlignedVector<f32> displacementZ;
+  // gradient.hlsl and foamDecay.hlsl: the normal in xyz, the foam in w.
+  AlignedVector<f32> gradientX;
+  AlignedVector<f32> gradientY;
+  AlignedVector<f32> gradientZ;
+  AlignedVector<f32> gradientW;
+  // foamDecay.hlsl, persists between updates.
+  AlignedVector<f32> foam;
+  // Jacobian of the displacement, before the foam overwrites gradient.w.
+  AlignedVector<f32> jacobian;
+
+  float4 DisplacementAt(u32 index) const {
+    return {displacementX[index], displacementY[index], displacementZ[index],
+            0.f};
+  }
+  float4 GradientAt(u32 index) const {
+    return {gradientX[index], gradientY[index], gradientZ[index],
+            gradientW[index]};
+  }
+};
+
+enum class TimeEvolution : u8 {
+  // sin and cos of w t for every element in every update, as Spektrums.hlsl.
+  Direct,
+  // Phasors advanced by a rotation per element, see PhaseEvolution.
+  Incremental
+};
+
+enum class PostFft : u8 {
+  // A pass over the planes for each of displacement.hlsl, gradient.hlsl and
+  // foamDecay.hlsl, as the shaders run.
+  Staged,
+  // All three in one pass over strips of rows, while the rows around each
+  // row are still in the cache. The same results as Staged.
+  Fused
+};
+
+// CPU implementation of WaterSimulationComputeShader: spectrum -> inverse
+// FFTs -> displacement -> gradients -> foam, for any number of LODs, each of
+// its own resolution. Every stage is vectorized and split over rows (and
+// LODs) on the thread pool. Follows the shaders closely enough to act as a
+// reference when changing them.
+class CpuSimulation {
+public:
+  explicit CpuSimulation(ThreadPool &pool = ThreadPool::Global());
+
+  // tildeh0 and frequencies as produced by CalculateTildeh0 and
+  // CalculateFrequencies for an N x N patch, or by CalculateHalfSpectrum
+  // (N = M). The LODs of the same N share the FFT plans. Returns the index
+  // of the new LOD.
+  u32 AddLod(u32 N, std::span<const std::complex<f32>> tildeh0,
+             std::span<const f32> frequencies, const LodParameters &parameters);
+  u32 AddLod(const HalfSpectrum &spectrum, const LodParameters &parameters);
+  void SetLodParameters(u32 lod, const LodParameters &parameters);
+  // Incremental pays off when deltaTime stays the same from update to
+  // update, another one costs about a Direct update.
+  void SetTimeEvolution(TimeEvolution evolution);
+  void SetPostFft(PostFft postFft);
+  // Leaves out the outermost columns and rows of the half spectra, the
+  // highest frequencies, which hold at most this share of the energy
+  // together. Their spectrum is not computed, the columns are skipped by
+  // the first FFT pass. 0, the default, transforms all of it.
+  void SetFftPruning(f64 relativeEnergy);
+
+  // Of the half spectrum of a LOD, the part transformed.
+  struct Band {
+    u32 firstColumn = 0;
+    // [firstRow, endRow), around the row of ky = 0.
+    u32 firstRow = 0;
+    u32 endRow = 0;
+  };
+  const Band &GetBand(u32 lod) const { return lods[lod]->band; }
+
+  // Runs the whole chain for the LODs enabled in useLod, all of them if
+  // useLod is empty.
+  void Update(const TimeConstants &time, std::span<const bool> useLod = {});
+
+  // Of the last Update.
+  struct StageTimes {
+    std::chrono::nanoseconds spektrum{0};
+    std::chrono::nanoseconds fft{0};
+    // Displacement, gradients and foam.
+    std::chrono::nanoseconds postFft{0};
+  };
+  const StageTimes &GetStageTimes() const { return stageTimes; }
+
+  u32 GetSize(u32 lod) const { return lods[lod]->N; }
+  u32 GetLodCount() const { return (u32)lods.size(); }
+  const LodFields &GetLod(u32 lod) const { return lods[lod]->fields; }
+
+private:
+  struct Lod {
+    u32 N;
+    u32 halfPitch;
+    const RealFft2D *fft;
+    LodParameters parameters;
+    // The transformed fields, Dx, the height and Dz in this order, are real
+    // so their spectra are Hermitian and only the half spectrum x in
+    // [0, N / 2] is computed. Each one is S = e P + e* Q* with e = e^(iwt)
+    // (see AddLod), stored as sums and differences:
+    // re = (P.re + Q.re) cos - (P.im + Q.im) sin
+    // im = (P.re - Q.re) sin + (P.im - Q.im) cos
+    struct Terms {
+      AlignedVector<f32> sumRe;
+      AlignedVector<f32> sumIm;
+      AlignedVector<f32> diffRe;
+      AlignedVector<f32> diffIm;
+    };
+    std::array<Terms, 3> terms;
+    // Of the terms of the half spectrum by column and by row, the columns
+    // standing for two of the full spectrum counted twice.
+    std::vector<f64> columnEnergy;
+    std::vector<f64> rowEnergy;
+    Band band;
+    AlignedVector<f32> frequencies;
+    // e^(iwt) of the frequencies, with TimeEvolution::Incremental.
+    std::unique_ptr<PhaseEvolution> phases;
+
+    // Half spectra of the three fields, destroyed by the FFT. The results
+    // go to the displacement planes.
+    std::array<AlignedVector<f32>, 3> spectrumRe;
+    std::array<AlignedVector<f32>, 3> spectrumIm;
+
+    LodFields fields;
+  };
+
+  template <typename H0, typename W>
+  u32 AddLodFrom(u32 N, H0 &&tildeh0At, W &&frequencyAt,
+                 const LodParameters &parameters);
+  // Creates the plan of the first LOD of size N.
+  const RealFft2D &GetFft(u32 N);
+  // Sets the band for the pruning and clears the half spectra.
+  void Prune(Lod &lod) const;
+
+  // Calls fn(lod, row) for every row of the given LODs on the pool.
+  template <typename Fn>
+  void ForEachRow(std::span<Lod *const> active, u32 grain, Fn &&fn);
+
+  // Rows of FusedPostFft strips, the N rows of a smaller LOD are one strip.
+  static constexpr u32 FusedStripRows = 32;
+
+  void FusedPostFft(std::span<Lod *const> active, f32 deltaTime);
+  // Row y of the displacement planes.
+  std::array<f32 *, 3> PlaneRows(Lod &lod, u32 y) const;
+
+  void Spektrum(Lod &lod, u32 y, f32 time) const;
+  // In place on the planes.
+  void Displacement(Lod &lod, u32 y) const;
+  void Displacement(Lod &lod, u32 y, const f32 *const (&src)[3],
+                    f32 *const (&dst)[3]) const;
+  // Of the planes around row y.
+  void Gradient(Lod &lod, u32 y) const;
+  // Of the displacement rows below, at and above row y.
+  void Gradient(Lod &lod, u32 y, const f32 *const (&rows)[3][3]) const;
+  void FoamDecay(Lod &lod, u32 y, f32 deltaTime) const;
+
+  ThreadPool &pool;
+  // One for each size of the LODs.
+  std::vector<std::unique_ptr<RealFft2D>> ffts;
+  TimeEvolution evolution = TimeEvolution::Direct;
+  PostFft postFft = PostFft::Fused;
+  f64 pruning = 0;
+  // Of the FusedPostFft strips.
+  AlignedVector<f32> halo;
+  StageTimes stageTimes;
+  std::vector<std::unique_ptr<Lod>> lods;
+};
+} // namespace Ocean
@@ -0,0 +1,144 @@
+#include "pch.h"
+#include "PhaseEvolution.h"
+#include "../Simd/Simd.h"
+
+using namespace Ocean::Simd;
+
+namespace Ocean {
+namespace {
+// Each kernel processes V::Width consecutive elements starting at i.
+
+// sin and cos of the phases times scale.
+template <typename V>
+inline void SinCosKernel(const f32 *phases, f32 *c, f32 *s, size_t i,
+                         f32 scale) {
+  V sine, cosine;
+  SinCos(V::Load(phases + i) * V::Broadcast(scale), sine, cosine);
+  cosine.Store(c + i);
+  sine.Store(s + i);
+}
+
+// sin and cos of w time over [begin, end). The phase is reduced to
+// [-pi, pi] in f64 first: w time in f32 loses the phase of the fast waves
+// within minutes.
+void SinCosRange(const f32 *w, f32 *c, f32 *s, u32 begin, u32 end,
+                 f64 time) {
+  constexpr u32 Chunk = 256;
+  constexpr f64 TwoPi = 2 * std::numbers::pi;
+  alignas(64) f32 phases[Chunk];
+  for (u32 chunk = begin; chunk < end; chunk += Chunk) {
+    const u32 count = std::min(Chunk, end - chunk);
+    for (u32 i = 0; i < count; ++i) {
+      const f64 phase = (f64)w[chunk + i] * time;
+      phases[i] =
+          (f32)(phase - TwoPi * std::floor(phase * (1 / TwoPi) + 0.5));
+    }
+    u32 i = 0;
+    for (; i + f32v::Width <= count; i += f32v::Width)
+      SinCosKernel<f32v>(phases, c + chunk, s + chunk, i, 1.f);
+    for (; i < count; ++i)
+      SinCosKernel<f32x1>(phases, c + chunk, s + chunk, i, 1.f);
+  }
+}
+
+// e *= r, and scaled back to unit length if renormalize. The magnitude is
+// within a few ulp of 1, where 1 / sqrt(m) = (3 - m) / 2 to f32 precision.
+template <typename V>
+inline void RotateKernel(f32 *c, f32 *s, const f32 *rc, const f32 *rs,
+                         size_t i, bool renormalize) {
+  const V ec = V::Load(c + i), es = V::Load(s + i);
+  const V r = V::Load(rc + i), ri = V::Load(rs + i);
+  V nc = NegMulAdd(es, ri, ec * r);
+  V ns = MulAdd(es, r, ec * ri);
+  if (renormalize) {
+    const V scale = NegMulAdd(MulAdd(nc, nc, ns * ns), V::Broadcast(0.5f),
+                              V::Broadcast(1.5f));
+    nc = nc * scale;
+    ns = ns * scale;
+  }
+  nc.Store(c + i);
+  ns.Store(s + i);
+}
+} // namespace
+
+PhaseEvolution::PhaseEvolution(std::span<const f32> frequencies)
+    : frequencies(frequencies.begin(), frequencies.end()),
+      cosine(frequencies.size(), 1.f), sine(frequencies.size(), 0.f),
+      rotationCos(frequencies.size(), 1.f),
+      rotationSin(frequencies.size(), 0.f) {}
+
+void PhaseEvolution::Begin(f32 newTime, f32 deltaTime) {
+  const bool paused = deltaTime == 0 && newTime == time;
+  // Within half a step of where the previous time leads: the rounding of a
+  // clock summing the steps in f32 is not a jump.
+  const bool stepped =
+      deltaTime > 0 && std::abs(time + deltaTime - newTime) <= 0.5f * deltaTime;
+  time = newTime;
+
+  if (!started || !(paused || stepped)) {
+    started = true;
+    step = Step::Resync;
+    phaseTime = newTime;
+    sinceSync = 0;
+    ++stats.resyncs;
+    return;
+  }
+  if (paused) {
+    step = Step::Keep;
+    return;
+  }
+
+  step = Step::Rotate;
+  if (deltaTime != rotationStep) {
+    step = Step::NewRotation;
+    rotationStep = deltaTime;
+    ++stats.rotationUpdates;
+  }
+  phaseTime += deltaTime;
+  ++stats.steps;
+  // The rounding of the rotations adds up to a phase error growing with the
+  // steps, bounded by starting over from the exact phase.
+  if (++sinceSync == SyncInterval) {
+    step = Step::Resync;
+    sinceSync = 0;
+    ++stats.syncs;
+  }
+  renormalize = sinceSync % RenormalizeInterval == 0;
+}
+
+void PhaseEvolution::Invalidate() {
+  started = false;
+  // So the step after the resync computes the rotations again.
+  rotationStep = 0;
+}
+
+void PhaseEvolution::Apply(u32 begin, u32 end) {
+  if (step == Step::Keep)
+    return;
+
+  f32 *c = cosine.data();
+  f32 *s = sine.data();
+  f32 *rc = rotationCos.data();
+  f32 *rs = rotationSin.data();
+  const f32 *w = frequencies.data();
+
+  if (step == Step::Resync) {
+    SinCosRange(w, c, s, begin, end, phaseTime);
+    return;
+  }
+  // w dt is small enough for f32
+  if (step == Step::NewRotation) {
+    u32 i = begin;
+    for (; i + f32v::Width <= end; i += f32v::Width)
+      SinCosKernel<f32v>(w, rc, rs, i, rotationStep);
+    for (; i < end; ++i)
+      SinCosKernel<f32x1>(w, rc, rs, i, rotationStep);
+  }
+
+  u32 i = begin;
+  for (; i + f32v::Width <= end; i += f32v::Width)
+    RotateKernel<f32v>(c, s, rc, rs, i, renormalize);
+  for (; i < end; ++i)
+    RotateKernel<f32x1>(c, s, rc, rs, i, renormalize);
+}
+} // namespace Ocean
@@ -0,0 +1,71 @@
+#pragma once
+#include <span>
+#include "../Memory/AlignedVector.h"
+#include "../Typedefs.h"
+
+namespace Ocean {
+// e^(iwt) of a set of angular frequencies w, followed over time. Instead of
+// sin and cos of w t for every element in every update, the phasors are
+// advanced by a rotation e^(iw dt), computed once for a deltaTime: a complex
+// multiplication per element. The rounding of the products makes the
+// magnitude drift, it is renormalized every RenormalizeInterval steps. The
+// rounding of the rotations makes the phase drift, every SyncInterval steps
+// the phasors start over from sin and cos of the exact phase.
+//
+// The phasors stand for the sum of the deltaTimes since the last resync.
+// When the time given is not about deltaTime after the previous one, as
+// when it jumps, they are resynchronized to it.
+//
+// Begin decides how to get to the new time, Apply carries it out on a range
+// of the elements. Disjoint ranges may be applied in parallel.
+class PhaseEvolution {
+public:
+  static constexpr u32 RenormalizeInterval = 64;
+  // 10 s at 60 updates per second.
+  static constexpr u32 SyncInterval = 600;
+
+  struct Statistics {
+    u32 steps = 0;
+    // For a deltaTime different from the one of the previous step.
+    u32 rotationUpdates = 0;
+    // sin and cos of w t, on the first update and after the time jumped.
+    u32 resyncs = 0;
+    // Of the SyncInterval.
+    u32 syncs = 0;
+  };
+
+  explicit PhaseEvolution(std::span<const f32> frequencies);
+
+  // A deltaTime of 0 with the time unchanged keeps the phasors (paused).
+  void Begin(f32 time, f32 deltaTime);
+  // The next Begin resynchronizes every element and the rotations, as for
+  // elements left out of Apply so far.
+  void Invalidate();
+  void Apply(u32 begin, u32 end);
+
+  u32 GetCount() const { return (u32)frequencies.size(); }
+  const f32 *GetCos() const { return cosine.data(); }
+  const f32 *GetSin() const { return sine.data(); }
+  // The time the phasors stand for.
+  f64 GetTime() const { return phaseTime; }
+  const Statistics &GetStatistics() const { return stats; }
+
+private:
+  enum class Step : u8 { Keep, Rotate, NewRotation, Resync };
+
+  AlignedVector<f32> frequencies;
+  AlignedVector<f32> cosine;
+  AlignedVector<f32> sine;
+  AlignedVector<f32> rotationCos;
+  AlignedVector<f32> rotationSin;
+
+  Step step = Step::Keep;
+  bool renormalize = false;
+  bool started = false;
+  f32 time = 0;
+  f32 rotationStep = 0;
+  f64 phaseTime = 0;
+  u32 sinceSync = 0;
+  Statistics stats;
+};
+} // namespace Ocean
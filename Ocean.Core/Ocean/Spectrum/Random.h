@@ -0,0 +1,84 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <random>
+
+namespace Ocean {
+class Xorshift128 {
+public:
+  using result_type = uint32_t;
+
+  explicit Xorshift128(uint32_t seed = std::random_device{}()) {
+    // Seed the state with a non-zero seed
+    state[0] = seed;
+    state[1] = seed ^ 0x6C8E9CF570932BD5ULL;
+    state[2] = seed ^ 0xDEADBEEFDEADBEEFULL;
+    state[3] = seed ^ 0xBADDCAFEFEEDFACEULL;
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return UINT32_MAX; }
+
+  uint32_t operator()() {
+    // Xorshift128 algorithm
+    uint32_t t = state[3];
+    t ^= t << 11;
+    t ^= t >> 8;
+    state[3] = state[2];
+    state[2] = state[1];
+    state[1] = state[0];
+    t ^= state[0];
+    t ^= state[0] >> 19;
+    state[0] = t;
+    return t;
+  }
+
+private:
+  std::array<uint32_t, 4> state;
+};
+
+// Counter based generator, Philox4x32-10 (Salmon et al., "Parallel Random
+// Numbers: As Easy as 1, 2, 3"). Every block of four outputs is a pure
+// function of the key and a 128 bit counter: any part of a sequence can be
+// generated on its own, in any order, on any thread.
+class Philox4x32 {
+public:
+  using Block = std::array<uint32_t, 4>;
+
+  explicit Philox4x32(uint64_t seed)
+      : key{(uint32_t)seed, (uint32_t)(seed >> 32)} {}
+
+  Block operator()(Block counter) const {
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < 10; ++round) {
+      const uint64_t p0 = (uint64_t)0xD2511F53 * counter[0];
+      const uint64_t p1 = (uint64_t)0xCD9E8D57 * counter[2];
+      counter = {(uint32_t)(p1 >> 32) ^ counter[1] ^ k0, (uint32_t)p1,
+                 (uint32_t)(p0 >> 32) ^ counter[3] ^ k1, (uint32_t)p0};
+      k0 += 0x9E3779B9;
+      k1 += 0xBB67AE85;
+    }
+    return counter;
+  }
+
+  // The same for as many blocks as U has lanes, the word w of each block
+  // in counter[w]. U is a vector of 32 bit lanes of Simd.h.
+  template <typename U> void operator()(U (&counter)[4]) const {
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < 10; ++round) {
+      U hi0, lo0, hi1, lo1;
+      MulWide(U::Broadcast(0xD2511F53), counter[0], hi0, lo0);
+      MulWide(U::Broadcast(0xCD9E8D57), counter[2], hi1, lo1);
+      counter[0] = hi1 ^ counter[1] ^ U::Broadcast(k0);
+      counter[1] = lo1;
+      counter[2] = hi0 ^ counter[3] ^ U::Broadcast(k1);
+      counter[3] = lo0;
+      k0 += 0x9E3779B9;
+      k1 += 0xBB67AE85;
+    }
+  }
+
+private:
+  std::array<uint32_t, 2> key;
+};
+} // namespace Ocean
@@ -0,0 +1,487 @@
+#include "pch.h"
+#include "Spectrum.h"
+#include "Random.h"
+#include "SpectrumModels.h"
+#include "../Threading/ThreadPool.h"
+
+using namespace std;
+using namespace Ocean::Simd;
+
+namespace Ocean {
+namespace {
+constexpr u32 RowGrain = 8;
+
+// Calls fn(begin, end) over ranges of the rows, on the pool if given.
+template <typename Fn>
+void ForEachRows(ThreadPool *pool, u32 rows, Fn &&fn) {
+  if (pool)
+    pool->ParallelFor(rows, RowGrain, fn);
+  else
+    fn(0u, rows);
+}
+
+// Uniform inputs of the Box-Muller transform for the columns [begin, end) of
+// row i, u1 in (0, 1] and u2 in [0, 1). One Philox block covers two columns.
+inline void NoiseBlock(const Philox4x32 &rng, u32 i, u32 block, f32 *u1,
+                       f32 *u2) {
+  constexpr f32 scale = 1.f / (1 << 24);
+  const auto bits = rng({block, i, 0, 0});
+  u1[0] = (f32)((bits[0] >> 8) + 1) * scale;
+  u2[0] = (f32)(bits[1] >> 8) * scale;
+  u1[1] = (f32)((bits[2] >> 8) + 1) * scale;
+  u2[1] = (f32)(bits[3] >> 8) * scale;
+}
+
+// NoiseBlock of U::Width consecutive blocks at once.
+template <typename U>
+inline void NoiseBlocks(const Philox4x32 &rng, u32 i, u32 block, f32 *u1,
+                        f32 *u2) {
+  U bits[4] = {U::Iota(block), U::Broadcast(i), U::Broadcast(0),
+               U::Broadcast(0)};
+  rng(bits);
+  using V = decltype(Top24(bits[0]));
+  const V scale = V::Broadcast(1.f / (1 << 24));
+  const V one = V::Broadcast(1.f);
+  V lo, hi;
+  Interleave((Top24(bits[0]) + one) * scale, (Top24(bits[2]) + one) * scale,
+             lo, hi);
+  lo.Store(u1);
+  hi.Store(u1 + V::Width);
+  Interleave(Top24(bits[1]) * scale, Top24(bits[3]) * scale, lo, hi);
+  lo.Store(u2);
+  hi.Store(u2 + V::Width);
+}
+
+void NoiseUniforms(const Philox4x32 &rng, u32 i, u32 begin, u32 end, f32 *u1,
+                   f32 *u2) {
+  f32 edge1[2], edge2[2];
+  u32 j = begin;
+  if (j % 2 != 0 && j < end) {
+    NoiseBlock(rng, i, j / 2, edge1, edge2);
+    u1[0] = edge1[1];
+    u2[0] = edge2[1];
+    ++j;
+  }
+  for (; j + 2 * u32v::Width <= end; j += 2 * u32v::Width)
+    NoiseBlocks<u32v>(rng, i, j / 2, u1 + (j - begin), u2 + (j - begin));
+  for (; j + 2 <= end; j += 2)
+    NoiseBlock(rng, i, j / 2, u1 + (j - begin), u2 + (j - begin));
+  if (j < end) {
+    NoiseBlock(rng, i, j / 2, edge1, edge2);
+    u1[j - begin] = edge1[0];
+    u2[j - begin] = edge2[0];
+  }
+}
+
+// The wave vector grid and the dispersion relation.
+struct SpectrumTerms {
+  // 2 pi / L, the spacing of the wave vectors.
+  f32 dk;
+  f32 Nx2;
+  f32 Mx2;
+  float2 wind;
+  Spectra::Dispersion dispersion;
+  f32 patchSize2;
+
+  explicit SpectrumTerms(const SpectrumParameters &dat)
+      : dk(2.f * numbers::pi_v<f32> / dat.patchSize), Nx2((f32)(dat.N / 2)),
+        Mx2((f32)(dat.M / 2)), wind(normalize(dat.windDirection)),
+        dispersion(dat, dk),
+        patchSize2(dat.patchSize * dat.patchSize) {}
+
+  f32 Kx(u32 i) const { return (Nx2 - (f32)i) * dk; }
+  template <typename V> V Ky(u32 j) const {
+    return (V::Broadcast(Mx2) - V::Iota((f32)j)) * V::Broadcast(dk);
+  }
+  template <typename V> V Dot(V kx, V ky) const {
+    return MulAdd(kx, V::Broadcast(wind.x), ky * V::Broadcast(wind.y));
+  }
+  template <typename V> V Cross(V kx, V ky) const {
+    return NegMulAdd(ky, V::Broadcast(wind.x), kx * V::Broadcast(wind.y));
+  }
+};
+
+// Calls fn(model) with the model of the spectrum and spreading of dat, so
+// the kernels are compiled for each of them.
+template <typename Omni, typename Fn>
+void WithSpreading(const SpectrumParameters &dat, f32 dk, Fn &&fn) {
+  switch (dat.spreading) {
+  case Spreading::DonelanBanner:
+    fn(Spectra::Directional<Omni, Spectra::DonelanBanner>(dat, dk));
+    break;
+  case Spreading::Cos2s:
+  default:
+    fn(Spectra::Directional<Omni, Spectra::Cos2s>(dat, dk));
+    break;
+  }
+}
+
+template <typename Fn>
+void WithModel(const SpectrumParameters &dat, const SpectrumTerms &t, Fn &&fn) {
+  switch (dat.spectrum) {
+  case SpectrumType::PiersonMoskowitz:
+    WithSpreading<Spectra::PiersonMoskowitz>(dat, t.dk, fn);
+    break;
+  case SpectrumType::Jonswap:
+    WithSpreading<Spectra::Jonswap>(dat, t.dk, fn);
+    break;
+  case SpectrumType::Tma:
+    WithSpreading<Spectra::Tma>(dat, t.dk, fn);
+    break;
+  case SpectrumType::Phillips:
+  default:
+    fn(Spectra::Phillips(dat));
+    break;
+  }
+}
+
+// w(k) = sqrt(g k tanh(k D)), see CalculateFrequencies.
+template <typename V> inline V Frequency(V k2, const SpectrumTerms &t) {
+  const V k = Sqrt(k2);
+  const V tanh = t.dispersion.TanhKD(k);
+  const V mult =
+      Select(CmpGt(V::Broadcast(0.01f * 0.01f), k),
+             MulAdd(k2, V::Broadcast(t.patchSize2), V::Broadcast(1.f)),
+             V::Broadcast(1.f));
+  return Sqrt(V::Broadcast(t.dispersion.gravity) * k * tanh * mult);
+}
+
+// Standard normal pairs from the uniforms (Box-Muller).
+template <typename V> inline void Gaussian(V u1, V u2, V &re, V &im) {
+  const V r = Sqrt(V::Broadcast(-2.f) * Log(u1));
+  V s, c;
+  SinCos(u2 * V::Broadcast(2.f * numbers::pi_v<f32>), s, c);
+  re = r * c;
+  im = r * s;
+}
+
+template <typename V>
+inline void Gaussian(const f32 *u1, const f32 *u2, u32 j, V &re, V &im) {
+  Gaussian(V::Load(u1 + j), V::Load(u2 + j), re, im);
+}
+
+// Complex values interleaved as in std::complex.
+template <typename V> inline void StoreComplex(V re, V im, f32 *out, u32 j) {
+  V lo, hi;
+  Interleave(re, im, lo, hi);
+  lo.Store(out + 2 * j);
+  hi.Store(out + 2 * j + V::Width);
+}
+
+// Each kernel processes V::Width consecutive columns of a row starting at j.
+
+template <typename V>
+inline void FrequencyKernel(const SpectrumTerms &t, f32 kx, u32 j, f32 *out) {
+  const V ky = t.Ky<V>(j);
+  Frequency(MulAdd(V::Broadcast(kx), V::Broadcast(kx), ky * ky), t)
+      .Store(out + j);
+}
+
+// Noise of one row: the columns j of row i, and the columns (M - j) % M of
+// the mirrored row. The mirrored ones point at column M, a copy of column 0,
+// so that the one of -k is at -j.
+struct RowNoise {
+  const f32 *u1;
+  const f32 *u2;
+  const f32 *u1Mirrored;
+  const f32 *u2Mirrored;
+
+  // V::Width columns of -k from j on.
+  template <typename V> static V Mirrored(const f32 *u, u32 j) {
+    return Reverse(V::Load(u - j - (V::Width - 1)));
+  }
+};
+
+// Calls fn(i, mi, noise) for the rows i in [0, N / 2] and mi = (N - i) % N,
+// with the noise of both rows. The two rows hold the same four wave vectors
+// of length |k| in each column, k and -k of both, so the radial terms of the
+// model are evaluated once for the four. Every element has its own noise,
+// so the columns 0 and M / 2, where -k is in the same row, need no special
+// case.
+template <typename Fn>
+void ForEachRowPair(ThreadPool *pool, const Philox4x32 &rng, u32 N, u32 M,
+                    Fn &&fn) {
+  ForEachRows(pool, N / 2 + 1, [&](u32 begin, u32 end) {
+    // Per row the uniforms of the M columns, each followed by a copy of
+    // column 0.
+    const size_t stride = 2 * ((size_t)M + 1);
+    vector<f32> buffer(2 * stride);
+    const auto fill = [&](u32 i, f32 *u1) {
+      f32 *u2 = u1 + M + 1;
+      NoiseUniforms(rng, i, 0, M, u1, u2);
+      u1[M] = u1[0];
+      u2[M] = u2[0];
+    };
+    // The noise of a row and the mirrored one of the other row of the pair.
+    const auto rowNoise = [&](const f32 *u, const f32 *uMirrored) {
+      return RowNoise{u, u + M + 1, uMirrored + M, uMirrored + 2 * M + 1};
+    };
+
+    for (u32 i = begin; i < end; ++i) {
+      const u32 mi = (N - i) % N;
+      f32 *u = buffer.data();
+      f32 *uMirrored = mi != i ? u + stride : u;
+      fill(i, u);
+      if (mi != i)
+        fill(mi, uMirrored);
+      const RowNoise noise[2] = {rowNoise(u, uMirrored),
+                                 rowNoise(uMirrored, u)};
+      fn(i, mi, noise);
+    }
+  });
+}
+
+// h0(k) and h0(-k) of row i.
+template <typename V> struct Tildeh0Pair {
+  V re;
+  V im;
+  V reMirrored;
+  V imMirrored;
+};
+
+template <typename V, typename Model, typename Radial>
+inline Tildeh0Pair<V> Tildeh0PairKernel(const Model &model,
+                                        const SpectrumTerms &t, f32 kx,
+                                        f32 kxMirrored, const Radial &radial,
+                                        const RowNoise &noise, u32 j) {
+  // -k, except where the index wraps onto itself (row or column 0).
+  const V ky = t.Ky<V>(j);
+  const V kyMirrored = Select(CmpEq(V::Iota((f32)j), V::Zero()), ky, -ky);
+  const V kxv = V::Broadcast(kx);
+  const V kxMirroredv = V::Broadcast(kxMirrored);
+  const V a = model.Angular(radial, t.Dot(kxv, ky), t.Cross(kxv, ky));
+  const V aMirrored = model.Angular(radial, t.Dot(kxMirroredv, kyMirrored),
+                                    t.Cross(kxMirroredv, kyMirrored));
+
+  Tildeh0Pair<V> res;
+  Gaussian(noise.u1, noise.u2, j, res.re, res.im);
+  res.re = res.re * a;
+  res.im = res.im * a;
+  Gaussian(RowNoise::Mirrored<V>(noise.u1Mirrored, j),
+           RowNoise::Mirrored<V>(noise.u2Mirrored, j), res.reMirrored,
+           res.imMirrored);
+  res.reMirrored = res.reMirrored * aMirrored;
+  res.imMirrored = res.imMirrored * aMirrored;
+  return res;
+}
+
+// The rows i and mi of the full spectrum: the columns j of both rows, and
+// the ones of -k, (M - j) % M of the other row. Column 0 is its own mirror,
+// the one of -k is left to the other row.
+template <typename V, typename Model>
+inline void Tildeh0RowsKernel(const Model &model, const SpectrumTerms &t,
+                              u32 i, u32 mi, u32 M,
+                              const RowNoise (&noise)[2], u32 j,
+                              f32 *const (&rows)[2]) {
+  const f32 kx = t.Kx(i);
+  const f32 kxMirrored = t.Kx(mi);
+  const V kxv = V::Broadcast(kx);
+  const V ky = t.Ky<V>(j);
+  const auto radial = model.Radial(MulAdd(kxv, kxv, ky * ky));
+  const u32 count = mi != i ? 2 : 1;
+  for (u32 r = 0; r < count; ++r) {
+    const auto h0 = Tildeh0PairKernel<V>(model, t, r ? kxMirrored : kx,
+                                         r ? kx : kxMirrored, radial,
+                                         noise[r], j);
+    StoreComplex(h0.re, h0.im, rows[r], j);
+    f32 *mirrored = rows[count - 1 - r];
+    if (j != 0) {
+      StoreComplex(Reverse(h0.reMirrored), Reverse(h0.imMirrored), mirrored,
+                   M - j - (V::Width - 1));
+      continue;
+    }
+    f32 first[2 * V::Width];
+    StoreComplex(Reverse(h0.reMirrored), Reverse(h0.imMirrored), first, 0);
+    copy(first, first + 2 * (V::Width - 1),
+         mirrored + 2 * (M - (V::Width - 1)));
+  }
+}
+
+// One row of the half spectrum.
+struct HalfRow {
+  f32 *h0;
+  f32 *h0Mirrored;
+  f32 *frequencies;
+};
+
+// The rows i and mi of the half spectrum, with the frequency shared too.
+template <typename V, typename Model>
+inline void HalfRowsKernel(const Model &model, const SpectrumTerms &t, u32 i,
+                           u32 mi, const RowNoise (&noise)[2], u32 j,
+                           const HalfRow (&rows)[2]) {
+  const f32 kx = t.Kx(i);
+  const f32 kxMirrored = t.Kx(mi);
+  const V kxv = V::Broadcast(kx);
+  const V ky = t.Ky<V>(j);
+  const V k2 = MulAdd(kxv, kxv, ky * ky);
+  const auto radial = model.Radial(k2);
+  const V frequency = Frequency(k2, t);
+  const u32 count = mi != i ? 2 : 1;
+  for (u32 r = 0; r < count; ++r) {
+    const auto h0 = Tildeh0PairKernel<V>(model, t, r ? kxMirrored : kx,
+                                         r ? kx : kxMirrored, radial,
+                                         noise[r], j);
+    StoreComplex(h0.re, h0.im, rows[r].h0, j);
+    StoreComplex(h0.reMirrored, h0.imMirrored, rows[r].h0Mirrored, j);
+    frequency.Store(rows[r].frequencies + j);
+  }
+}
+} // namespace
+
+vector<complex<f32>> CalculateTildeh0(const SpectrumParameters &dat,
+                                      ThreadPool *pool) {
+  const u32 N = dat.N;
+  const u32 M = dat.M;
+  const SpectrumTerms terms(dat);
+  const Philox4x32 rng(dat.seed);
+
+  vector<complex<f32>> res((size_t)N * M);
+  // The columns j and M - j of a row pair are generated together, as the
+  // half spectrum does, and the values of -k stored reversed.
+  WithModel(dat, terms, [&](const auto &model) {
+    ForEachRowPair(pool, rng, N, M,
+                   [&](u32 i, u32 mi, const RowNoise(&noise)[2]) {
+      f32 *const rows[2] = {
+          reinterpret_cast<f32 *>(res.data() + (size_t)i * M),
+          reinterpret_cast<f32 *>(res.data() + (size_t)mi * M)};
+      u32 j = 0;
+      for (; j + f32v::Width <= M / 2 + 1; j += f32v::Width)
+        Tildeh0RowsKernel<f32v>(model, terms, i, mi, M, noise, j, rows);
+      for (; j <= M / 2; ++j)
+        Tildeh0RowsKernel<f32x1>(model, terms, i, mi, M, noise, j, rows);
+    });
+  });
+  return res;
+}
+
+vector<f32> CalculateFrequencies(const SpectrumParameters &dat,
+                                 ThreadPool *pool) {
+  // w^2(k) = gktanh(kD)
+  const u32 N = dat.N;
+  const u32 M = dat.M;
+  const SpectrumTerms terms(dat);
+
+  vector<f32> res((size_t)N * M);
+  ForEachRows(pool, N, [&](u32 begin, u32 end) {
+    for (u32 i = begin; i < end; ++i) {
+      const f32 kx = terms.Kx(i);
+      f32 *out = res.data() + (size_t)i * M;
+      u32 j = 0;
+      for (; j + f32v::Width <= M; j += f32v::Width)
+        FrequencyKernel<f32v>(terms, kx, j, out);
+      for (; j < M; ++j)
+        FrequencyKernel<f32x1>(terms, kx, j, out);
+    }
+  });
+  return res;
+}
+
+complex<f32> HalfSpectrum::Tildeh0At(u32 i, u32 j) const {
+  if (j < GetPitch())
+    return tildeh0[i * GetPitch() + j];
+  return tildeh0Mirrored[((N - i) % N) * GetPitch() + (M - j)];
+}
+
+f32 HalfSpectrum::FrequencyAt(u32 i, u32 j) const {
+  if (j < GetPitch())
+    return frequencies[i * GetPitch() + j];
+  return frequencies[((N - i) % N) * GetPitch() + (M - j)];
+}
+
+vector<complex<f32>> HalfSpectrum::ExpandTildeh0() const {
+  vector<complex<f32>> res(N * M);
+  for (u32 i = 0; i < N; ++i)
+    for (u32 j = 0; j < M; ++j)
+      res[i * M + j] = Tildeh0At(i, j);
+  return res;
+}
+
+vector<f32> HalfSpectrum::ExpandFrequencies() const {
+  vector<f32> res(N * M);
+  for (u32 i = 0; i < N; ++i)
+    for (u32 j = 0; j < M; ++j)
+      res[i * M + j] = FrequencyAt(i, j);
+  return res;
+}
+
+HalfSpectrum CalculateHalfSpectrum(const SpectrumParameters &dat,
+                                   ThreadPool *pool) {
+  const u32 N = dat.N;
+  const u32 M = dat.M;
+  const SpectrumTerms terms(dat);
+  const Philox4x32 rng(dat.seed);
+
+  HalfSpectrum res;
+  res.N = N;
+  res.M = M;
+  const u32 pitch = res.GetPitch();
+  res.tildeh0.resize((size_t)N * pitch);
+  res.tildeh0Mirrored.resize((size_t)N * pitch);
+  res.frequencies.resize((size_t)N * pitch);
+
+  const auto row = [&](u32 i) {
+    const size_t offset = (size_t)i * pitch;
+    return HalfRow{reinterpret_cast<f32 *>(res.tildeh0.data() + offset),
+                   reinterpret_cast<f32 *>(res.tildeh0Mirrored.data() + offset),
+                   res.frequencies.data() + offset};
+  };
+  WithModel(dat, terms, [&](const auto &model) {
+    ForEachRowPair(pool, rng, N, M,
+                   [&](u32 i, u32 mi, const RowNoise(&noise)[2]) {
+      const HalfRow rows[2] = {row(i), row(mi)};
+      u32 j = 0;
+      for (; j + f32v::Width <= pitch; j += f32v::Width)
+        HalfRowsKernel<f32v>(model, terms, i, mi, noise, j, rows);
+      for (; j < pitch; ++j)
+        HalfRowsKernel<f32x1>(model, terms, i, mi, noise, j, rows);
+    });
+  });
+  return res;
+}
+
+namespace {
+// The wave k and the one of the mirrored index both contribute |h0(k)|, so
+// the sums over the grid count every value twice.
+template <typename H0>
+DisplacementBounds DisplacementBoundsOf(u32 count, H0 &&tildeh0At) {
+  f64 sum = 0, sumSquares = 0;
+  for (u32 i = 0; i < count; ++i) {
+    const f64 amplitude = std::abs(tildeh0At(i));
+    sum += amplitude;
+    sumSquares += amplitude * amplitude;
+  }
+  DisplacementBounds res;
+  res.peak = (f32)(2 * sum);
+  // The real part of a wave of random phase and amplitude a has a variance
+  // of a^2 / 2.
+  res.deviation = (f32)std::sqrt(sumSquares);
+  const f32 sigmas = std::sqrt(2.f * std::log((f32)std::max(count, 2u))) + 1;
+  res.likelyPeak = std::min(res.peak, sigmas * res.deviation);
+  return res;
+}
+} // namespace
+
+DisplacementRange DisplacementBounds::GetRange(const float3 &lambda,
+                                               bool sure) const {
+  // The height is (H + 2) / 5, the choppy field is used as is.
+  const f32 reach = sure ? peak : likelyPeak;
+  const float3 extent = {std::abs(lambda.x) * reach,
+                         std::abs(lambda.y) * reach / 5.f,
+                         std::abs(lambda.z) * reach};
+  const float3 center = {0.f, lambda.y * 2.f / 5.f, 0.f};
+  return {center - extent, center + extent};
+}
+
+DisplacementBounds
+CalculateDisplacementBounds(span<const complex<f32>> tildeh0) {
+  return DisplacementBoundsOf((u32)tildeh0.size(),
+                              [&](u32 i) { return tildeh0[i]; });
+}
+
+DisplacementBounds CalculateDisplacementBounds(const HalfSpectrum &spectrum) {
+  const u32 M = spectrum.M;
+  return DisplacementBoundsOf(spectrum.N * M, [&](u32 i) {
+    return spectrum.Tildeh0At(i / M, i % M);
+  });
+}
+} // namespace Ocean
@@ -0,0 +1,127 @@
+#pragma once
+#include <complex>
+#include <span>
+#include <vector>
+#include "../Math/Vector.h"
+
+namespace Ocean {
+class ThreadPool;
+
+// Wave spectrum of a patch, see SpectrumModels.h.
+enum class SpectrumType : u32 {
+  Phillips,
+  PiersonMoskowitz,
+  Jonswap,
+  // JONSWAP limited by Depth.
+  Tma,
+};
+
+// Directional spreading of the spectra other than Phillips, which has its
+// own cos^2 term.
+enum class Spreading : u32 {
+  Cos2s,
+  DonelanBanner,
+};
+
+// The subset of a patch description that determines its spectrum. Changing
+// any of these requires regenerating tilde_h0 and the frequencies.
+struct SpectrumParameters {
+  u32 N;
+  u32 M;
+  f32 patchSize;
+  f32 Amplitude;
+  f32 WindForce;
+  float2 windDirection;
+  f32 gravity;
+  f32 Depth;
+  // Key of the random phases: the same parameters and seed always give the
+  // same spectrum.
+  u32 seed = 0;
+  // Phillips is scaled by Amplitude. The other spectra take WindForce as
+  // the wind speed 10 m above the water (m/s) and give heights in meters.
+  SpectrumType spectrum = SpectrumType::Phillips;
+  Spreading spreading = Spreading::Cos2s;
+  // Distance the wind blows over (m) and peak enhancement gamma of JONSWAP
+  // and TMA.
+  f32 fetch = 100000.f;
+  f32 peakEnhancement = 3.3f;
+};
+
+// The generators split the rows over the pool (if given). The Gaussian noise
+// of the element (i, j) only depends on the seed, i and j, so the results do
+// not depend on the number of threads, and the full and the half spectrum of
+// the same parameters agree.
+
+// Initial spectrum of the patch, N*M values in row major order.
+std::vector<std::complex<f32>> CalculateTildeh0(const SpectrumParameters &dat,
+                                                ThreadPool *pool = nullptr);
+
+// Dispersion relation w(k) of the patch, N*M values in row major order.
+std::vector<f32> CalculateFrequencies(const SpectrumParameters &dat,
+                                      ThreadPool *pool = nullptr);
+
+// The same spectrum stored over half of the grid, the columns j in
+// [0, M / 2]. The height field is real so the simulation only needs half of
+// the frequencies, and h0(k) and h0(-k) of each index of the half, where -k
+// of index (i, j) is ((N - i) % N, (M - j) % M). The rows i and N - i are
+// generated together: the part of the spectrum that only depends on |k| and
+// the frequency are evaluated once for the four wave vectors of a column.
+// The N*M values of h0 are independent, their noise is most of the time.
+struct HalfSpectrum {
+  u32 N = 0;
+  u32 M = 0;
+  // N rows of GetPitch() values each.
+  std::vector<std::complex<f32>> tildeh0;
+  std::vector<std::complex<f32>> tildeh0Mirrored;
+  std::vector<f32> frequencies;
+
+  u32 GetPitch() const { return M / 2 + 1; }
+
+  // Values at any index of the full grid.
+  std::complex<f32> Tildeh0At(u32 i, u32 j) const;
+  f32 FrequencyAt(u32 i, u32 j) const;
+
+  // The full N*M arrays of CalculateTildeh0 and CalculateFrequencies.
+  std::vector<std::complex<f32>> ExpandTildeh0() const;
+  std::vector<f32> ExpandFrequencies() const;
+};
+
+HalfSpectrum CalculateHalfSpectrum(const SpectrumParameters &dat,
+                                   ThreadPool *pool = nullptr);
+
+// Offsets of displacement.hlsl: every point of the plane stays within
+// [low, high] of its rest position.
+struct DisplacementRange {
+  float3 low = {0, 0, 0};
+  float3 high = {0, 0, 0};
+
+  // The cascades add up.
+  DisplacementRange operator+(const DisplacementRange &other) const {
+    return {low + other.low, high + other.high};
+  }
+};
+
+// How far the transformed fields of a patch, the height and the choppy
+// field, reach. Each is a sum of N*M waves, the wave k of amplitude at most
+// |h0(k)| + |h0(m(k))| (see Spektrums.hlsl), so the bounds hold at every
+// point and time.
+struct DisplacementBounds {
+  // Every wave at its crest at once.
+  f32 peak = 0;
+  // Standard deviation over the patch and time. The phases are random, the
+  // fields are close to normal.
+  f32 deviation = 0;
+  // The largest of the N*M values of a frame rarely passes this, the
+  // expected maximum of as many normal values plus one deviation.
+  f32 likelyPeak = 0;
+
+  // The range of displacement.hlsl for a displacement lambda, from
+  // likelyPeak, or from peak if sure.
+  DisplacementRange GetRange(const float3 &lambda, bool sure = false) const;
+};
+
+// From the N*M values of CalculateTildeh0 or from the half spectrum.
+DisplacementBounds
+CalculateDisplacementBounds(std::span<const std::complex<f32>> tildeh0);
+DisplacementBounds CalculateDisplacementBounds(const HalfSpectrum &spectrum);
+} // namespace Ocean
@@ -0,0 +1,361 @@
+#pragma once
+#include <cmath>
+#include <numbers>
+#include "Spectrum.h"
+#include "../Simd/Simd.h"
+
+// Wave spectra of the generators in Spectrum.cpp, evaluated V::Width wave
+// vectors at a time. Like Simd.h, only include this from translation units
+// of Ocean.Core.
+//
+// A model gives the standard deviation of the real and imaginary parts of
+// tilde_h0(k) in two steps: Radial(k2) only depends on |k|^2 and is shared
+// by k and -k, Angular(terms, kdotw, kcrossw) adds the direction of k
+// relative to the wind from dot(k, wind) and cross(k, wind). A new spectrum
+// is a new model here and a case in the dispatch of Spectrum.cpp.
+//
+// The generators evaluate Radial once for the four wave vectors of a row
+// pair that share |k|, Angular for each of them. The directional models do
+// not reach the speed of Phillips: a Log and an Exp (cos-2s) or an Atan2
+// and an Exp (Donelan-Banner) per wave vector remain, about 1.6 - 2x the
+// time of Phillips for N = 256 - 4096 on one AVX2 core.
+namespace Ocean::Spectra {
+using namespace Ocean::Simd;
+
+// Below e^-50 the waves are negligible, cut them off before the products
+// reach the (very slow) denormal range.
+constexpr f32 MinExponent = -50.f;
+
+// tanh(x) for x >= 0. 1 - 2 / (e^2x + 1) cancels badly for small x where
+// the series takes over. tanh(20) is 1 in single precision, clamping keeps
+// the quotient out of the denormal range.
+template <typename V> inline V Tanh(V x) {
+  const V x2 = x * x;
+  V series = MulAdd(V::Broadcast(-17.f / 315.f), x2, V::Broadcast(2.f / 15.f));
+  series = MulAdd(series, x2, V::Broadcast(-1.f / 3.f));
+  series = MulAdd(series * x2, x, x);
+  const V e = Exp(Min(x + x, V::Broadcast(40.f)));
+  return Select(CmpGt(V::Broadcast(0.125f), x), series,
+                V::Broadcast(1.f) -
+                    V::Broadcast(2.f) / (e + V::Broadcast(1.f)));
+}
+
+// Gamma(s + 1) / Gamma(s + 1 / 2) for s >= 0, returned as x r^2 with
+// r^2 = ratio^2 / x. The asymptotic series sqrt(x) (1 + 1 / 8x + 1 / 128x^2 -
+// 5 / 1024x^3 - 21 / 32768x^4) of x = s + 6 is shifted back by the products
+// of the factors in between, all with a single division.
+template <typename V> inline V GammaRatioSquared(V s) {
+  V num = s + V::Broadcast(0.5f);
+  V den = s + V::Broadcast(1.f);
+  for (u32 i = 1; i < 6; ++i) {
+    num = num * (s + V::Broadcast(0.5f + (f32)i));
+    den = den * (s + V::Broadcast(1.f + (f32)i));
+  }
+  const V x = s + V::Broadcast(6.f);
+  const V q = V::Broadcast(1.f) / (x * den);
+  const V inv = q * den;
+  V series = MulAdd(V::Broadcast(-21.f / 32768.f), inv,
+                    V::Broadcast(-5.f / 1024.f));
+  series = MulAdd(series, inv, V::Broadcast(1.f / 128.f));
+  series = MulAdd(series, inv, V::Broadcast(1.f / 8.f));
+  series = MulAdd(series, inv, V::Broadcast(1.f));
+  const V r = series * num * q * x;
+  return x * r * r;
+}
+
+// w(k) = sqrt(g k tanh(k D)) and dw / dk. In deep water (tanh(k D) is 1 in
+// single precision for every wave vector of the grid) tanh is skipped.
+struct Dispersion {
+  f32 gravity;
+  f32 depth;
+  bool deep;
+
+  Dispersion(const SpectrumParameters &dat, f32 dk)
+      : gravity(dat.gravity), depth(dat.Depth), deep(dat.Depth * dk >= 10.f) {}
+
+  template <typename V> V TanhKD(V k) const {
+    return deep ? V::Broadcast(1.f) : Tanh(k * V::Broadcast(depth));
+  }
+
+  template <typename V> V Omega(V k, V tanh) const {
+    return Sqrt(V::Broadcast(gravity) * k * tanh);
+  }
+
+  // (dw / dk) w = g (tanh(kD) + kD sech^2(kD)) / 2
+  template <typename V> V DerivativeTimesOmega(V k, V tanh) const {
+    const V kd = k * V::Broadcast(depth);
+    return V::Broadcast(0.5f * gravity) *
+           MulAdd(kd, NegMulAdd(tanh, tanh, V::Broadcast(1.f)), tanh);
+  }
+};
+
+// The Phillips spectrum: A e^(-1 / (k L)^2) / k^4 cos^2(theta) e^(-(k l)^2),
+// waves against the wind damped by 0.07, scaled by Amplitude.
+struct Phillips {
+  // sqrt(A / 2), the 1 / sqrt(2) is the one of tilde_h0.
+  f32 sqrtAmplitude;
+  // 1 / (2 L^2) and l^2 / 2, with l = L / 1000.
+  f32 halfInvLargest2;
+  f32 halfSmallest2;
+
+  explicit Phillips(const SpectrumParameters &dat)
+      : sqrtAmplitude(std::sqrt(dat.Amplitude * 0.5f)) {
+    const f32 largest = dat.WindForce * dat.WindForce / dat.gravity;
+    const f32 smallest = largest / 1000.f;
+    halfInvLargest2 = 0.5f / (largest * largest);
+    halfSmallest2 = 0.5f * smallest * smallest;
+  }
+
+  template <typename V> struct Terms {
+    // Everything but |dot(k, wind)|, 0 for k = 0.
+    V amplitude;
+  };
+
+  template <typename V> Terms<V> Radial(V k2) const {
+    const auto nonZero = CmpGt(k2, V::Zero());
+    const V k2Safe = Select(nonZero, k2, V::Broadcast(1.f));
+    const V exponent = NegMulAdd(k2Safe, V::Broadcast(halfSmallest2),
+                                 -(V::Broadcast(halfInvLargest2) / k2Safe));
+    const auto visible = CmpGt(exponent, V::Broadcast(MinExponent));
+    const V e = Exp(Max(exponent, V::Broadcast(MinExponent)));
+    const V res = V::Broadcast(sqrtAmplitude) * e / (k2Safe * Sqrt(k2Safe));
+    return {Select(nonZero, Select(visible, res, V::Zero()), V::Zero())};
+  }
+
+  template <typename V>
+  V Angular(const Terms<V> &terms, V kdotw, V /*kcrossw*/) const {
+    const V damping = Select(CmpGt(V::Zero(), kdotw),
+                             V::Broadcast(0.26457513110645906f), // sqrt(0.07)
+                             V::Broadcast(1.f));
+    return terms.amplitude * Abs(kdotw) * damping;
+  }
+};
+
+// Omnidirectional spectra S(w) (m^2 s), given as ln(S) of w, 1 / w and ln(w).
+// WindForce is the wind speed 10 m above the water.
+
+// Pierson-Moskowitz, fully developed sea:
+// S(w) = a g^2 / w^5 e^(-5/4 (wp / w)^4).
+struct PiersonMoskowitz {
+  f32 peak;
+  // ln(a g^2)
+  f32 logScale;
+
+  explicit PiersonMoskowitz(const SpectrumParameters &dat)
+      : peak(0.855f * dat.gravity / dat.WindForce),
+        logScale(std::log(8.1e-3f * dat.gravity * dat.gravity)) {}
+
+  template <typename V> V LogDensity(V, V invOmega, V logOmega) const {
+    const V ratio = V::Broadcast(peak) * invOmega;
+    const V ratio2 = ratio * ratio;
+    return NegMulAdd(V::Broadcast(1.25f), ratio2 * ratio2,
+                     NegMulAdd(V::Broadcast(5.f), logOmega,
+                               V::Broadcast(logScale)));
+  }
+};
+
+// JONSWAP, fetch limited: the Pierson-Moskowitz shape with the peak
+// enhanced by gamma^r, r = e^(-(w - wp)^2 / (2 sigma^2 wp^2)).
+struct Jonswap {
+  f32 peak;
+  f32 logScale;
+  f32 logGamma;
+
+  explicit Jonswap(const SpectrumParameters &dat) {
+    const f32 g = dat.gravity;
+    const f32 U = dat.WindForce;
+    const f32 F = dat.fetch;
+    const f32 alpha = 0.076f * std::pow(U * U / (F * g), 0.22f);
+    peak = 22.f * std::cbrt(g * g / (U * F));
+    logScale = std::log(alpha * g * g);
+    logGamma = std::log(dat.peakEnhancement);
+  }
+
+  template <typename V> V LogDensity(V omega, V invOmega, V logOmega) const {
+    const V p = V::Broadcast(peak);
+    const V ratio = p * invOmega;
+    const V ratio2 = ratio * ratio;
+    const V shape = NegMulAdd(
+        V::Broadcast(1.25f), ratio2 * ratio2,
+        NegMulAdd(V::Broadcast(5.f), logOmega, V::Broadcast(logScale)));
+    // 1 / (2 sigma^2 wp^2), sigma is 0.07 below the peak, 0.09 above.
+    const V invWidth =
+        Select(CmpGt(omega, p),
+               V::Broadcast(1.f / (2.f * 0.09f * 0.09f * peak * peak)),
+               V::Broadcast(1.f / (2.f * 0.07f * 0.07f * peak * peak)));
+    const V d = omega - p;
+    const V r = Exp(-(d * d * invWidth));
+    return MulAdd(r, V::Broadcast(logGamma), shape);
+  }
+};
+
+// TMA, JONSWAP in finite depth with Kitaigorodskii's attenuation of
+// wh = w sqrt(D / g): wh^2 / 2 up to 1, 1 - (2 - wh)^2 / 2 up to 2, then 1.
+struct Tma : Jonswap {
+  f32 depthScale;
+
+  explicit Tma(const SpectrumParameters &dat)
+      : Jonswap(dat), depthScale(std::sqrt(dat.Depth / dat.gravity)) {}
+
+  template <typename V> V LogDensity(V omega, V invOmega, V logOmega) const {
+    const V wh = omega * V::Broadcast(depthScale);
+    const V half = V::Broadcast(0.5f);
+    const V two = V::Broadcast(2.f) - wh;
+    const V phi = Select(
+        CmpGt(wh, V::Broadcast(1.f)),
+        Select(CmpGe(wh, V::Broadcast(2.f)), V::Broadcast(1.f),
+               NegMulAdd(half * two, two, V::Broadcast(1.f))),
+        half * wh * wh);
+    return Jonswap::LogDensity(omega, invOmega, logOmega) + Log(phi);
+  }
+};
+
+// Directional spreading D(w, theta), normalized over theta in [-pi, pi].
+// Radial(logOmega, logAmplitude, scale) takes ln(sqrt(S(w))) and the factor
+// of the wave vector cell, Angular(terms, cos(theta), sin(theta)) returns
+// sqrt(S(w) D(w, theta)) times the factor. Built from the peak frequency of
+// the spectrum.
+
+// Mitsuyasu / Hasselmann cos-2s: D = Q(s) |cos(theta / 2)|^2s with
+// s = sp (w / wp)^5 below the peak, sp (w / wp)^-2.5 above.
+struct Cos2s {
+  f32 logPeak;
+  f32 peakSpread;
+
+  Cos2s(const SpectrumParameters &dat, f32 peak)
+      : logPeak(std::log(peak)),
+        peakSpread(11.5f *
+                   std::pow(dat.gravity / (peak * dat.WindForce), 2.5f)) {}
+
+  template <typename V> struct Terms {
+    // s / 2
+    V halfS;
+    // ln(sqrt(S(w) Q(s)))
+    V logNorm;
+    V scale;
+  };
+
+  template <typename V>
+  Terms<V> Radial(V logOmega, V logAmplitude, V scale) const {
+    const V logRatio = logOmega - V::Broadcast(logPeak);
+    const V exponent = Select(CmpGt(logRatio, V::Zero()),
+                              V::Broadcast(-2.5f), V::Broadcast(5.f));
+    const V s = V::Broadcast(peakSpread) * Exp(exponent * logRatio);
+    // Q(s) = Gamma(s + 1) / (2 sqrt(pi) Gamma(s + 1 / 2))
+    const V logNorm = MulAdd(
+        Log(GammaRatioSquared(s)), V::Broadcast(0.25f),
+        logAmplitude - V::Broadcast(0.632756061742322701f)); // ln(4 pi) / 4
+    return {s * V::Broadcast(0.5f), logNorm, scale};
+  }
+
+  template <typename V>
+  V Angular(const Terms<V> &terms, V cosTheta, V sinTheta) const {
+    // cos^2(theta / 2) = (1 + cos(theta)) / 2, which cancels against the
+    // wind, where sin^2(theta) / (2 (1 - cos(theta))) does not.
+    const V half = V::Broadcast(0.5f);
+    const V c2 = Max(Select(CmpGe(cosTheta, V::Zero()),
+                            MulAdd(cosTheta, half, half),
+                            sinTheta * sinTheta /
+                                (V::Broadcast(2.f) - cosTheta - cosTheta)),
+                     V::Broadcast(1e-30f));
+    const V exponent = MulAdd(terms.halfS, Log(c2), terms.logNorm);
+    const auto visible = CmpGt(exponent, V::Broadcast(MinExponent));
+    return Select(visible,
+                  Exp(Max(exponent, V::Broadcast(MinExponent))) * terms.scale,
+                  V::Zero());
+  }
+};
+
+// Donelan-Banner: D = beta / (2 tanh(beta pi)) sech^2(beta theta), beta
+// fitted over w / wp. sech(beta theta) stays above 1e-3, so the amplitude
+// is computed once for k and -k and only scaled by it.
+struct DonelanBanner {
+  f32 logPeak;
+
+  DonelanBanner(const SpectrumParameters &, f32 peak)
+      : logPeak(std::log(peak)) {}
+
+  template <typename V> struct Terms {
+    V beta;
+    // sqrt(S(w) beta / (2 tanh(beta pi))) times the scale
+    V amplitude;
+  };
+
+  template <typename V>
+  Terms<V> Radial(V logOmega, V logAmplitude, V scale) const {
+    const V logRatio = logOmega - V::Broadcast(logPeak);
+    const V low = Exp(logRatio * V::Broadcast(1.3f));
+    // 10^(-0.4 + 0.8393 e^(-0.567 ln((w / wp)^2)))
+    const V high = Exp(MulAdd(
+        V::Broadcast(0.8393f * std::numbers::ln10_v<f32>),
+        Exp(logRatio * V::Broadcast(-2.f * 0.567f)),
+        V::Broadcast(-0.4f * std::numbers::ln10_v<f32>)));
+    const V beta =
+        Select(CmpGt(V::Broadcast(-0.0512932943875505f), logRatio), // ln(0.95)
+               V::Broadcast(2.61f) * low,
+               Select(CmpGt(V::Broadcast(0.470003629245736f), logRatio),
+                      V::Broadcast(2.28f) / low, high)); // ln(1.6)
+    const V tanh = Tanh(beta * V::Broadcast(std::numbers::pi_v<f32>));
+    const auto visible = CmpGt(logAmplitude, V::Broadcast(MinExponent));
+    const V amplitude = Exp(Max(logAmplitude, V::Broadcast(MinExponent))) *
+                        scale * Sqrt(beta / (tanh + tanh));
+    return {beta, Select(visible, amplitude, V::Zero())};
+  }
+
+  template <typename V>
+  V Angular(const Terms<V> &terms, V cosTheta, V sinTheta) const {
+    // sech(x) = 2 e^-x / (1 + e^-2x)
+    const V e = Exp(-(terms.beta * Atan2(Abs(sinTheta), cosTheta)));
+    return terms.amplitude * (e + e) / MulAdd(e, e, V::Broadcast(1.f));
+  }
+};
+
+// Omnidirectional spectrum times spreading, converted to wave vectors:
+// S(k) = S(w) D(w, theta) (dw / dk) / k, and the standard deviation of the
+// parts of tilde_h0 is sqrt(S(k) dk^2 / 2).
+template <typename Omni, typename Spread> struct Directional {
+  Dispersion dispersion;
+  Omni omni;
+  Spread spread;
+  // dk^2 / 2
+  f32 halfCell;
+
+  Directional(const SpectrumParameters &dat, f32 dk)
+      : dispersion(dat, dk), omni(dat), spread(dat, omni.peak),
+        halfCell(0.5f * dk * dk) {}
+
+  template <typename V> struct Terms {
+    typename V::mask nonZero;
+    V invK;
+    typename Spread::template Terms<V> spread;
+  };
+
+  template <typename V> Terms<V> Radial(V k2) const {
+    Terms<V> res;
+    res.nonZero = CmpGt(k2, V::Zero());
+    const V k = Sqrt(Select(res.nonZero, k2, V::Broadcast(1.f)));
+    const V tanh = dispersion.TanhKD(k);
+    const V omega = dispersion.Omega(k, tanh);
+    // 1 / k and 1 / w from a single division.
+    const V invOmegaK = V::Broadcast(1.f) / (omega * k);
+    res.invK = invOmegaK * omega;
+    const V logOmega = Log(omega);
+    // sqrt((dw / dk) / k dk^2 / 2)
+    const V scale =
+        Sqrt(dispersion.DerivativeTimesOmega(k, tanh) * invOmegaK *
+             V::Broadcast(halfCell));
+    const V logAmplitude =
+        omni.LogDensity(omega, invOmegaK * k, logOmega) * V::Broadcast(0.5f);
+    res.spread = spread.Radial(logOmega, logAmplitude, scale);
+    return res;
+  }
+
+  template <typename V>
+  V Angular(const Terms<V> &terms, V kdotw, V kcrossw) const {
+    return Select(terms.nonZero,
+                  spread.Angular(terms.spread, kdotw * terms.invK,
+                                 kcrossw * terms.invK),
+                  V::Zero());
+  }
+};
+} // namespace Ocean::Spectra
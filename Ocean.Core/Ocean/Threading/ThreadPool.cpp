@@ -0,0 +1,109 @@
+#include "pch.h"
+#include "ThreadPool.h"
+
+namespace Ocean {
+thread_local bool ThreadPool::insideTask = false;
+
+ThreadPool::ThreadPool(u32 workerCount) {
+  workers.reserve(workerCount);
+  for (u32 i = 0; i < workerCount; ++i)
+    workers.emplace_back([this] { WorkerLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(mutex);
+    stop = true;
+  }
+  wakeWorkers.notify_all();
+  for (auto &worker : workers)
+    worker.join();
+}
+
+ThreadPool &ThreadPool::Global() {
+  static ThreadPool pool;
+  return pool;
+}
+
+u32 ThreadPool::DefaultWorkerCount() {
+  const u32 hardware = std::thread::hardware_concurrency();
+  return hardware > 1 ? hardware - 1 : 0;
+}
+
+void ThreadPool::Run(u32 count, u32 grain, ChunkFunction invoke,
+                     void *context) {
+  std::lock_guard submit(submitMutex);
+
+  Job job{.count = count,
+          .grain = grain,
+          .chunks = (count + grain - 1) / grain,
+          .invoke = invoke,
+          .context = context};
+  {
+    std::lock_guard lock(mutex);
+    current = &job;
+    ++generation;
+  }
+  wakeWorkers.notify_all();
+
+  insideTask = true;
+  Drain(job);
+  insideTask = false;
+
+  std::unique_lock lock(mutex);
+  // Workers may still hold a pointer to the job, wait for them to let go.
+  // The chunks of a failed job are not all finished.
+  jobFinished.wait(lock, [&] {
+    return (job.error ||
+            job.finishedChunks.load(std::memory_order_acquire) ==
+                job.chunks) &&
+           job.attachedWorkers == 0;
+  });
+  current = nullptr;
+  if (job.error)
+    std::rethrow_exception(job.error);
+}
+
+void ThreadPool::Drain(Job &job) {
+  for (;;) {
+    const u32 chunk = job.nextChunk.fetch_add(1, std::memory_order_relaxed);
+    if (chunk >= job.chunks)
+      return;
+    const u32 begin = chunk * job.grain;
+    const u32 end = std::min(begin + job.grain, job.count);
+    try {
+      job.invoke(job.context, begin, end);
+    } catch (...) {
+      // The other threads take no new chunk.
+      job.nextChunk.store(job.chunks, std::memory_order_relaxed);
+      std::lock_guard lock(mutex);
+      if (!job.error)
+        job.error = std::current_exception();
+      return;
+    }
+    job.finishedChunks.fetch_add(1, std::memory_order_release);
+  }
+}
+
+void ThreadPool::WorkerLoop() {
+  insideTask = true;
+  u64 seen = 0;
+  std::unique_lock lock(mutex);
+  for (;;) {
+    wakeWorkers.wait(lock, [&] { return stop || generation != seen; });
+    if (stop)
+      return;
+    seen = generation;
+    Job *job = current;
+    if (!job)
+      continue;
+
+    ++job->attachedWorkers;
+    lock.unlock();
+    Drain(*job);
+    lock.lock();
+    --job->attachedWorkers;
+    jobFinished.notify_all();
+  }
+}
+} // namespace Ocean
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "../Typedefs.h"
+
+namespace Ocean {
+// Fork-join pool for the data parallel parts of the CPU simulation. The
+// calling thread always takes part, so a pool without workers simply runs
+// everything inline.
+class ThreadPool {
+public:
+  explicit ThreadPool(u32 workerCount = DefaultWorkerCount());
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // Number of threads taking part in a ParallelFor, including the caller.
+  u32 GetConcurrency() const { return (u32)workers.size() + 1; }
+
+  // Splits [0, count) into chunks of at most grain items and calls
+  // fn(begin, end) for each of them. Returns once every chunk is done.
+  // Nested calls from inside a chunk run inline. If a chunk throws, the
+  // chunks not started yet are skipped and the first exception is rethrown
+  // once no thread works on the call any more.
+  template <typename Fn> void ParallelFor(u32 count, u32 grain, Fn &&fn) {
+    if (count == 0)
+      return;
+    if (grain == 0)
+      grain = 1;
+    if (workers.empty() || count <= grain || insideTask) {
+      fn(0u, count);
+      return;
+    }
+    using FnTy = std::remove_reference_t<Fn>;
+    Run(count, grain,
+        [](void *context, u32 begin, u32 end) {
+          (*static_cast<FnTy *>(context))(begin, end);
+        },
+        (void *)&fn);
+  }
+
+  // Shared pool sized to the machine.
+  static ThreadPool &Global();
+  static u32 DefaultWorkerCount();
+
+private:
+  using ChunkFunction = void (*)(void *context, u32 begin, u32 end);
+  struct Job {
+    u32 count;
+    u32 grain;
+    u32 chunks;
+    ChunkFunction invoke;
+    void *context;
+    std::atomic<u32> nextChunk{0};
+    std::atomic<u32> finishedChunks{0};
+    u32 attachedWorkers = 0;
+    // The first exception of a chunk, guarded by the mutex.
+    std::exception_ptr error{};
+  };
+
+  void Run(u32 count, u32 grain, ChunkFunction invoke, void *context);
+  void Drain(Job &job);
+  void WorkerLoop();
+
+  std::vector<std::thread> workers;
+  std::mutex submitMutex;
+  std::mutex mutex;
+  std::condition_variable wakeWorkers;
+  std::condition_variable jobFinished;
+  Job *current = nullptr;
+  u64 generation = 0;
+  bool stop = false;
+
+  static thread_local bool insideTask;
+};
+} // namespace Ocean
@@ -0,0 +1,14 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <numbers>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "Ocean/Typedefs.h"